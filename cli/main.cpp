@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include "qredisclient/redisclient.h"
+#include "qredisclient/responseformatter.h"
 
 int main(int argc, char *argv[])
 {
@@ -17,6 +18,11 @@ int main(int argc, char *argv[])
     parser.setApplicationDescription("redis-cli powered by qredisclient");
     parser.addHelpOption();
     parser.addVersionOption();
+
+    QCommandLineOption maxItemsOption(
+        "max-items", "Stop output after <n> reply items (0 - print all).",
+        "n", "0");
+    parser.addOption(maxItemsOption);
     parser.process(app);
 
     QStringList positionals = parser.positionalArguments();
@@ -46,9 +52,16 @@ int main(int argc, char *argv[])
 
     try {
         connection.connect();
-        auto result = connection.commandSync(cmd);        
+        auto result = connection.execSync(cmd);
         QVariant val = result.value();
-        std::cout << RedisClient::Response::valueToHumanReadString(val).toStdString();
+
+        RedisClient::ResponseFormatter formatter(
+            [](const QByteArray& chunk) {
+                std::cout.write(chunk.constData(), chunk.size());
+            },
+            parser.value(maxItemsOption).toLongLong());
+        formatter.format(val);
+        std::cout.flush();
     } catch (const RedisClient::Connection::Exception& e) {
         std::cerr << "Cannot run command:" << e.what();
     }
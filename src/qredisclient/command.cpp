@@ -9,28 +9,38 @@ extern "C" {
 
 RedisClient::Command::Command()
     : m_owner(nullptr),
+      m_ownerThread(nullptr),
       m_commandWithArguments(),
       m_dbIndex(-1),
       m_hiPriorityCommand(false),
+      m_inlineCallback(false),
       m_isPipeline(false),
-      m_transaction(true) {}
+      m_transaction(true),
+      m_enqueuedAt(0) {}
 
 RedisClient::Command::Command(const QList<QByteArray> &cmd, int db)
     : m_owner(nullptr),
+      m_ownerThread(nullptr),
       m_commandWithArguments(cmd),
       m_dbIndex(db),
       m_hiPriorityCommand(false),
+      m_inlineCallback(false),
       m_isPipeline(false),
-      m_transaction(true) {}
+      m_transaction(true),
+      m_enqueuedAt(0) {}
 
 RedisClient::Command::Command(const QList<QByteArray> &cmd, QObject *context,
                               Callback callback, int db)
     : m_owner(context),
+      m_ownerGuard(context),
+      m_ownerThread(context ? context->thread() : nullptr),
       m_commandWithArguments(cmd),
       m_dbIndex(db),
       m_hiPriorityCommand(false),
+      m_inlineCallback(false),
       m_isPipeline(false),      
       m_transaction(true),
+      m_enqueuedAt(0),
       m_callback(callback) {}
 
 RedisClient::Command &RedisClient::Command::append(const QByteArray &part) {
@@ -119,11 +129,25 @@ bool RedisClient::Command::hasCallback() const { return (bool)m_callback; }
 
 AsyncFuture::Deferred<RedisClient::Response> RedisClient::Command::getDeferred()
     const {
-  return m_deferred;
+  if (m_deferred) return *m_deferred;
+
+  return AsyncFuture::Deferred<Response>();
+}
+
+AsyncFuture::Deferred<RedisClient::Response>
+RedisClient::Command::attachDeferred() {
+  if (!m_deferred)
+    m_deferred = QSharedPointer<AsyncFuture::Deferred<Response>>::create();
+
+  return *m_deferred;
 }
 
+bool RedisClient::Command::hasDeferred() const { return !m_deferred.isNull(); }
+
 void RedisClient::Command::setCallBack(QObject *context, Callback callback) {
   m_owner = context;
+  m_ownerGuard = context;
+  m_ownerThread = context ? context->thread() : nullptr;
   m_callback = callback;
 }
 
@@ -169,6 +193,28 @@ bool RedisClient::Command::isHiPriorityCommand() const {
   return m_hiPriorityCommand;
 }
 
+void RedisClient::Command::setInlineCallback(bool enable) {
+  m_inlineCallback = enable;
+}
+
+bool RedisClient::Command::hasInlineCallback() const {
+  return m_inlineCallback;
+}
+
+void RedisClient::Command::setEnqueuedAt(qint64 usec) { m_enqueuedAt = usec; }
+
+qint64 RedisClient::Command::enqueuedAt() const { return m_enqueuedAt; }
+
+void RedisClient::Command::setTiming(
+    QSharedPointer<RedisClient::CommandTiming> timing) {
+  m_timing = timing;
+}
+
+QSharedPointer<RedisClient::CommandTiming> RedisClient::Command::getTiming()
+    const {
+  return m_timing;
+}
+
 bool RedisClient::Command::isPipelineCommand() const { return m_isPipeline; }
 
 bool RedisClient::Command::isTransaction() const { return m_transaction; }
@@ -198,6 +244,12 @@ int RedisClient::Command::getDbIndex() const {
 
 QObject *RedisClient::Command::getOwner() const { return m_owner; }
 
+QPointer<QObject> RedisClient::Command::getOwnerGuard() const {
+  return m_ownerGuard;
+}
+
+QThread *RedisClient::Command::getOwnerThread() const { return m_ownerThread; }
+
 QByteArray RedisClient::Command::getRawString(int limit) const {
   if (isAuthCommand()) return QByteArray("AUTH *******");
 
@@ -287,6 +339,7 @@ static QHash<QByteArray, int> cmdKeyMapping = {
     {"MGET", 0},
     {"MIGRATE", 8},
     {"MOVE", 0},
+    {"OBJECT ENCODING", 0},
     {"PERSIST", 0},
     {"PEXPIRE", 0},
     {"PEXPIREAT", 0},
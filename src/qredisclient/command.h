@@ -3,12 +3,35 @@
 #include <QByteArray>
 #include <QList>
 #include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
 #include <QString>
 #include <functional>
 #include "response.h"
 
 namespace RedisClient {
 
+/**
+ * @brief The CommandTiming struct
+ * Monotonic timestamps (see ConnectionStats::now()) of the last attempt to
+ * execute command. Filled by transporter thread before callback is called,
+ * see Command::setTiming().
+ */
+struct CommandTiming {
+  CommandTiming() : writtenAt(0), readAt(0) {}
+
+  /**
+   * @brief Round trip without time spent in client queue
+   * @return -1 if response wasn't read from socket
+   */
+  qint64 networkRtt() const {
+    return (writtenAt > 0 && readAt >= writtenAt) ? readAt - writtenAt : -1;
+  }
+
+  qint64 writtenAt;  // command is written to socket
+  qint64 readAt;     // last chunk of response is read from socket
+};
+
 /**
  * @brief The Command class
  *
@@ -42,6 +65,11 @@ public:
   Command(const QList<QByteArray>& cmd, QObject* context, Callback callback,
           int db = -1);
 
+  Command(const Command&) = default;
+  Command(Command&&) = default;
+  Command& operator=(const Command&) = default;
+  Command& operator=(Command&&) = default;
+
   /**
    * @brief ~Command
    */
@@ -123,6 +151,13 @@ public:
    */
   QObject* getOwner() const;
 
+  /**
+   * @brief Guard and thread of callback context captured when callback is
+   * set, so transporter thread never dereferences context
+   */
+  QPointer<QObject> getOwnerGuard() const;
+  QThread* getOwnerThread() const;
+
   /**
    * @brief Set context and callback
    * @param context
@@ -143,11 +178,27 @@ public:
   bool hasCallback() const;
 
   /**
-   * @brief getFuture
+   * @brief Get deferred attached to this command.
+   * Returns detached deferred (never completed) if attachDeferred() wasn't
+   * called before.
    * @return
    */
   AsyncFuture::Deferred<Response> getDeferred() const;
 
+  /**
+   * @brief Attach deferred which will be completed with command response.
+   * Deferred is allocated only on first call, so commands executed without
+   * QFuture don't pay for it.
+   * @return
+   */
+  AsyncFuture::Deferred<Response> attachDeferred();
+
+  /**
+   * @brief hasDeferred
+   * @return
+   */
+  bool hasDeferred() const;
+
   /**
    * @brief Mark this command as High Priority command.
    * Command will be added to the begining of the Connection queue instead of
@@ -161,6 +212,47 @@ public:
    */
   bool isHiPriorityCommand() const;
 
+  /**
+   * @brief Execute callback directly in transporter thread right after
+   * response parsing instead of delivering it to the owner thread.
+   * Callback should be thread-safe and cheap (e.g. update atomic counter or
+   * fulfill promise). Callback is not called if owner was destroyed.
+   * @param enable
+   */
+  void setInlineCallback(bool enable = true);
+
+  /**
+   * @brief hasInlineCallback
+   * @return
+   */
+  bool hasInlineCallback() const;
+
+  /**
+   * @brief Monotonic timestamp (see ConnectionStats::now()) of adding
+   * command to the transporter queue. Used for statistics.
+   * @param usec
+   */
+  void setEnqueuedAt(qint64 usec);
+
+  /**
+   * @brief enqueuedAt
+   * @return 0 if command wasn't queued yet
+   */
+  qint64 enqueuedAt() const;
+
+  /**
+   * @brief Ask transporter to record network timing of the command.
+   * Timing is shared by copies of the command.
+   * @param timing
+   */
+  void setTiming(QSharedPointer<CommandTiming> timing);
+
+  /**
+   * @brief getTiming
+   * @return null if timing isn't recorded
+   */
+  QSharedPointer<CommandTiming> getTiming() const;
+
   /**
    * @brief Enable/disable pipeline mode. Default is off.
    * @param enable
@@ -207,13 +299,18 @@ public:
 
 protected:
     QObject * m_owner;
+    QPointer<QObject> m_ownerGuard;
+    QThread * m_ownerThread;
     QList<QByteArray> m_commandWithArguments;
     QList<QList<QByteArray>> m_pipelineCommands;
     int m_dbIndex;
     bool m_hiPriorityCommand;
+    bool m_inlineCallback;
     bool m_isPipeline;
     bool m_transaction;
+    qint64 m_enqueuedAt;
+    QSharedPointer<CommandTiming> m_timing;
     Callback m_callback;
-    AsyncFuture::Deferred<Response> m_deferred;
+    QSharedPointer<AsyncFuture::Deferred<Response>> m_deferred;
 };
 }  // namespace RedisClient
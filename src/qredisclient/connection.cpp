@@ -3,10 +3,16 @@
 #include <QDebug>
 #include <QDir>
 #include <QJsonDocument>
+#include <QMetaMethod>
+#include <QPointer>
 #include <QRegularExpression>
 #include <QThread>
+#include <limits>
 
 #include "command.h"
+#include "keysnapshot.h"
+#include "namespaceaggregator.h"
+#include "private/responseemmiter.h"
 #include "scancommand.h"
 #include "transporters/defaulttransporter.h"
 #include "utils/compat.h"
@@ -19,13 +25,19 @@
 inline void initResources() { Q_INIT_RESOURCE(lua); }
 
 const QString END_OF_COLLECTION = "end_of_collection";
+const QString SCAN_CANCELED = "Scan was canceled";
 
 RedisClient::Connection::Connection(const ConnectionConfig &c, bool autoConnect)
     : m_config(c),
       m_dbNumber(0),
       m_currentMode(Mode::Normal),
       m_autoConnect(autoConnect),
-      m_stoppingTransporter(false) {
+      m_stoppingTransporter(false),
+      m_inlineCallbacks(false),
+      m_stats(new ConnectionStats()),
+      m_tracer(new Tracer()),
+      m_scripts(new ScriptCache()),
+      m_logLevel(LogLevel::Info) {
   initResources();
 }
 
@@ -223,9 +235,13 @@ QFuture<RedisClient::Response> RedisClient::Connection::runCommand(
                      static_cast<Qt::ConnectionType>(Qt::QueuedConnection |
                                                      Qt::UniqueConnection));
 
-  auto deferred = cmd.getDeferred();
+  QList<Command> commands{cmd};
+  auto deferred = commands.first().attachDeferred();
 
-  emit addCommandsToWorker({cmd});
+  if (m_inlineCallbacks && cmd.getOwner() != this)
+    commands.first().setInlineCallback();
+
+  emit addCommandsToWorker(commands);
 
   return deferred.future();
 }
@@ -252,7 +268,109 @@ void RedisClient::Connection::runCommands(const QList<Command> &commands) {
                        static_cast<Qt::ConnectionType>(Qt::QueuedConnection |
                                                        Qt::UniqueConnection));
   }
-  emit addCommandsToWorker(commands);
+
+  if (!m_inlineCallbacks) {
+    emit addCommandsToWorker(commands);
+    return;
+  }
+
+  QList<Command> inlineCommands;
+  inlineCommands.reserve(commands.size());
+
+  for (Command cmd : commands) {
+    if (cmd.getOwner() && cmd.getOwner() != this) cmd.setInlineCallback();
+
+    inlineCommands.append(cmd);
+  }
+  emit addCommandsToWorker(inlineCommands);
+}
+
+RedisClient::Response RedisClient::Connection::execSync(
+    const RedisClient::Command &cmd, uint timeout) {
+  if (m_transporterThread &&
+      QThread::currentThread() == m_transporterThread.data())
+    throw Exception("Cannot execute blocking command in transporter thread");
+
+  if (!isConnected()) {
+    if (!m_autoConnect)
+      throw Exception("Cannot run command in not connected state");
+
+    if (!connect(true)) throw Exception("Cannot connect to redis-server");
+  }
+
+  ResponseWaiter waiter;
+  Command syncCmd(cmd);
+  syncCmd.setCallBack(this, waiter.callback());
+  syncCmd.setInlineCallback();
+
+  // Running commands are canceled without callback on transport error,
+  // so waiter is woken up directly from transporter thread
+  QMetaObject::Connection onError = QObject::connect(
+      m_transporter.data(), &AbstractTransporter::errorOccurred,
+      [waiter](const QString &err) { waiter.fail(err); });
+  QMetaObject::Connection onShutdown =
+      QObject::connect(this, &Connection::shutdownStart, [waiter]() {
+        waiter.fail("Connection was closed");
+      });
+
+  bool received = false;
+
+  try {
+    runCommand(syncCmd);
+    received =
+        waiter.wait(timeout > 0 ? timeout : m_config.executeTimeout());
+  } catch (...) {
+    QObject::disconnect(onError);
+    QObject::disconnect(onShutdown);
+    throw;
+  }
+
+  QObject::disconnect(onError);
+  QObject::disconnect(onShutdown);
+
+  if (!received) throw Exception("Execution timeout");
+
+  if (!waiter.error().isEmpty()) throw Exception(waiter.error());
+
+  return waiter.response();
+}
+
+RedisClient::Response RedisClient::Connection::execSync(
+    const QList<QByteArray> &rawCmd, int db, uint timeout) {
+  return execSync(Command(rawCmd, db), timeout);
+}
+
+void RedisClient::Connection::setInlineCallbacks(bool enable) {
+  m_inlineCallbacks = enable;
+}
+
+bool RedisClient::Connection::inlineCallbacks() const {
+  return m_inlineCallbacks;
+}
+
+QSharedPointer<RedisClient::ConnectionStats> RedisClient::Connection::stats()
+    const {
+  return m_stats;
+}
+
+void RedisClient::Connection::enableTracing(int capacity) {
+  m_tracer->start(capacity);
+}
+
+void RedisClient::Connection::disableTracing() { m_tracer->stop(); }
+
+QSharedPointer<RedisClient::Tracer> RedisClient::Connection::tracer() const {
+  return m_tracer;
+}
+
+void RedisClient::Connection::setLogLevel(RedisClient::LogLevel level) {
+  m_logLevel = level;
+
+  if (m_transporter) m_transporter->setLogLevel(level);
+}
+
+RedisClient::LogLevel RedisClient::Connection::logLevel() const {
+  return m_logLevel;
 }
 
 bool RedisClient::Connection::waitForIdle(uint timeout) {
@@ -275,22 +393,37 @@ QSharedPointer<RedisClient::Connection> RedisClient::Connection::clone(
 
   newConnection->m_currentMode = m_currentMode;
   newConnection->m_clusterSlots = m_clusterSlots;
+  newConnection->m_scripts = m_scripts;
 
   return newConnection;
 }
 
-void RedisClient::Connection::retrieveCollection(
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::retrieveCollection(
     const ScanCommand &cmd, Connection::CollectionCallback callback) {
   if (!cmd.isValidScanCommand()) throw Exception("Invalid command");
 
-  processScanCommand(cmd, callback);
+  QSharedPointer<ScanHandle> handle(new ScanHandle());
+
+  if (cmd.uniqueResults())
+    handle->m_seen = QSharedPointer<ScanDedupSet>(new ScanDedupSet());
+
+  processScanCommand(cmd, callback, handle);
+
+  return handle;
 }
 
-void RedisClient::Connection::retrieveCollectionIncrementally(
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::retrieveCollectionIncrementally(
     const ScanCommand &cmd,
     RedisClient::Connection::IncrementalCollectionCallback callback) {
   if (!cmd.isValidScanCommand()) throw Exception("Invalid command");
 
+  QSharedPointer<ScanHandle> handle(new ScanHandle());
+
+  if (cmd.uniqueResults())
+    handle->m_seen = QSharedPointer<ScanDedupSet>(new ScanDedupSet());
+
   processScanCommand(
       cmd,
       [callback](QVariant c, QString err) {
@@ -302,7 +435,29 @@ void RedisClient::Connection::retrieveCollectionIncrementally(
           callback(c, QString(), false);
         }
       },
-      QSharedPointer<QVariantList>(), true);
+      handle, QSharedPointer<QVariantList>(), true);
+
+  return handle;
+}
+
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::retrieveValueCollection(
+    const ScanCommand &cmd, ValueCollectionCallback callback) {
+  QSharedPointer<ValueCollection> result(
+      new ValueCollection(ValueCollection::typeOf(cmd)));
+
+  return retrieveCollectionIncrementally(
+      cmd, [callback, result](QVariant r, QString err, bool final) {
+        if (!err.isEmpty())
+          return callback(ValueCollection(result->type()), err);
+
+        result->append(r.toList());
+
+        if (!final) return;
+
+        result->squeeze();
+        callback(*result, QString());
+      });
 }
 
 RedisClient::ConnectionConfig RedisClient::Connection::getConfig() const {
@@ -463,15 +618,16 @@ void RedisClient::Connection::flushDbKeys(
   }
 }
 
-void RedisClient::Connection::getDatabaseKeys(RawKeysListCallback callback,
-                                              const QString &pattern,
-                                              int dbIndex, long scanLimit) {
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::getDatabaseKeys(RawKeysListCallback callback,
+                                         const QString &pattern, int dbIndex,
+                                         long scanLimit) {
   QList<QByteArray> rawCmd{"scan",  "0",
                            "MATCH", pattern.toUtf8(),
                            "COUNT", QString::number(scanLimit).toLatin1()};
   ScanCommand keyCmd(rawCmd, dbIndex);
 
-  retrieveCollection(keyCmd, [callback](QVariant r, QString err) {
+  return retrieveCollection(keyCmd, [callback](QVariant r, QString err) {
     if (!err.isEmpty())
       return callback(RawKeysList(), QString("Cannot load keys: %1").arg(err));
 
@@ -481,23 +637,218 @@ void RedisClient::Connection::getDatabaseKeys(RawKeysListCallback callback,
   });
 }
 
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::getDatabaseKeysPacked(
+    PackedKeyListCallback callback, const QString &pattern, int dbIndex,
+    long scanLimit, bool withSlots) {
+  QSharedPointer<PackedKeyList> result(new PackedKeyList(withSlots));
+
+  QList<QByteArray> rawCmd{"scan",  "0",
+                           "MATCH", pattern.toUtf8(),
+                           "COUNT", QByteArray::number(qint64(scanLimit))};
+  ScanCommand keyCmd(rawCmd, dbIndex);
+
+  return retrieveCollectionIncrementally(
+      keyCmd, [callback, result](QVariant r, QString err, bool final) {
+        if (!err.isEmpty())
+          return callback(PackedKeyList(),
+                          QString("Cannot load keys: %1").arg(err));
+
+        result->append(r.toList());
+
+        if (!final) return;
+
+        result->squeeze();
+        callback(*result, QString());
+      });
+}
+
+void RedisClient::Connection::loadKeysMetadata(
+    const QList<QByteArray> &keys, KeyMetadata::Fields fields, int dbIndex,
+    KeyMetadataCallback callback) {
+  if (keys.isEmpty() || !fields) {
+    KeyMetadataList result;
+
+    for (const QByteArray &key : keys) result.append(KeyMetadata(key));
+
+    return callback(result, QString());
+  }
+
+  struct State {
+    KeyMetadataList result;
+    int remaining = 0;
+    QString firstError;
+    bool finished = false;
+    QMetaObject::Connection onError;
+    QMetaObject::Connection onShutdown;
+  };
+
+  QSharedPointer<State> state(new State());
+  QList<Command> commands;
+
+  state->result.reserve(keys.size());
+
+  auto finish = [state, callback](const QString &err) {
+    if (state->finished) return;
+
+    state->finished = true;
+    QObject::disconnect(state->onError);
+    QObject::disconnect(state->onShutdown);
+    callback(state->result, err);
+  };
+
+  auto addCommand = [this, &commands, state, finish, dbIndex](
+                        int index, const QList<QByteArray> &rawCmd,
+                        std::function<void(KeyMetadata &, const QVariant &)>
+                            apply) {
+    Command cmd(rawCmd, dbIndex);
+
+    cmd.setCallBack(this, [state, finish, index, apply](
+                              RedisClient::Response r, QString error) {
+      if (state->finished) return;
+
+      // Errors of single command (e.g. disabled MEMORY) keep default value
+      if (error.isEmpty() && !r.isErrorMessage())
+        apply(state->result[index], r.value());
+      else if (!error.isEmpty() && state->firstError.isEmpty())
+        state->firstError = error;
+
+      if (--state->remaining == 0) finish(state->firstError);
+    });
+
+    commands.append(cmd);
+    ++state->remaining;
+  };
+
+  for (int i = 0; i < keys.size(); ++i) {
+    const QByteArray &key = keys.at(i);
+
+    state->result.append(KeyMetadata(key));
+
+    if (fields & KeyMetadata::Type) {
+      addCommand(i, {"TYPE", key}, [](KeyMetadata &m, const QVariant &v) {
+        m.type = v.toByteArray();
+      });
+    }
+
+    if (fields & KeyMetadata::Ttl) {
+      addCommand(i, {"PTTL", key}, [](KeyMetadata &m, const QVariant &v) {
+        m.ttl = v.toLongLong();
+      });
+    }
+
+    if (fields & KeyMetadata::MemoryUsage) {
+      addCommand(i, {"MEMORY", "USAGE", key},
+                 [](KeyMetadata &m, const QVariant &v) {
+                   if (!v.isNull()) m.memoryUsage = v.toLongLong();
+                 });
+    }
+
+    if (fields & KeyMetadata::Encoding) {
+      addCommand(i, {"OBJECT", "ENCODING", key},
+                 [](KeyMetadata &m, const QVariant &v) {
+                   m.encoding = v.toByteArray();
+                 });
+    }
+  }
+
+  // Running commands are canceled without callback on transport error
+  state->onError = QObject::connect(this, &Connection::error, this, finish);
+  state->onShutdown = QObject::connect(
+      this, &Connection::shutdownStart, this,
+      [finish]() { finish("Connection was closed"); });
+
+  try {
+    runCommands(commands);
+  } catch (...) {
+    QObject::disconnect(state->onError);
+    QObject::disconnect(state->onShutdown);
+    throw;
+  }
+}
+
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::getDatabaseKeysMetadata(
+    IncrementalKeyMetadataCallback callback, const QString &pattern,
+    int dbIndex, long scanLimit, KeyMetadata::Fields fields) {
+  struct State {
+    int pendingBatches = 0;
+    bool scanFinished = false;
+    bool failed = false;
+    QWeakPointer<ScanHandle> handle;
+
+    bool canceled() const {
+      auto h = handle.toStrongRef();
+      return h && h->isCanceled();
+    }
+  };
+
+  QSharedPointer<State> state(new State());
+
+  QList<QByteArray> rawCmd{"scan",  "0",
+                           "MATCH", pattern.toUtf8(),
+                           "COUNT", QByteArray::number(qint64(scanLimit))};
+  ScanCommand keyCmd(rawCmd, dbIndex);
+
+  auto fail = [state, callback](const QString &err) {
+    state->failed = true;
+    callback(KeyMetadataList(), err, true);
+  };
+
+  auto handle = retrieveCollectionIncrementally(
+      keyCmd, [this, callback, state, fail, fields, dbIndex](
+                  QVariant r, QString err, bool final) {
+        if (state->failed) return;
+
+        if (!err.isEmpty())
+          return fail(QString("Cannot load keys: %1").arg(err));
+
+        state->scanFinished = final;
+
+        QList<QByteArray> keys = convertQVariantList(r.toList());
+
+        if (keys.isEmpty()) {
+          if (final && state->pendingBatches == 0)
+            callback(KeyMetadataList(), QString(), true);
+          return;
+        }
+
+        state->pendingBatches++;
+
+        loadKeysMetadata(
+            keys, fields, dbIndex,
+            [callback, state, fail](const KeyMetadataList &batch,
+                                    const QString &err) {
+              if (state->failed || state->canceled()) return;
+
+              if (!err.isEmpty())
+                return fail(QString("Cannot load keys metadata: %1").arg(err));
+
+              state->pendingBatches--;
+
+              callback(batch, QString(),
+                       state->scanFinished && state->pendingBatches == 0);
+            });
+      });
+
+  state->handle = handle;
+  return handle;
+}
+
 void RedisClient::Connection::getNamespaceItems(
     RedisClient::Connection::NamespaceItemsCallback callback,
     const QString &nsSeparator, const QString &filter, int dbIndex) {
-  QFile script("://scan.lua");
-  if (!script.open(QIODevice::ReadOnly)) {
+  static const QByteArray LUA_SCRIPT = []() {
+    QFile script("://scan.lua");
+    return script.open(QIODevice::ReadOnly) ? script.readAll() : QByteArray();
+  }();
+
+  if (LUA_SCRIPT.isEmpty()) {
     qWarning() << "Cannot open LUA resource";
     return;
   }
 
-  QByteArray LUA_SCRIPT = script.readAll();
-
-  QList<QByteArray> rawCmd{"eval", LUA_SCRIPT, "0", nsSeparator.toUtf8(),
-                           filter.toUtf8()};
-
-  Command evalCmd(rawCmd, dbIndex);
-
-  evalCmd.setCallBack(this, [callback](RedisClient::Response r, QString error) {
+  auto onResult = [callback](RedisClient::Response r, QString error) {
     if (!error.isEmpty()) {
       return callback(NamespaceItems(), error);
     }
@@ -537,11 +888,239 @@ void RedisClient::Connection::getNamespaceItems(
     foreach (QString key, rootKeys) { keys.append(key.toUtf8()); }
 
     callback(NamespaceItems(rootNs, keys), QString());
+  };
+
+  evalScript(LUA_SCRIPT, {}, {nsSeparator.toUtf8(), filter.toUtf8()}, this,
+             onResult, dbIndex);
+}
+
+void RedisClient::Connection::evalScript(
+    const QByteArray &script, const QList<QByteArray> &keys,
+    const QList<QByteArray> &args, QObject *owner,
+    RedisClient::Command::Callback callback, int db) {
+  QByteArray sha1 = m_scripts->add(script);
+
+  QList<QByteArray> rawCmd{"EVALSHA", sha1, QByteArray::number(keys.size())};
+  rawCmd.append(keys);
+  rawCmd.append(args);
+
+  Command evalCmd(rawCmd, db);
+  QString node = scriptNode(evalCmd);
+
+  if (node.isEmpty() || !m_scripts->isLoaded(node, sha1)) {
+    rawCmd[0] = "EVAL";
+    rawCmd[1] = script;
+    evalCmd = Command(rawCmd, db);
+  }
+
+  bool keyless = evalCmd.getKeyName().isEmpty();
+
+  evalCmd.setCallBack(owner, [this, script, keys, args, owner, callback, db,
+                              sha1, node, keyless,
+                              evalCmd](RedisClient::Response r,
+                                       QString error) {
+    if (error.isEmpty() && r.isNoScriptError()) {
+      // Script cache of node was flushed or node was restarted
+      if (!node.isEmpty()) m_scripts->setLoaded(node, sha1, false);
+      return evalScript(script, keys, args, owner, callback, db);
+    }
+
+    // Command with key could be redirected to other cluster node
+    QString handledBy = keyless ? node : scriptNode(evalCmd);
+
+    if (error.isEmpty() && !r.isErrorMessage() && !handledBy.isEmpty())
+      m_scripts->setLoaded(handledBy, sha1, true);
+
+    callback(r, error);
   });
 
   runCommand(evalCmd);
 }
 
+void RedisClient::Connection::preloadScripts(
+    std::function<void(const QString &)> callback) {
+  if (m_scripts->scripts().isEmpty()) return callback(QString());
+
+  if (mode() != Mode::Cluster) {
+    return loadScriptsOnCurrentNode([callback](const QString &err) {
+      callback(err.isEmpty() ? err
+                             : QString("Cannot load scripts: %1").arg(err));
+    });
+  }
+
+  getMasterNodes([this, callback](const HostList &hosts, const QString &err) {
+    if (err.size() > 0) return callback(err);
+
+    preloadScriptsOnNodes(QSharedPointer<HostList>(new HostList(hosts)),
+                          callback);
+  });
+}
+
+void RedisClient::Connection::preloadScriptsOnNodes(
+    QSharedPointer<HostList> nodes,
+    std::function<void(const QString &)> callback) {
+  if (nodes->isEmpty()) return callback(QString());
+
+  clusterConnectToNode(
+      nodes->takeFirst(), [this, nodes, callback](const QString &err) {
+        if (!err.isEmpty()) {
+          return callback(QObject::tr("Cannot connect to cluster node %1:%2")
+                              .arg(m_config.host())
+                              .arg(m_config.port()));
+        }
+
+        loadScriptsOnCurrentNode([this, nodes, callback](const QString &err) {
+          if (!err.isEmpty())
+            return callback(QString("Cannot load scripts: %1").arg(err));
+
+          preloadScriptsOnNodes(nodes, callback);
+        });
+      });
+}
+
+QString RedisClient::Connection::scriptNode(const Command &cmd) {
+  if (mode() != Mode::Cluster || cmd.getKeyName().isEmpty())
+    return currentNode();
+
+  if (m_clusterSlots.isEmpty()) return QString();
+
+  Host h = getClusterHost(cmd);
+
+  return QString("%1:%2")
+      .arg(m_config.overrideClusterHost() ? h.first : m_config.host())
+      .arg(h.second);
+}
+
+QSharedPointer<RedisClient::ScriptCache> RedisClient::Connection::scripts()
+    const {
+  return m_scripts;
+}
+
+QString RedisClient::Connection::currentNode() const {
+  return QString("%1:%2").arg(m_config.host()).arg(m_config.port());
+}
+
+void RedisClient::Connection::loadScriptsOnCurrentNode(
+    std::function<void(const QString &)> callback) {
+  QList<QByteArray> scripts = m_scripts->scripts();
+  QString node = currentNode();
+
+  QSharedPointer<int> remaining(new int(scripts.size()));
+  QSharedPointer<QString> firstError(new QString());
+  QList<Command> commands;
+
+  for (const QByteArray &script : scripts) {
+    Command loadCmd({"SCRIPT", "LOAD", script}, -1);
+
+    loadCmd.setCallBack(this, [this, node, remaining, firstError, callback](
+                                  RedisClient::Response r, QString error) {
+      if (error.isEmpty() && r.isErrorMessage())
+        error = r.value().toString();
+
+      if (error.isEmpty())
+        m_scripts->setLoaded(node, r.value().toByteArray(), true);
+      else if (firstError->isEmpty())
+        *firstError = error;
+
+      if (--(*remaining) == 0) callback(*firstError);
+    });
+
+    commands.append(loadCmd);
+  }
+
+  runCommands(commands);
+}
+
+QSharedPointer<RedisClient::ScanHandle>
+RedisClient::Connection::getNamespaceItemsIncrementally(
+    IncrementalNamespaceItemsCallback callback, const QString &nsSeparator,
+    const QString &filter, int dbIndex, long scanLimit) {
+  QSharedPointer<NamespaceAggregator> aggregator(
+      new NamespaceAggregator(nsSeparator.toUtf8(), filter.toUtf8()));
+  QSharedPointer<qint64> lastReportAt(new qint64(ConnectionStats::now()));
+
+  QList<QByteArray> rawCmd{"scan",  "0",
+                           "MATCH", aggregator->matchPattern(),
+                           "COUNT", QByteArray::number(qint64(scanLimit))};
+  ScanCommand keyCmd(rawCmd, dbIndex);
+
+  return retrieveCollectionIncrementally(
+      keyCmd, [callback, aggregator, lastReportAt](QVariant r, QString err,
+                                                   bool final) {
+        if (!err.isEmpty())
+          return callback(NamespaceItems(),
+                          QString("Cannot load keys: %1").arg(err), true);
+
+        aggregator->addKeys(r.toList());
+
+        qint64 now = ConnectionStats::now();
+
+        if (!final && (!aggregator->hasChanges() ||
+                       now - *lastReportAt <
+                           NAMESPACE_SCAN_PROGRESS_INTERVAL * 1000))
+          return;
+
+        *lastReportAt = now;
+        callback(aggregator->takeChanges(), QString(), final);
+      });
+}
+
+QSharedPointer<RedisClient::ScanHandle> RedisClient::Connection::loadKeyIndex(
+    KeyIndexCallback callback, const QString &nsSeparator, int dbIndex,
+    long scanLimit) {
+  QByteArray separator = nsSeparator.toUtf8();
+  QString path = KeySnapshot::path(m_config, dbIndex);
+
+  if (!path.isEmpty() && KeySnapshot::exists(path)) {
+    QString err;
+    auto snapshot = KeySnapshot::open(path, &err);
+
+    if (snapshot && snapshot->dbIndex() == dbIndex &&
+        snapshot->separator() == separator) {
+      callback(QSharedPointer<KeyIndex>(new KeyIndex(snapshot)), QString(),
+               false);
+    } else if (!snapshot) {
+      logMessage(LogLevel::Warning,
+                 QString("Cannot open key snapshot %1: %2").arg(path).arg(err));
+    }
+  }
+
+  return getDatabaseKeysPacked(
+      [this, callback, path, separator, dbIndex](const PackedKeyList &keys,
+                                                 const QString &err) {
+        if (!err.isEmpty())
+          return callback(QSharedPointer<KeyIndex>(), err, true);
+
+        QSharedPointer<KeyIndex> index(new KeyIndex(separator, dbIndex));
+        index->addKeys(keys);
+
+        if (!path.isEmpty()) {
+          QPointer<Connection> guard(this);
+          QThread *connectionThread = thread();
+
+          KeySnapshot::saveInBackground(
+              *index, path,
+              [guard, connectionThread, path](bool saved,
+                                              const QString &saveError) {
+                if (saved) return;
+
+                ResponseEmitter::post(connectionThread, [guard, path,
+                                                         saveError]() {
+                  if (guard.isNull()) return;
+
+                  guard->logMessage(LogLevel::Warning,
+                                    QString("Cannot save key snapshot %1: %2")
+                                        .arg(path)
+                                        .arg(saveError));
+                });
+              });
+        }
+
+        callback(index, QString(), true);
+      },
+      QString("*"), dbIndex, scanLimit);
+}
+
 void RedisClient::Connection::createTransporter() {
   // todo : implement unix socket transporter
   if (m_config.useSshTunnel()) {
@@ -564,15 +1143,71 @@ bool RedisClient::Connection::isTransporterRunning() {
 
 void RedisClient::Connection::processScanCommand(
     const ScanCommand &cmd, CollectionCallback callback,
-    QSharedPointer<QVariantList> result, bool incrementalProcessing) {
+    QSharedPointer<ScanHandle> handle, QSharedPointer<QVariantList> result,
+    bool incrementalProcessing) {
   if (result.isNull())
     result = QSharedPointer<QVariantList>(new QVariantList());
 
+  // Paused scan is continued from ScanHandle::resume() or cancel(), which
+  // can be called from any thread. Continuation doesn't hold the handle.
+  QPointer<Connection> guard(this);
+  QThread *connectionThread = thread();
+
+  ScanHandle::State state = handle->continueOrSuspend(
+      [guard, connectionThread, cmd, callback, result,
+       incrementalProcessing](QSharedPointer<ScanHandle> h) {
+        ResponseEmitter::post(
+            connectionThread,
+            [guard, cmd, callback, h, result, incrementalProcessing]() {
+              // Connection can be destroyed only in this thread
+              if (guard.isNull()) return;
+
+              guard->processScanCommand(cmd, callback, h, result,
+                                        incrementalProcessing);
+            });
+      });
+
+  if (state == ScanHandle::State::Canceled) {
+    callback(QVariant(), SCAN_CANCELED);
+    return;
+  }
+
+  if (state != ScanHandle::State::Running) return;
+
+  if (handle->m_countController.isNull() && m_config.scanTargetLatency() > 0) {
+    // Redis uses COUNT 10 by default
+    handle->m_countController = QSharedPointer<ScanCountController>(
+        new ScanCountController(m_config.scanTargetLatency() * 1000ll,
+                                cmd.count() > 0 ? cmd.count() : 10));
+    handle->m_countController->setMaxItemsPerRound(
+        static_cast<int>(qMin<uint>(m_config.scanMaxItemsPerRound(),
+                                    std::numeric_limits<int>::max())));
+  }
+
+  auto countController = handle->m_countController;
   auto cmdWithCallback = cmd;
+  QSharedPointer<CommandTiming> timing;
+
+  if (countController) {
+    cmdWithCallback.setCount(countController->count());
+
+    // Time spent in client queue shouldn't affect COUNT
+    timing = QSharedPointer<CommandTiming>(new CommandTiming());
+    cmdWithCallback.setTiming(timing);
+  }
+
+  qint64 sentAt = ConnectionStats::now();
 
   cmdWithCallback.setCallBack(
-      this, [this, cmd, result, callback, incrementalProcessing](
-                RedisClient::Response r, QString error) {
+      this, [this, cmd, result, callback, incrementalProcessing, handle,
+             countController, timing,
+             sentAt](RedisClient::Response r, QString error) {
+        // Round in flight is discarded
+        if (handle->isCanceled()) {
+          callback(QVariant(), SCAN_CANCELED);
+          return;
+        }
+
         if (r.isErrorMessage()) {
           /*
            * aliyun cloud provides iscan command for scanning clusters
@@ -582,15 +1217,17 @@ void RedisClient::Connection::processScanCommand(
             auto rawCmd = cmd.getSplitedRepresentattion();
             rawCmd.replace(0, "iscan");
             auto iscanCmd = ScanCommand(rawCmd);
-            return processScanCommand(iscanCmd, callback, result,
+            return processScanCommand(iscanCmd, callback, handle, result,
                                       incrementalProcessing);
           }
 
+          handle->finish();
           callback(r.value(), r.value().toString());
           return;
         }
 
         if (!error.isEmpty()) {
+          handle->finish();
           callback(QVariant(), error);
           return;
         }
@@ -598,6 +1235,8 @@ void RedisClient::Connection::processScanCommand(
         if (incrementalProcessing) result->clear();
 
         if (!r.isValidScanResponse()) {
+          handle->finish();
+
           if (result->isEmpty())
             callback(QVariant(),
                      incrementalProcessing ? END_OF_COLLECTION : QString());
@@ -607,18 +1246,38 @@ void RedisClient::Connection::processScanCommand(
           return;
         }
 
-        result->append(r.getCollection());
+        QVariantList collection = r.getCollection();
+        int duplicates = 0;
+
+        if (countController) {
+          qint64 rtt = timing->networkRtt();
+
+          // Response wasn't read from socket (e.g. replay)
+          if (rtt < 0) rtt = ConnectionStats::now() - sentAt;
+
+          countController->update(rtt, collection.size());
+        }
+
+        if (handle->m_seen)
+          duplicates = handle->m_seen->filter(collection, cmd.itemSize());
+
+        result->append(collection);
+        handle->addRound(r.getCursor(), collection.size(), duplicates);
 
         if (r.getCursor() <= 0) {
+          handle->finish();
           callback(QVariant(*result),
                    incrementalProcessing ? END_OF_COLLECTION : QString());
           return;
         }
 
+        if (incrementalProcessing) callback(QVariant(*result), QString());
+
         auto newCmd = cmd;
         newCmd.setCursor(r.getCursor());
 
-        processScanCommand(newCmd, callback, result);
+        processScanCommand(newCmd, callback, handle, result,
+                           incrementalProcessing);
       });
 
   runCommand(cmdWithCallback);
@@ -642,12 +1301,17 @@ void RedisClient::Connection::clusterConnectToNextMasterNode(
   Host h = m_notVisitedMasterNodes->first();
   m_notVisitedMasterNodes->removeFirst();
 
+  clusterConnectToNode(h, callback);
+}
+
+void RedisClient::Connection::clusterConnectToNode(
+    const Host &node, std::function<void(const QString &err)> callback) {
   callAfterConnect(callback);
 
   if (m_config.overrideClusterHost()) {
-    reconnectTo(h.first, h.second);
+    reconnectTo(node.first, node.second);
   } else {
-    reconnectTo(m_config.host(), h.second);
+    reconnectTo(m_config.host(), node.second);
   }
 }
 
@@ -817,6 +1481,47 @@ QFuture<bool> RedisClient::Connection::isCommandSupported(
   return d->future();
 }
 
+void RedisClient::Connection::logMessage(RedisClient::LogLevel level,
+                                         const QString &message) {
+  bool enabled = static_cast<int>(level) <= static_cast<int>(m_logLevel) &&
+                 hasLogListeners();
+
+  if (!enabled && !(level <= LogLevel::Debug && hasTextLogListeners()))
+    return;
+
+  processLogRecord(LogRecord(level, LogRecord::Event::Message, 0, {message}));
+}
+
+bool RedisClient::Connection::hasLogListeners() const {
+  static const QMetaMethod recordSignal =
+      QMetaMethod::fromSignal(&Connection::logRecord);
+  static const QMetaMethod logSignal =
+      QMetaMethod::fromSignal(&Connection::log);
+
+  return isSignalConnected(recordSignal) || isSignalConnected(logSignal);
+}
+
+bool RedisClient::Connection::hasTextLogListeners() const {
+  static const QMetaMethod logSignal =
+      QMetaMethod::fromSignal(&Connection::log);
+
+  return isSignalConnected(logSignal);
+}
+
+void RedisClient::Connection::processLogRecord(
+    const RedisClient::LogRecord &r) {
+  LogRecord record(r);
+  record.connectionId = m_config.id();
+  record.connectionName = m_config.name();
+
+  // Records below logLevel() are created only for plain text listeners
+  if (static_cast<int>(record.level) <= static_cast<int>(m_logLevel))
+    emit logRecord(record);
+
+  // Text is formatted only if someone listens to legacy signal
+  if (hasTextLogListeners()) emit log(record.toString());
+}
+
 void RedisClient::Connection::auth() {
   auto handleConnectionError = [this](const QString &err) {
     emit error(QString("Connection error on AUTH: %1").arg(err));
@@ -863,10 +1568,11 @@ void RedisClient::Connection::auth() {
                 emit authOk();
                 emit connected();
               });
-              emit log("Cluster detected");
+              logMessage(LogLevel::Info, "Cluster detected");
             } else if (m_serverInfo.sentinelMode) {
               m_currentMode = Mode::Sentinel;
-              emit log("Sentinel detected. Requesting master node...");
+              logMessage(LogLevel::Info,
+                         "Sentinel detected. Requesting master node...");
               return sentinelConnectToMaster();
             } else {
                 emit authOk();
@@ -896,10 +1602,11 @@ void RedisClient::Connection::auth() {
       } else if (!authResult.isOkMessage()) {
         // NOTE(u_glide): Workaround for redis-sentinel < 5.0 and for
         // redis-sentinels >= 5.0.1 without configured password
-        emit log(QString("redis-server doesn't support AUTH command or is"
-                         "misconfigured. Trying "
-                         "to proceed without password. (Error: %1)")
-                     .arg(authResult.value().toString()));        
+        logMessage(LogLevel::Warning,
+                   QString("redis-server doesn't support AUTH command or is"
+                           "misconfigured. Trying "
+                           "to proceed without password. (Error: %1)")
+                       .arg(authResult.value().toString()));
       }
 
       testConnection();
@@ -13,8 +13,17 @@
 #include "command.h"
 #include "connectionconfig.h"
 #include "exception.h"
+#include "logging.h"
 #include "response.h"
 #include "scancommand.h"
+#include "keyindex.h"
+#include "keymetadata.h"
+#include "packedkeylist.h"
+#include "scanhandle.h"
+#include "scriptcache.h"
+#include "stats.h"
+#include "tracer.h"
+#include "valuecollection.h"
 
 namespace RedisClient {
 
@@ -23,6 +32,7 @@ class AbstractTransporter;
 typedef QMap<int, int> DatabaseList;
 
 #define DEFAULT_SCAN_LIMIT 10000
+#define NAMESPACE_SCAN_PROGRESS_INTERVAL 250
 
 /**
  * @brief The ServerInfo struct
@@ -168,10 +178,68 @@ class Connection : public QObject {
    * @param callback
    * @param pattern
    * @param dbIndex
+   * @return handle of SCAN, see ScanHandle
    */
-  virtual void getDatabaseKeys(RawKeysListCallback callback,
-                               const QString &pattern = QString("*"),
-                               int dbIndex = 0, long scanLimit = DEFAULT_SCAN_LIMIT);
+  virtual QSharedPointer<ScanHandle> getDatabaseKeys(
+      RawKeysListCallback callback, const QString &pattern = QString("*"),
+      int dbIndex = 0, long scanLimit = DEFAULT_SCAN_LIMIT);
+
+  typedef std::function<void(const PackedKeyList &, const QString &)>
+      PackedKeyListCallback;
+
+  /**
+   * @brief Same as getDatabaseKeys() but keys of every SCAN round are
+   * appended to PackedKeyList and released right away, so full result
+   * is never held as list of QVariant/QByteArray.
+   * @param callback
+   * @param pattern
+   * @param dbIndex
+   * @param scanLimit
+   * @param withSlots - calculate cluster hash slots of keys
+   */
+  virtual QSharedPointer<ScanHandle> getDatabaseKeysPacked(
+      PackedKeyListCallback callback, const QString &pattern = QString("*"),
+      int dbIndex = 0, long scanLimit = DEFAULT_SCAN_LIMIT,
+      bool withSlots = false);
+
+  typedef std::function<void(const KeyMetadataList &, const QString &)>
+      KeyMetadataCallback;
+
+  /**
+   * @brief Load metadata of given keys. Commands for all keys and fields are
+   * sent at once and pipelined by transporter, so loading takes few round
+   * trips instead of one per key and field.
+   * @param keys
+   * @param fields
+   * @param dbIndex
+   * @param callback - records are in order of keys
+   */
+  virtual void loadKeysMetadata(const QList<QByteArray> &keys,
+                                KeyMetadata::Fields fields, int dbIndex,
+                                KeyMetadataCallback callback);
+
+  typedef std::function<void(const KeyMetadataList &, const QString &,
+                             bool final)>
+      IncrementalKeyMetadataCallback;
+
+  /**
+   * @brief Scan keys and load metadata of every SCAN batch with
+   * loadKeysMetadata(). Enriched batches are delivered as soon as they are
+   * loaded, while next SCAN rounds are running. Last call has final = true.
+   * @param callback
+   * @param pattern
+   * @param dbIndex
+   * @param scanLimit
+   * @param fields
+   * @return handle of SCAN. After cancel() callback is called once with
+   * error and final = true, metadata of batches still being loaded is not
+   * delivered
+   */
+  virtual QSharedPointer<ScanHandle> getDatabaseKeysMetadata(
+      IncrementalKeyMetadataCallback callback,
+      const QString &pattern = QString("*"), int dbIndex = 0,
+      long scanLimit = DEFAULT_SCAN_LIMIT,
+      KeyMetadata::Fields fields = KeyMetadata::AllFields);
 
   typedef QList<QPair<QByteArray, ulong>> RootNamespaces;
   typedef QList<QByteArray> RootKeys;
@@ -184,6 +252,76 @@ class Connection : public QObject {
                                  const QString &pattern = QString("*"),
                                  int dbIndex = 0);
 
+  typedef std::function<void(const NamespaceItems &, const QString &,
+                             bool final)>
+      IncrementalNamespaceItemsCallback;
+
+  /**
+   * @brief Client-side alternative of getNamespaceItems(): keys are loaded
+   * with SCAN rounds and aggregated by NamespaceAggregator, so server is
+   * never blocked longer than one SCAN round.
+   * Callback receives changes since previous call: namespaces with updated
+   * total counts and new root keys. Partial results are delivered at most
+   * every NAMESPACE_SCAN_PROGRESS_INTERVAL msec, last call has final = true.
+   * @param callback
+   * @param nsSeparator
+   * @param pattern
+   * @param dbIndex
+   * @param scanLimit - COUNT of SCAN round
+   */
+  virtual QSharedPointer<ScanHandle> getNamespaceItemsIncrementally(
+      IncrementalNamespaceItemsCallback callback, const QString &nsSeparator,
+      const QString &pattern = QString("*"), int dbIndex = 0,
+      long scanLimit = DEFAULT_SCAN_LIMIT);
+
+  typedef std::function<void(QSharedPointer<KeyIndex>, const QString &,
+                             bool final)>
+      KeyIndexCallback;
+
+  /**
+   * @brief Load KeyIndex of all keys in db. If ConnectionConfig has
+   * keySnapshotDir(), index is opened from KeySnapshot of previous load and
+   * passed to callback (final = false) before method returns. Keys are
+   * re-scanned in background anyway: up-to-date index is passed with
+   * final = true and saved as new snapshot in background thread, see
+   * KeySnapshot::saveInBackground().
+   * @param callback
+   * @param nsSeparator
+   * @param dbIndex
+   * @param scanLimit
+   */
+  virtual QSharedPointer<ScanHandle> loadKeyIndex(
+      KeyIndexCallback callback, const QString &nsSeparator, int dbIndex = 0,
+      long scanLimit = DEFAULT_SCAN_LIMIT);
+
+  /**
+   * @brief Run Lua script with EVALSHA. Full script is sent (EVAL) only to
+   * nodes which don't have it in script cache yet, NOSCRIPT errors are
+   * handled by re-sending script transparently.
+   * @param script - script body, registered in scripts() cache
+   * @param keys
+   * @param args
+   * @param owner
+   * @param callback
+   * @param db
+   */
+  void evalScript(const QByteArray &script, const QList<QByteArray> &keys,
+                  const QList<QByteArray> &args, QObject *owner,
+                  RedisClient::Command::Callback callback, int db = -1);
+
+  /**
+   * @brief Load all registered scripts with SCRIPT LOAD on current node or
+   * on all master nodes in cluster mode
+   * @param callback
+   */
+  void preloadScripts(std::function<void(const QString &)> callback);
+
+  /**
+   * @brief Scripts used by evalScript() and nodes which have them loaded
+   * @return
+   */
+  QSharedPointer<ScriptCache> scripts() const;
+
   /**
    * @brief getClusterKeys - async keys loading from all cluster nodes
    * @param callback
@@ -315,18 +453,33 @@ class Connection : public QObject {
    * @brief retrieveCollection
    * @param cmd
    * @param callback
+   * @return handle to cancel, pause or resume scan and track its progress
    */
-  virtual void retrieveCollection(const ScanCommand &cmd,
-                                  CollectionCallback callback);
+  virtual QSharedPointer<ScanHandle> retrieveCollection(
+      const ScanCommand &cmd, CollectionCallback callback);
 
   /**
    * @brief retrieveCollection
    * @param cmd
    * @param callback
+   * @return handle to cancel, pause or resume scan and track its progress
    */
-  virtual void retrieveCollectionIncrementally(
+  virtual QSharedPointer<ScanHandle> retrieveCollectionIncrementally(
       const ScanCommand &cmd, IncrementalCollectionCallback callback);
 
+  typedef std::function<void(const ValueCollection &, const QString &)>
+      ValueCollectionCallback;
+
+  /**
+   * @brief Same as retrieveCollection() for HSCAN/ZSCAN/SSCAN, but elements
+   * of every round are appended to typed ValueCollection columns and
+   * released right away
+   * @param cmd
+   * @param callback
+   */
+  virtual QSharedPointer<ScanHandle> retrieveValueCollection(
+      const ScanCommand &cmd, ValueCollectionCallback callback);
+
   /**
    * @brief runCommand
    * @param cmd
@@ -340,6 +493,86 @@ class Connection : public QObject {
    */
   virtual void runCommands(const QList<Command> &cmd);
 
+  /**
+   * @brief Execute command and block calling thread until response is
+   * received. Caller is parked on wait condition which is signaled directly
+   * from transporter thread, nested event loop is not used.
+   * Intended for worker threads, can't be called from transporter thread.
+   * Connection is established (with waiting) if it's not connected yet.
+   * @param cmd - own callback of command is replaced
+   * @param timeout - in milliseconds, ConnectionConfig::executeTimeout()
+   * is used if 0
+   * @throws Connection::Exception on timeout or transport error
+   */
+  Response execSync(const Command &cmd, uint timeout = 0);
+
+  /**
+   * @brief Execute raw command in blocking mode. See execSync(const Command&)
+   * @param rawCmd
+   * @param db
+   * @param timeout
+   */
+  Response execSync(const QList<QByteArray> &rawCmd, int db = -1,
+                    uint timeout = 0);
+
+  /**
+   * @brief Execute callbacks of all commands with owners other than
+   * connection itself directly in transporter thread.
+   * See Command::setInlineCallback()
+   * @param enable
+   */
+  void setInlineCallbacks(bool enable);
+
+  /**
+   * @brief inlineCallbacks
+   * @return
+   */
+  bool inlineCallbacks() const;
+
+  /**
+   * @brief Connection statistics: per-command latency histograms, traffic
+   * and queue counters. Object is shared with transporter and updated
+   * in background, it's safe to read it from any thread.
+   * @return
+   */
+  QSharedPointer<ConnectionStats> stats() const;
+
+  /**
+   * @brief Start recording command lifecycle (enqueue, dispatch, socket
+   * write, first byte read, parse complete, callback execution) to ring
+   * buffer. Use tracer()->saveChromeTrace() to export it.
+   * @param capacity - number of records kept
+   */
+  void enableTracing(int capacity = 100000);
+
+  /**
+   * @brief disableTracing
+   */
+  void disableTracing();
+
+  /**
+   * @brief tracer
+   * @return
+   */
+  QSharedPointer<Tracer> tracer() const;
+
+  /**
+   * @brief Records with level above given one are not created.
+   * Default is LogLevel::Info: connection events.
+   * LogLevel::Debug adds executed commands, LogLevel::Trace adds received
+   * responses. Records are not created at all while nothing is connected to
+   * logRecord() or log() signals. log() listeners also receive executed
+   * commands at default level, as before leveled logging.
+   * @param level
+   */
+  void setLogLevel(LogLevel level);
+
+  /**
+   * @brief logLevel
+   * @return
+   */
+  LogLevel logLevel() const;
+
   /**
    * @brief waitForIdle - Wait until all commands in queue will be processed
    * @param timeout - in milliseconds
@@ -365,6 +598,7 @@ class Connection : public QObject {
   void addCommandsToWorker(const QList<Command> &);
   void error(const QString &);
   void log(const QString &);
+  void logRecord(const RedisClient::LogRecord &);
   void connected();
   void shutdownStart();
   void disconnected();
@@ -378,24 +612,61 @@ class Connection : public QObject {
   void createTransporter();
   bool isTransporterRunning();
 
-  void processScanCommand(
-      const ScanCommand &cmd, CollectionCallback callback,
-      QSharedPointer<QVariantList> result = QSharedPointer<QVariantList>(),
-      bool incrementalProcessing = false);
+  void processScanCommand(const ScanCommand &cmd, CollectionCallback callback,
+                          QSharedPointer<ScanHandle> handle,
+                          QSharedPointer<QVariantList> result =
+                              QSharedPointer<QVariantList>(),
+                          bool incrementalProcessing = false);
 
   void changeCurrentDbNumber(int db);
 
   void clusterConnectToNextMasterNode(
       std::function<void(const QString &err)> callback);
 
+  void clusterConnectToNode(const Host &node,
+                            std::function<void(const QString &err)> callback);
+
   bool hasNotVisitedClusterNodes() const;  
 
   void sentinelConnectToMaster();
 
   void rawClusterSlots(std::function<void(QVariantList, const QString&)> callback);
 
+  QString currentNode() const;
+
+  void loadScriptsOnCurrentNode(std::function<void(const QString &)> callback);
+
+  /**
+   * @brief Walks own list of nodes, so it doesn't interfere with
+   * getClusterKeys()/flushDbKeys()
+   */
+  void preloadScriptsOnNodes(QSharedPointer<HostList> nodes,
+                             std::function<void(const QString &)> callback);
+
+  /**
+   * @brief Node ("host:port") which executes command: owner of key slot in
+   * cluster mode, current node otherwise. Empty if owner is unknown (slots
+   * are reloaded after redirect).
+   */
+  QString scriptNode(const Command &cmd);
+
+  void logMessage(LogLevel level, const QString &message);
+
+  /**
+   * @brief Thread-safe, used by transporter to skip creation of records
+   */
+  bool hasLogListeners() const;
+
+  /**
+   * @brief Thread-safe. Plain text log() listeners receive records up to
+   * LogLevel::Debug (executed commands) regardless of logLevel(), as before
+   * leveled logging.
+   */
+  bool hasTextLogListeners() const;
+
  protected slots:
   void auth();
+  void processLogRecord(const RedisClient::LogRecord &record);
 
  protected:
   ConnectionConfig m_config;
@@ -409,9 +680,14 @@ class Connection : public QObject {
   QMutex m_blockingOp;
   bool m_autoConnect;
   bool m_stoppingTransporter;
+  bool m_inlineCallbacks;
   RawKeysListCallback m_collectClusterNodeKeys;
   RedisClient::Command::Callback m_cmdCallback;
   QSharedPointer<HostList> m_notVisitedMasterNodes;
   ClusterSlots m_clusterSlots;
+  QSharedPointer<ConnectionStats> m_stats;
+  QSharedPointer<Tracer> m_tracer;
+  QSharedPointer<ScriptCache> m_scripts;
+  LogLevel m_logLevel;
 };
 }  // namespace RedisClient
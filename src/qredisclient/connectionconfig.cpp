@@ -210,6 +210,46 @@ QVariantHash RedisClient::ConnectionConfig::getInternalParameters() const
     return m_parameters;
 }
 
+uint RedisClient::ConnectionConfig::scanTargetLatency() const
+{
+    return param<uint>("scan_target_latency", 0);
+}
+
+void RedisClient::ConnectionConfig::setScanTargetLatency(uint ms)
+{
+    setParam<uint>("scan_target_latency", ms);
+}
+
+uint RedisClient::ConnectionConfig::scanMaxItemsPerRound() const
+{
+    return param<uint>("scan_max_items_per_round", 0);
+}
+
+void RedisClient::ConnectionConfig::setScanMaxItemsPerRound(uint items)
+{
+    setParam<uint>("scan_max_items_per_round", items);
+}
+
+QString RedisClient::ConnectionConfig::keySnapshotDir() const
+{
+    return param<QString>("key_snapshot_dir");
+}
+
+void RedisClient::ConnectionConfig::setKeySnapshotDir(const QString &path)
+{
+    setParam<QString>("key_snapshot_dir", path);
+}
+
+bool RedisClient::ConnectionConfig::commandStats() const
+{
+    return param<bool>("command_stats", false);
+}
+
+void RedisClient::ConnectionConfig::setCommandStats(bool enabled)
+{
+    setParam<bool>("command_stats", enabled);
+}
+
 bool RedisClient::ConnectionConfig::overrideClusterHost() const
 {
     return param<bool>("cluster_host_override", true);
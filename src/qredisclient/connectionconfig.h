@@ -64,6 +64,35 @@ class ConnectionConfig {
   void setConnectionTimeout(uint timeout);
   void setTimeouts(uint connectionTimeout, uint commandExecutionTimeout);
 
+  /*
+   * Adaptive SCAN: COUNT of SCAN rounds is adjusted to keep round-trip time
+   * of each round near target (ms). 0 - COUNT from command is used as is.
+   */
+  uint scanTargetLatency() const;
+  void setScanTargetLatency(uint ms);
+
+  /*
+   * Adaptive SCAN: COUNT is also reduced to keep number of returned items
+   * per round below this limit (memory used by single reply).
+   * 0 - no limit.
+   */
+  uint scanMaxItemsPerRound() const;
+  void setScanMaxItemsPerRound(uint items);
+
+  /*
+   * Directory of key snapshots (see KeySnapshot), empty - snapshots are
+   * disabled
+   */
+  QString keySnapshotDir() const;
+  void setKeySnapshotDir(const QString& path);
+
+  /*
+   * Per-command latency histograms (ConnectionStats::command()), disabled
+   * by default. Connection-wide counters are always collected.
+   */
+  bool commandStats() const;
+  void setCommandStats(bool enabled);
+
   /*
    * SSL settings
    */
@@ -0,0 +1,258 @@
+#pragma once
+/*
+ * C++20 coroutine support. Available only if consumer code is compiled with
+ * coroutines enabled, library itself doesn't depend on it.
+ * Covered by tests/coroutines target (separate because other targets are
+ * built as C++11).
+ *
+ * RedisClient::Task example() {
+ *   auto r = co_await RedisClient::exec(connection, {"GET", "key"});
+ *   auto items = co_await RedisClient::scan(connection, ScanCommand(...));
+ * }
+ */
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariant>
+#include <coroutine>
+#include <exception>
+
+#include "command.h"
+#include "connection.h"
+#include "response.h"
+#include "scancommand.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The Task class
+ * Minimal eagerly started coroutine type for code which awaits commands.
+ * Coroutine frame is destroyed automatically on completion.
+ */
+class Task {
+ public:
+  struct promise_type {
+    Task get_return_object() noexcept { return Task(); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+namespace detail {
+
+/**
+ * @brief The AwaitState class
+ * Result of awaited operation shared between awaiter and callbacks.
+ * Transport errors and disconnect cancel running commands without calling
+ * their callbacks, so coroutine is also resumed by Connection::error() and
+ * Connection::shutdownStart(). Whatever comes first resumes coroutine,
+ * late callbacks only touch shared state, never the destroyed frame.
+ */
+template <typename T>
+class AwaitState {
+ public:
+  /**
+   * @brief Arm error handlers, must be called before operation is started
+   */
+  void suspend(Connection &connection, QObject *resumeContext,
+               std::coroutine_handle<> h) {
+    QMutexLocker lock(&m_lock);
+    m_handle = h;
+
+    QWeakPointer<AwaitState> weak = m_self;
+    QObject *context = resumeContext ? resumeContext : &connection;
+
+    m_onError = QObject::connect(
+        &connection, &Connection::error, context, [weak](const QString &err) {
+          if (auto state = weak.toStrongRef()) state->resume(T(), err);
+        });
+    m_onShutdown = QObject::connect(
+        &connection, &Connection::shutdownStart, context, [weak]() {
+          if (auto state = weak.toStrongRef())
+            state->resume(T(), "Connection was closed");
+        });
+  }
+
+  void resume(const T &result, const QString &err) {
+    std::coroutine_handle<> h;
+
+    {
+      QMutexLocker lock(&m_lock);
+
+      if (!m_handle) return;
+
+      h = m_handle;
+      m_handle = nullptr;
+      m_result = result;
+      m_error = err;
+
+      QObject::disconnect(m_onError);
+      QObject::disconnect(m_onShutdown);
+    }
+
+    h.resume();
+  }
+
+  T result() {
+    QMutexLocker lock(&m_lock);
+
+    if (!m_error.isEmpty()) throw Connection::Exception(m_error);
+
+    return m_result;
+  }
+
+  static QSharedPointer<AwaitState> create() {
+    QSharedPointer<AwaitState> state(new AwaitState());
+    state->m_self = state;
+    return state;
+  }
+
+ private:
+  AwaitState() = default;
+
+  QMutex m_lock;
+  QWeakPointer<AwaitState> m_self;
+  std::coroutine_handle<> m_handle;
+  QMetaObject::Connection m_onError;
+  QMetaObject::Connection m_onShutdown;
+  T m_result;
+  QString m_error;
+};
+
+}  // namespace detail
+
+/**
+ * @brief The CommandAwaiter class
+ * Awaitable command execution.
+ * If resumeContext is not set coroutine is resumed directly in transporter
+ * thread right after response parsing (see Command::setInlineCallback()),
+ * otherwise it's resumed in resumeContext thread.
+ * co_await returns Response. Transport errors and disconnect resume
+ * coroutine in connection thread (resumeContext thread if it's set) and
+ * are thrown as Connection::Exception.
+ */
+class CommandAwaiter {
+ public:
+  CommandAwaiter(Connection &connection, const Command &cmd,
+                 QObject *resumeContext = nullptr)
+      : m_connection(connection),
+        m_cmd(cmd),
+        m_context(resumeContext),
+        m_state(detail::AwaitState<Response>::create()) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    // Coroutine can be resumed and awaiter destroyed before runCommand()
+    // returns, members are not used after the command is started
+    auto state = m_state;
+    Connection &connection = m_connection;
+    Command cmd = m_cmd;
+
+    cmd.setCallBack(m_context ? m_context : &connection,
+                    [state](Response r, QString err) {
+                      state->resume(r, err);
+                    });
+    cmd.setInlineCallback(m_context == nullptr);
+
+    state->suspend(connection, m_context, h);
+
+    try {
+      connection.runCommand(cmd);
+    } catch (const Connection::Exception &e) {
+      state->resume(Response(), e.what());
+    }
+  }
+
+  Response await_resume() { return m_state->result(); }
+
+ private:
+  Connection &m_connection;
+  Command m_cmd;
+  QObject *m_context;
+  QSharedPointer<detail::AwaitState<Response>> m_state;
+};
+
+/**
+ * @brief The CollectionAwaiter class
+ * Awaitable Connection::retrieveCollection(). Coroutine is resumed in
+ * connection thread once all scan rounds are finished.
+ * co_await returns collected items, errors, disconnect and canceled scan
+ * are thrown as Connection::Exception.
+ */
+class CollectionAwaiter {
+ public:
+  CollectionAwaiter(Connection &connection, const ScanCommand &cmd)
+      : m_connection(connection),
+        m_cmd(cmd),
+        m_state(detail::AwaitState<QVariantList>::create()) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    auto state = m_state;
+    Connection &connection = m_connection;
+    ScanCommand cmd = m_cmd;
+
+    state->suspend(connection, nullptr, h);
+
+    try {
+      connection.retrieveCollection(cmd, [state](QVariant r, QString err) {
+        state->resume(r.toList(), err);
+      });
+    } catch (const Connection::Exception &e) {
+      state->resume(QVariantList(), e.what());
+    }
+  }
+
+  QVariantList await_resume() { return m_state->result(); }
+
+ private:
+  Connection &m_connection;
+  ScanCommand m_cmd;
+  QSharedPointer<detail::AwaitState<QVariantList>> m_state;
+};
+
+inline CommandAwaiter exec(Connection &connection,
+                           const QList<QByteArray> &rawCmd, int db = -1,
+                           QObject *resumeContext = nullptr) {
+  return CommandAwaiter(connection, Command(rawCmd, db), resumeContext);
+}
+
+inline CommandAwaiter exec(Connection &connection, const Command &cmd,
+                           QObject *resumeContext = nullptr) {
+  return CommandAwaiter(connection, cmd, resumeContext);
+}
+
+/**
+ * @brief Awaitable pipeline. In transaction mode co_await returns array
+ * with results of all commands, otherwise result of the last command.
+ */
+inline CommandAwaiter pipeline(Connection &connection,
+                               const QList<QList<QByteArray>> &rawCmds,
+                               int db = -1, bool transaction = true,
+                               QObject *resumeContext = nullptr) {
+  Command cmd(QList<QByteArray>(), db);
+  cmd.setPipelineCommand(true, transaction);
+
+  for (const QList<QByteArray> &rawCmd : rawCmds) {
+    cmd.addToPipeline(rawCmd);
+  }
+
+  return CommandAwaiter(connection, cmd, resumeContext);
+}
+
+inline CollectionAwaiter scan(Connection &connection, const ScanCommand &cmd) {
+  return CollectionAwaiter(connection, cmd);
+}
+
+}  // namespace RedisClient
+
+#endif
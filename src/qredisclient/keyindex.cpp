@@ -0,0 +1,487 @@
+#include "keyindex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "keysnapshot.h"
+
+#define KEY_INDEX_COMPACT_THRESHOLD 4096
+
+namespace {
+
+int compareBytes(const char* a, int aSize, const char* b, int bSize) {
+  int result = memcmp(a, b, qMin(aSize, bSize));
+
+  if (result != 0) return result;
+
+  return aSize - bSize;
+}
+
+bool isGlobSpecial(char c) {
+  return c == '*' || c == '?' || c == '[' || c == '\\';
+}
+
+bool matchGlob(const char* p, int plen, const char* s, int slen) {
+  while (plen > 0 && slen > 0) {
+    switch (*p) {
+      case '*':
+        while (plen > 1 && p[1] == '*') {
+          p++;
+          plen--;
+        }
+
+        if (plen == 1) return true;
+
+        while (slen > 0) {
+          if (matchGlob(p + 1, plen - 1, s, slen)) return true;
+          s++;
+          slen--;
+        }
+        return false;
+      case '?':
+        s++;
+        slen--;
+        break;
+      case '[': {
+        p++;
+        plen--;
+
+        bool negate = plen > 0 && *p == '^';
+        bool match = false;
+
+        if (negate) {
+          p++;
+          plen--;
+        }
+
+        while (true) {
+          if (plen == 0) {
+            // Unterminated class, last char is handled as ']'
+            p--;
+            plen++;
+            break;
+          } else if (*p == '\\' && plen >= 2) {
+            p++;
+            plen--;
+            if (*p == *s) match = true;
+          } else if (*p == ']') {
+            break;
+          } else if (plen >= 3 && p[1] == '-') {
+            uchar start = static_cast<uchar>(p[0]);
+            uchar end = static_cast<uchar>(p[2]);
+            uchar c = static_cast<uchar>(*s);
+
+            if (start > end) std::swap(start, end);
+            if (c >= start && c <= end) match = true;
+
+            p += 2;
+            plen -= 2;
+          } else if (*p == *s) {
+            match = true;
+          }
+
+          p++;
+          plen--;
+        }
+
+        if (negate) match = !match;
+        if (!match) return false;
+
+        s++;
+        slen--;
+        break;
+      }
+      case '\\':
+        if (plen >= 2) {
+          p++;
+          plen--;
+        }
+        // fall through
+      default:
+        if (*p != *s) return false;
+        s++;
+        slen--;
+        break;
+    }
+
+    p++;
+    plen--;
+  }
+
+  while (plen > 0 && *p == '*') {
+    p++;
+    plen--;
+  }
+
+  return plen == 0 && slen == 0;
+}
+
+QByteArray literalPrefix(const QByteArray& pattern) {
+  int i = 0;
+
+  while (i < pattern.size() && !isGlobSpecial(pattern.at(i))) i++;
+
+  return pattern.left(i);
+}
+
+bool isRemovingEvent(const QByteArray& event) {
+  return event == "del" || event == "expired" || event == "evicted" ||
+         event == "rename_from" || event == "move_from";
+}
+
+}  // namespace
+
+RedisClient::KeyIndex::KeyIndex(const QByteArray& separator, int dbIndex)
+    : m_separator(separator.isEmpty() ? QByteArray(":") : separator),
+      m_dbIndex(dbIndex),
+      m_deadKeys(0),
+      m_mappedKeys(0) {}
+
+RedisClient::KeyIndex::KeyIndex(QSharedPointer<KeySnapshot> snapshot)
+    : m_separator(snapshot->separator()),
+      m_dbIndex(snapshot->dbIndex()),
+      m_keys(snapshot->keys()),
+      m_deadKeys(0),
+      m_mappedKeys(snapshot->size()),
+      m_snapshot(snapshot) {}
+
+void RedisClient::KeyIndex::addKey(const QByteArray& key) {
+  m_pending.append(m_keys.size());
+  m_keys.append(key);
+}
+
+void RedisClient::KeyIndex::addKeys(const QVariantList& keys) {
+  for (const QVariant& key : keys) addKey(key.toByteArray());
+}
+
+void RedisClient::KeyIndex::addKeys(const PackedKeyList& keys) {
+  for (int i = 0; i < keys.size(); ++i) {
+    m_pending.append(m_keys.size());
+    m_keys.append(keys.keyData(i), keys.keySize(i));
+  }
+}
+
+bool RedisClient::KeyIndex::removeKey(const QByteArray& key) {
+  mergePending();
+
+  int pos = lowerBound(key.constData(), key.size());
+
+  if (pos >= sortedSize() ||
+      compare(sortedAt(pos), key.constData(), key.size()) != 0)
+    return false;
+
+  materializeSorted();
+  m_sorted.remove(pos);
+  m_deadKeys++;
+
+  if (m_deadKeys > KEY_INDEX_COMPACT_THRESHOLD && m_deadKeys > m_sorted.size())
+    compact();
+
+  return true;
+}
+
+void RedisClient::KeyIndex::clear() {
+  m_keys.clear();
+  m_sorted.clear();
+  m_pending.clear();
+  m_deadKeys = 0;
+  m_mappedKeys = 0;
+  m_snapshot.clear();
+}
+
+bool RedisClient::KeyIndex::contains(const QByteArray& key) const {
+  mergePending();
+
+  int pos = lowerBound(key.constData(), key.size());
+
+  return pos < sortedSize() &&
+         compare(sortedAt(pos), key.constData(), key.size()) == 0;
+}
+
+int RedisClient::KeyIndex::size() const {
+  mergePending();
+  return sortedSize();
+}
+
+QByteArray RedisClient::KeyIndex::at(int i) const {
+  mergePending();
+  return m_keys.at(sortedAt(i));
+}
+
+QList<QByteArray> RedisClient::KeyIndex::prefixMatch(const QByteArray& prefix,
+                                                     int limit) const {
+  mergePending();
+
+  QList<QByteArray> result;
+  int end = prefixEnd(prefix);
+
+  for (int i = lowerBound(prefix.constData(), prefix.size());
+       i < end && result.size() != limit; ++i)
+    result.append(m_keys.at(sortedAt(i)));
+
+  return result;
+}
+
+QList<QByteArray> RedisClient::KeyIndex::globMatch(const QByteArray& pattern,
+                                                   int limit) const {
+  mergePending();
+
+  QList<QByteArray> result;
+  QByteArray prefix = literalPrefix(pattern);
+  int end = prefixEnd(prefix);
+
+  for (int i = lowerBound(prefix.constData(), prefix.size());
+       i < end && result.size() != limit; ++i) {
+    int index = sortedAt(i);
+
+    if (matchGlob(pattern, m_keys.keyData(index), m_keys.keySize(index)))
+      result.append(m_keys.at(index));
+  }
+
+  return result;
+}
+
+QList<QByteArray> RedisClient::KeyIndex::substringMatch(
+    const QByteArray& substring, int limit) const {
+  mergePending();
+
+  QList<QByteArray> result;
+
+  for (int i = 0; i < sortedSize() && result.size() != limit; ++i) {
+    QByteArray key = m_keys.rawAt(sortedAt(i));
+
+    if (key.contains(substring))
+      result.append(QByteArray(key.constData(), key.size()));
+  }
+
+  return result;
+}
+
+RedisClient::KeyIndex::NamespaceItems RedisClient::KeyIndex::namespaceItems(
+    const QByteArray& filter) const {
+  mergePending();
+
+  QByteArray nsFilter = filter.isEmpty() ? QByteArray("*") : filter;
+  QByteArray pattern = nsFilter + "*";
+  QByteArray prefix = literalPrefix(pattern);
+
+  // Same split as NamespaceAggregator
+  int lastSeparator = nsFilter.lastIndexOf(m_separator);
+  int prefixLength =
+      lastSeparator >= 0 ? lastSeparator + m_separator.size() : 0;
+
+  // Every key with literal prefix matches pattern, so keys of namespace are
+  // counted with binary search instead of iteration
+  bool literalFilter = true;
+
+  for (int i = prefix.size(); i < pattern.size(); ++i) {
+    if (pattern.at(i) != '*') literalFilter = false;
+  }
+
+  NamespaceAggregator::RootNamespaces namespaces;
+  NamespaceAggregator::RootKeys rootKeys;
+
+  int end = prefixEnd(prefix);
+
+  for (int i = lowerBound(prefix.constData(), prefix.size()); i < end;) {
+    int index = sortedAt(i);
+    QByteArray key = m_keys.rawAt(index);
+
+    if (!literalFilter && !matchGlob(pattern, key.constData(), key.size())) {
+      i++;
+      continue;
+    }
+
+    int nsEnd = key.indexOf(m_separator, prefixLength);
+
+    if (nsEnd < 0) {
+      rootKeys.append(m_keys.at(index));
+      i++;
+      continue;
+    }
+
+    QByteArray ns(key.constData(), nsEnd);
+
+    // Keys of namespace are contiguous in sorted order
+    if (literalFilter) {
+      int nsEndPos = prefixEnd(ns + m_separator);
+      namespaces.append({ns, static_cast<ulong>(nsEndPos - i)});
+      i = nsEndPos;
+    } else {
+      if (!namespaces.isEmpty() && namespaces.last().first == ns)
+        namespaces.last().second++;
+      else
+        namespaces.append({ns, 1});
+      i++;
+    }
+  }
+
+  // Order of namespace names may differ from order of keys: "a!b:x" < "a:x"
+  std::sort(namespaces.begin(), namespaces.end(),
+            [](const QPair<QByteArray, ulong>& a,
+               const QPair<QByteArray, ulong>& b) { return a.first < b.first; });
+
+  return NamespaceItems(namespaces, rootKeys);
+}
+
+ulong RedisClient::KeyIndex::namespaceKeysCount(const QByteArray& ns) const {
+  mergePending();
+
+  QByteArray prefix = ns + m_separator;
+
+  return static_cast<ulong>(prefixEnd(prefix) -
+                            lowerBound(prefix.constData(), prefix.size()));
+}
+
+QByteArray RedisClient::KeyIndex::keyspacePattern() const {
+  return QByteArray("__keyspace@") + QByteArray::number(m_dbIndex) + "__:*";
+}
+
+bool RedisClient::KeyIndex::applyKeyspaceNotification(
+    const QByteArray& channel, const QByteArray& message) {
+  static const QByteArray KEYSPACE_PREFIX("__keyspace@");
+  static const QByteArray KEYEVENT_PREFIX("__keyevent@");
+
+  bool keyspace = channel.startsWith(KEYSPACE_PREFIX);
+
+  if (!keyspace && !channel.startsWith(KEYEVENT_PREFIX)) return false;
+
+  int dbStart = KEYSPACE_PREFIX.size();
+  int dbEnd = channel.indexOf("__:", dbStart);
+
+  if (dbEnd < 0) return false;
+
+  bool ok = false;
+  int db = channel.mid(dbStart, dbEnd - dbStart).toInt(&ok);
+
+  if (!ok || db != m_dbIndex) return false;
+
+  QByteArray suffix = channel.mid(dbEnd + 3);
+  QByteArray key = keyspace ? suffix : message;
+  QByteArray event = keyspace ? message : suffix;
+
+  if (isRemovingEvent(event)) {
+    removeKey(key);
+  } else if (!contains(key)) {
+    // Any other event is emitted for existing key
+    addKey(key);
+  }
+
+  return true;
+}
+
+bool RedisClient::KeyIndex::applyKeyspaceNotification(
+    const QVariantList& message) {
+  if (message.size() < 3) return false;
+
+  return applyKeyspaceNotification(message.at(message.size() - 2).toByteArray(),
+                                   message.last().toByteArray());
+}
+
+qint64 RedisClient::KeyIndex::memoryUsage() const {
+  return m_keys.memoryUsage() +
+         (m_sorted.capacity() + m_pending.capacity()) * qint64(sizeof(int));
+}
+
+bool RedisClient::KeyIndex::matchGlob(const QByteArray& pattern,
+                                      const char* data, int size) {
+  return ::matchGlob(pattern.constData(), pattern.size(), data, size);
+}
+
+void RedisClient::KeyIndex::mergePending() const {
+  if (m_pending.isEmpty()) return;
+
+  auto less = [this](int a, int b) {
+    return compareBytes(m_keys.keyData(a), m_keys.keySize(a),
+                        m_keys.keyData(b), m_keys.keySize(b)) < 0;
+  };
+
+  std::sort(m_pending.begin(), m_pending.end(), less);
+
+  // Drop keys which are already indexed or added twice
+  QVector<int> added;
+  added.reserve(m_pending.size());
+
+  for (int index : m_pending) {
+    const char* data = m_keys.keyData(index);
+    int size = m_keys.keySize(index);
+
+    bool duplicate =
+        (!added.isEmpty() && compare(added.last(), data, size) == 0);
+
+    if (!duplicate) {
+      int pos = lowerBound(data, size);
+      duplicate =
+          pos < sortedSize() && compare(sortedAt(pos), data, size) == 0;
+    }
+
+    if (duplicate)
+      m_deadKeys++;
+    else
+      added.append(index);
+  }
+
+  m_pending.clear();
+
+  if (added.isEmpty()) return;
+
+  materializeSorted();
+
+  QVector<int> merged(m_sorted.size() + added.size());
+  std::merge(m_sorted.constBegin(), m_sorted.constEnd(), added.constBegin(),
+             added.constEnd(), merged.begin(), less);
+  m_sorted.swap(merged);
+}
+
+void RedisClient::KeyIndex::compact() {
+  mergePending();
+  materializeSorted();
+
+  PackedKeyList keys;
+  keys.reserve(m_sorted.size(), m_keys.bytes());
+
+  for (int i = 0; i < m_sorted.size(); ++i) {
+    int index = m_sorted.at(i);
+    keys.append(m_keys.keyData(index), m_keys.keySize(index));
+    m_sorted[i] = i;
+  }
+
+  keys.squeeze();
+  m_keys = keys;
+  m_deadKeys = 0;
+  m_snapshot.clear();
+}
+
+int RedisClient::KeyIndex::compare(int index, const char* data,
+                                   int size) const {
+  return compareBytes(m_keys.keyData(index), m_keys.keySize(index), data,
+                      size);
+}
+
+int RedisClient::KeyIndex::lowerBound(const char* data, int size) const {
+  return partitionPoint([this, data, size](int index) {
+    return compare(index, data, size) < 0;
+  });
+}
+
+int RedisClient::KeyIndex::prefixEnd(const QByteArray& prefix) const {
+  // Keys less than prefix and keys starting with it come first
+  return partitionPoint([this, &prefix](int index) {
+    int size = m_keys.keySize(index);
+
+    if (size >= prefix.size() &&
+        memcmp(m_keys.keyData(index), prefix.constData(), prefix.size()) == 0)
+      return true;
+
+    return compare(index, prefix.constData(), prefix.size()) < 0;
+  });
+}
+
+void RedisClient::KeyIndex::materializeSorted() const {
+  if (m_mappedKeys == 0) return;
+
+  m_sorted.resize(m_mappedKeys);
+  std::iota(m_sorted.begin(), m_sorted.end(), 0);
+  m_mappedKeys = 0;
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QSharedPointer>
+#include <QVariantList>
+#include <QVector>
+
+#include "namespaceaggregator.h"
+#include "packedkeylist.h"
+
+namespace RedisClient {
+
+class KeySnapshot;
+
+/**
+ * @brief The KeyIndex class
+ * Client-side index of keys loaded by SCAN. Keys are stored in PackedKeyList
+ * arena with array of arena indexes sorted by key bytes, so prefix queries
+ * and namespace counts are answered with binary search and glob/substring
+ * queries scan one contiguous block of memory.
+ *
+ * Added keys are buffered and merged into sorted array by the next query,
+ * so loading keys in SCAN batches doesn't re-sort whole index every round.
+ * Index can be kept up to date with keyspace notifications, see
+ * applyKeyspaceNotification().
+ *
+ * Not thread-safe: even const queries may merge buffered keys.
+ */
+class KeyIndex {
+ public:
+  typedef NamespaceAggregator::Items NamespaceItems;
+
+  explicit KeyIndex(const QByteArray& separator = QByteArray(":"),
+                    int dbIndex = 0);
+
+  /**
+   * @brief Index over keys of snapshot. Mapped keys are copied only when
+   * index is modified.
+   */
+  explicit KeyIndex(QSharedPointer<KeySnapshot> snapshot);
+
+  QByteArray separator() const { return m_separator; }
+  int dbIndex() const { return m_dbIndex; }
+
+  void addKey(const QByteArray& key);
+  void addKeys(const QVariantList& keys);
+  void addKeys(const PackedKeyList& keys);
+
+  /**
+   * @return false if key is not in index
+   */
+  bool removeKey(const QByteArray& key);
+
+  void clear();
+
+  bool contains(const QByteArray& key) const;
+  int size() const;
+  bool isEmpty() const { return size() == 0; }
+
+  /**
+   * @brief Key at position i in sorted order
+   */
+  QByteArray at(int i) const;
+
+  QList<QByteArray> prefixMatch(const QByteArray& prefix,
+                                int limit = -1) const;
+
+  /**
+   * @brief Keys matching redis glob-style pattern (same as SCAN MATCH).
+   * Only keys starting with literal prefix of pattern are checked.
+   */
+  QList<QByteArray> globMatch(const QByteArray& pattern,
+                              int limit = -1) const;
+
+  QList<QByteArray> substringMatch(const QByteArray& substring,
+                                   int limit = -1) const;
+
+  /**
+   * @brief Same result as Connection::getNamespaceItems() for given filter:
+   * namespaces of level below filter with key counts and root keys, both
+   * sorted by name
+   */
+  NamespaceItems namespaceItems(const QByteArray& filter = QByteArray("*")) const;
+
+  /**
+   * @brief Number of keys in namespace and all its child namespaces
+   */
+  ulong namespaceKeysCount(const QByteArray& ns) const;
+
+  /**
+   * @brief Pattern for PSUBSCRIBE to keyspace notifications of index db.
+   * Server should have K and event classes (e.g. KA) in
+   * notify-keyspace-events.
+   */
+  QByteArray keyspacePattern() const;
+
+  /**
+   * @brief Update index with keyspace (__keyspace@db__:key event) or
+   * keyevent (__keyevent@db__:event key) notification
+   * @return false if notification is not related to index db
+   */
+  bool applyKeyspaceNotification(const QByteArray& channel,
+                                 const QByteArray& message);
+
+  /**
+   * @brief Overload for pub/sub message: [p]message, [pattern,] channel,
+   * payload
+   */
+  bool applyKeyspaceNotification(const QVariantList& message);
+
+  /**
+   * @brief Approximate memory used by index
+   */
+  qint64 memoryUsage() const;
+
+  static bool matchGlob(const QByteArray& pattern, const char* data,
+                        int size);
+
+ private:
+  friend class KeySnapshot;
+
+  void mergePending() const;
+  void compact();
+
+  // Unmodified snapshot keys are sorted in arena order, so m_sorted is
+  // filled only when index is modified
+  void materializeSorted() const;
+  int sortedSize() const {
+    return m_mappedKeys > 0 ? m_mappedKeys : m_sorted.size();
+  }
+  int sortedAt(int i) const { return m_mappedKeys > 0 ? i : m_sorted.at(i); }
+
+  /**
+   * @brief First position in sorted order for which predicate of key index
+   * is false, keys for which it is true must come first
+   */
+  template <typename Predicate>
+  int partitionPoint(Predicate pred) const {
+    int first = 0;
+    int count = sortedSize();
+
+    while (count > 0) {
+      int step = count / 2;
+
+      if (pred(sortedAt(first + step))) {
+        first += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+
+    return first;
+  }
+
+  int compare(int index, const char* data, int size) const;
+  int lowerBound(const char* data, int size) const;
+  int prefixEnd(const QByteArray& prefix) const;
+
+ private:
+  QByteArray m_separator;
+  int m_dbIndex;
+
+  // Pending keys are merged lazily by queries
+  mutable PackedKeyList m_keys;
+  mutable QVector<int> m_sorted;   // live keys, indexes of m_keys
+  mutable QVector<int> m_pending;  // added keys, not sorted yet
+  mutable int m_deadKeys;          // removed or duplicate keys in arena
+  mutable int m_mappedKeys;        // sorted snapshot keys not in m_sorted
+
+  // Keeps mapped arena of m_keys alive
+  QSharedPointer<KeySnapshot> m_snapshot;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,37 @@
+#pragma once
+#include <QByteArray>
+#include <QFlags>
+#include <QList>
+
+namespace RedisClient {
+
+/**
+ * @brief The KeyMetadata struct
+ * Key attributes loaded by Connection::loadKeysMetadata().
+ * Only requested fields are loaded, others keep default values.
+ */
+struct KeyMetadata {
+  enum Field {
+    Type = 0x1,         // TYPE
+    Ttl = 0x2,          // PTTL
+    MemoryUsage = 0x4,  // MEMORY USAGE
+    Encoding = 0x8,     // OBJECT ENCODING
+    AllFields = Type | Ttl | MemoryUsage | Encoding
+  };
+  Q_DECLARE_FLAGS(Fields, Field)
+
+  KeyMetadata(const QByteArray &key = QByteArray())
+      : key(key), ttl(-1), memoryUsage(-1) {}
+
+  QByteArray key;
+  QByteArray type;     // "none" if key doesn't exist anymore
+  qint64 ttl;          // msec, -1 - no expiration, -2 - key is missing
+  qint64 memoryUsage;  // bytes, -1 - unavailable
+  QByteArray encoding;
+};
+
+typedef QList<KeyMetadata> KeyMetadataList;
+
+}  // namespace RedisClient
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RedisClient::KeyMetadata::Fields)
@@ -0,0 +1,275 @@
+#include "keysnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <cstring>
+#include <limits>
+
+#include "keyindex.h"
+
+#define KEY_SNAPSHOT_MAGIC "QRKS"
+#define KEY_SNAPSHOT_VERSION 1
+#define KEY_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+namespace {
+
+struct SnapshotHeader {
+  char magic[4];
+  quint32 version;
+  quint32 byteOrder;
+  qint32 dbIndex;
+  qint32 keys;
+  qint32 separatorSize;
+  qint64 createdAt;  // msecs since epoch
+  qint64 arenaBytes;
+};
+
+static_assert(sizeof(SnapshotHeader) == 40, "Unexpected header padding");
+
+qint64 align8(qint64 size) { return (size + 7) & ~qint64(7); }
+
+// Snapshot is saved to <name>.<version>.keys next to path, so file mapped by
+// opened snapshot is never replaced (rename over mapped file fails on Windows)
+QMap<qint64, QString> snapshotVersions(const QString& path) {
+  QFileInfo info(path);
+  QString prefix = info.completeBaseName() + ".";
+  QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+  QDir dir = info.absoluteDir();
+
+  QMap<qint64, QString> versions;
+
+  for (const QString& name :
+       dir.entryList(QStringList() << prefix + "*" + suffix, QDir::Files)) {
+    bool ok = false;
+    qint64 version =
+        name.mid(prefix.size(), name.size() - prefix.size() - suffix.size())
+            .toLongLong(&ok);
+
+    if (ok && version > 0) versions.insert(version, dir.filePath(name));
+  }
+
+  return versions;
+}
+
+class SaveTask : public QRunnable {
+ public:
+  SaveTask(const RedisClient::KeyIndex& index, const QString& path,
+           RedisClient::KeySnapshot::SaveCallback callback)
+      : m_index(index), m_path(path), m_callback(callback) {}
+
+  void run() override {
+    QString error;
+    bool saved = RedisClient::KeySnapshot::save(m_index, m_path, &error);
+
+    if (m_callback) m_callback(saved, error);
+  }
+
+ private:
+  RedisClient::KeyIndex m_index;
+  QString m_path;
+  RedisClient::KeySnapshot::SaveCallback m_callback;
+};
+
+// One thread, so two saves never pick the same version
+class SavePool : public QThreadPool {
+ public:
+  SavePool() { setMaxThreadCount(1); }
+};
+
+QThreadPool& savePool() {
+  static SavePool pool;
+  return pool;
+}
+
+}  // namespace
+
+RedisClient::KeySnapshot::KeySnapshot(const QString& path)
+    : m_file(path),
+      m_data(nullptr),
+      m_size(0),
+      m_dbIndex(0),
+      m_offsets(nullptr),
+      m_arena(nullptr) {}
+
+RedisClient::KeySnapshot::~KeySnapshot() {
+  if (m_data) m_file.unmap(m_data);
+}
+
+QString RedisClient::KeySnapshot::path(const ConnectionConfig& config,
+                                       int dbIndex) {
+  if (config.keySnapshotDir().isEmpty()) return QString();
+
+  // id() can be raw hash bytes
+  QByteArray id =
+      QCryptographicHash::hash(config.id(), QCryptographicHash::Sha1).toHex();
+
+  return QDir(config.keySnapshotDir())
+      .filePath(QString("%1-db%2.keys")
+                    .arg(QString::fromLatin1(id))
+                    .arg(dbIndex));
+}
+
+bool RedisClient::KeySnapshot::save(const KeyIndex& index,
+                                    const QString& path, QString* error) {
+  auto fail = [error](const QString& msg) {
+    if (error) *error = msg;
+    return false;
+  };
+
+  index.mergePending();
+
+  int count = index.sortedSize();
+  const PackedKeyList& keys = index.m_keys;
+
+  QVector<qint32> offsets(count + 1);
+  qint64 arenaBytes = 0;
+
+  for (int i = 0; i < count; ++i) {
+    offsets[i] = static_cast<qint32>(arenaBytes);
+    arenaBytes += keys.keySize(index.sortedAt(i));
+  }
+
+  // Offsets are qint32, same as in PackedKeyList
+  if (arenaBytes > std::numeric_limits<qint32>::max())
+    return fail("Key snapshot is larger than 2 GB");
+
+  offsets[count] = static_cast<qint32>(arenaBytes);
+
+  SnapshotHeader header;
+  memcpy(header.magic, KEY_SNAPSHOT_MAGIC, 4);
+  header.version = KEY_SNAPSHOT_VERSION;
+  header.byteOrder = KEY_SNAPSHOT_BYTE_ORDER;
+  header.dbIndex = index.m_dbIndex;
+  header.keys = count;
+  header.separatorSize = index.m_separator.size();
+  header.createdAt = QDateTime::currentMSecsSinceEpoch();
+  header.arenaBytes = arenaBytes;
+
+  QByteArray separator = index.m_separator;
+  separator.append(QByteArray(align8(separator.size()) - separator.size(), 0));
+
+  qint64 offsetsBytes = offsets.size() * qint64(sizeof(qint32));
+
+  QDir().mkpath(QFileInfo(path).absolutePath());
+
+  QMap<qint64, QString> versions = snapshotVersions(path);
+  qint64 version = versions.isEmpty() ? 1 : versions.lastKey() + 1;
+
+  QFileInfo info(path);
+  QString versionPath = info.absoluteDir().filePath(
+      QString("%1.%2%3")
+          .arg(info.completeBaseName())
+          .arg(version)
+          .arg(info.suffix().isEmpty() ? QString() : "." + info.suffix()));
+
+  QSaveFile file(versionPath);
+
+  if (!file.open(QIODevice::WriteOnly)) return fail(file.errorString());
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(separator);
+  file.write(reinterpret_cast<const char*>(offsets.constData()), offsetsBytes);
+  file.write(QByteArray(align8(offsetsBytes) - offsetsBytes, 0));
+
+  for (int i = 0; i < count; ++i) {
+    int key = index.sortedAt(i);
+    file.write(keys.keyData(key), keys.keySize(key));
+  }
+
+  if (!file.commit()) return fail(file.errorString());
+
+  // Older versions can still be mapped on Windows and fail to be removed,
+  // they are removed by the next save
+  for (const QString& old : versions) QFile::remove(old);
+
+  if (QFile::exists(path)) QFile::remove(path);
+
+  return true;
+}
+
+void RedisClient::KeySnapshot::saveInBackground(const KeyIndex& index,
+                                                const QString& path,
+                                                SaveCallback callback) {
+  // Copy shares keys with index until one of them is modified
+  savePool().start(new SaveTask(index, path, callback));
+}
+
+bool RedisClient::KeySnapshot::exists(const QString& path) {
+  return !snapshotVersions(path).isEmpty() || QFile::exists(path);
+}
+
+QSharedPointer<RedisClient::KeySnapshot> RedisClient::KeySnapshot::open(
+    const QString& path, QString* error) {
+  auto fail = [error](const QString& msg) {
+    if (error) *error = msg;
+    return QSharedPointer<KeySnapshot>();
+  };
+
+  QMap<qint64, QString> versions = snapshotVersions(path);
+
+  // Snapshot saved before versioning is read from path itself
+  QSharedPointer<KeySnapshot> snapshot(
+      new KeySnapshot(versions.isEmpty() ? path : versions.last()));
+  QFile& file = snapshot->m_file;
+
+  if (!file.open(QIODevice::ReadOnly)) return fail(file.errorString());
+
+  qint64 fileSize = file.size();
+
+  if (fileSize < qint64(sizeof(SnapshotHeader)))
+    return fail("Not a key snapshot");
+
+  snapshot->m_data = file.map(0, fileSize);
+
+  if (!snapshot->m_data) return fail(file.errorString());
+
+  SnapshotHeader header;
+  memcpy(&header, snapshot->m_data, sizeof(header));
+
+  if (memcmp(header.magic, KEY_SNAPSHOT_MAGIC, 4) != 0)
+    return fail("Not a key snapshot");
+
+  if (header.version != KEY_SNAPSHOT_VERSION ||
+      header.byteOrder != KEY_SNAPSHOT_BYTE_ORDER)
+    return fail("Unsupported key snapshot version");
+
+  if (header.keys < 0 || header.separatorSize < 0 ||
+      header.separatorSize > 1024 || header.arenaBytes < 0 ||
+      header.arenaBytes > std::numeric_limits<qint32>::max())
+    return fail("Corrupted key snapshot");
+
+  qint64 separatorAt = sizeof(SnapshotHeader);
+  qint64 offsetsAt = separatorAt + align8(header.separatorSize);
+  qint64 offsetsBytes = (qint64(header.keys) + 1) * sizeof(qint32);
+  qint64 arenaAt = offsetsAt + align8(offsetsBytes);
+
+  if (arenaAt + header.arenaBytes != fileSize)
+    return fail("Corrupted key snapshot");
+
+  const char* data = reinterpret_cast<const char*>(snapshot->m_data);
+  const qint32* offsets = reinterpret_cast<const qint32*>(data + offsetsAt);
+
+  // Only bounds of offset table are checked, so reopen doesn't touch
+  // pages of whole table. File is written by save() with QSaveFile and is
+  // complete once it has expected size.
+  if (offsets[0] != 0 || offsets[header.keys] != header.arenaBytes)
+    return fail("Corrupted key snapshot");
+
+  snapshot->m_size = header.keys;
+  snapshot->m_dbIndex = header.dbIndex;
+  snapshot->m_separator = QByteArray(data + separatorAt, header.separatorSize);
+  snapshot->m_createdAt = QDateTime::fromMSecsSinceEpoch(header.createdAt);
+  snapshot->m_offsets = offsets;
+  snapshot->m_arena = data + arenaAt;
+
+  return snapshot;
+}
+
+RedisClient::PackedKeyList RedisClient::KeySnapshot::keys() const {
+  return PackedKeyList::fromRawData(m_arena, m_offsets, m_size);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+#include <functional>
+
+#include "connectionconfig.h"
+#include "packedkeylist.h"
+
+namespace RedisClient {
+
+class KeyIndex;
+
+/**
+ * @brief The KeySnapshot class
+ * Sorted keys of KeyIndex saved to file, which is memory-mapped on open:
+ * keys are read from the page cache only when they are accessed, so index
+ * of millions of keys is reopened without re-scanning the server.
+ * Namespace tree is not stored: it is answered by KeyIndex from sorted keys.
+ *
+ * File is written in native byte order and is not portable between
+ * platforms: header, offsets of keys (qint32), key bytes.
+ */
+class KeySnapshot {
+ public:
+  typedef std::function<void(bool saved, const QString& error)> SaveCallback;
+
+  ~KeySnapshot();
+
+  /**
+   * @brief Snapshot file of connection db in
+   * ConnectionConfig::keySnapshotDir(), empty if snapshots are disabled
+   */
+  static QString path(const ConnectionConfig& config, int dbIndex);
+
+  /**
+   * @brief Save keys of index to new version of snapshot file and remove
+   * older versions. Snapshots opened before save keep their mapped file.
+   * Fails if keys take more than 2 GB.
+   */
+  static bool save(const KeyIndex& index, const QString& path,
+                   QString* error = nullptr);
+
+  /**
+   * @brief save() copy of index in background thread, so writing snapshot
+   * of millions of keys doesn't block caller. Snapshots are saved one at a
+   * time, callback is called in background thread.
+   */
+  static void saveInBackground(const KeyIndex& index, const QString& path,
+                               SaveCallback callback = SaveCallback());
+
+  /**
+   * @brief Whether any version of snapshot file exists
+   */
+  static bool exists(const QString& path);
+
+  /**
+   * @brief Open latest version of snapshot file
+   * @return null if file doesn't exist or is not valid snapshot
+   */
+  static QSharedPointer<KeySnapshot> open(const QString& path,
+                                          QString* error = nullptr);
+
+  int size() const { return m_size; }
+  int dbIndex() const { return m_dbIndex; }
+  QByteArray separator() const { return m_separator; }
+  QDateTime createdAt() const { return m_createdAt; }
+
+  /**
+   * @brief Keys and offsets over mapped file without copying, valid while
+   * snapshot exists
+   */
+  PackedKeyList keys() const;
+
+ private:
+  KeySnapshot(const QString& path);
+
+ private:
+  QFile m_file;
+  uchar* m_data;
+  int m_size;
+  int m_dbIndex;
+  QByteArray m_separator;
+  QDateTime m_createdAt;
+  const qint32* m_offsets;
+  const char* m_arena;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,84 @@
+#include "logging.h"
+
+#include "response.h"
+#include "utils/text.h"
+
+#define COMMAND_LOG_LIMIT 200
+
+RedisClient::LogRecord::LogRecord()
+    : level(LogLevel::Info), event(Event::Message), commandId(0) {}
+
+RedisClient::LogRecord::LogRecord(RedisClient::LogLevel level,
+                                  RedisClient::LogRecord::Event event,
+                                  quint64 commandId, const QVariantList &args)
+    : level(level), event(event), commandId(commandId), args(args) {}
+
+QString RedisClient::LogRecord::toString() const {
+  auto arg = [this](int i) { return args.value(i).toString(); };
+
+  switch (event) {
+    case Event::Message:
+      return arg(0);
+    case Event::Connected:
+      return QString("%1 > connected").arg(connectionName);
+    case Event::ConnectionFailed:
+      return QString("%1 > connection failed").arg(connectionName);
+    case Event::CommandSent:
+      return QString("%1 > [runCommand] %2")
+          .arg(connectionName)
+          .arg(printableString(command.join(' ').left(COMMAND_LOG_LIMIT)));
+    case Event::ResponseReceived: {
+      QString result;
+      int type = args.value(0).toInt();
+
+      if (type == Response::Type::Status || type == Response::Type::Error) {
+        result = args.value(1).toByteArray();
+      } else if (type == Response::Type::String) {
+        result = QString("Bulk");
+      } else if (type == Response::Type::Array) {
+        result = QString("Array");
+      }
+
+      return QString("%1 > Response received : %2")
+          .arg(connectionName)
+          .arg(result);
+    }
+    case Event::CommandCanceled:
+      return QString("Command was canceled.");
+    case Event::SubscriptionCanceled:
+      return QString("Subscription was canceled.");
+    case Event::RunningCommandsRequeued:
+      return QString("Running commands were re-added to queue.");
+    case Event::RunningCommandsCanceled:
+      return QString("Cancel running commands");
+    case Event::ClusterNodePicked:
+      return QString("Cluster node picked for next command: %1:%2")
+          .arg(arg(0))
+          .arg(arg(1));
+    case Event::ClusterRedirect:
+      return QString("Cluster redirect to  %1:%2").arg(arg(0)).arg(arg(1));
+    case Event::Reconnect:
+      return QString("Reconnect to %1:%2").arg(arg(0)).arg(arg(1));
+  }
+
+  return QString();
+}
+
+QString RedisClient::LogRecord::levelName(RedisClient::LogLevel level) {
+  switch (level) {
+    case LogLevel::Off:
+      return QString("off");
+    case LogLevel::Error:
+      return QString("error");
+    case LogLevel::Warning:
+      return QString("warning");
+    case LogLevel::Info:
+      return QString("info");
+    case LogLevel::Debug:
+      return QString("debug");
+    case LogLevel::Trace:
+      return QString("trace");
+  }
+
+  return QString();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVariantList>
+
+namespace RedisClient {
+
+/**
+ * @brief Log levels. Records with level above Connection::logLevel() are
+ * not created at all.
+ */
+enum class LogLevel { Off = 0, Error, Warning, Info, Debug, Trace };
+
+/**
+ * @brief The LogRecord struct
+ * Structured log record. Records are created by transporter thread with raw
+ * arguments only, text is formatted by consumer with toString().
+ */
+struct LogRecord {
+  enum class Event {
+    Message,           // args: text
+    Connected,
+    ConnectionFailed,
+    CommandSent,       // command
+    ResponseReceived,  // args: Response::Type, status/error text
+    CommandCanceled,
+    SubscriptionCanceled,
+    RunningCommandsRequeued,
+    RunningCommandsCanceled,
+    ClusterNodePicked,  // args: host, port
+    ClusterRedirect,    // args: host, port
+    Reconnect           // args: host, port
+  };
+
+  LogRecord();
+  LogRecord(LogLevel level, Event event, quint64 commandId = 0,
+            const QVariantList &args = QVariantList());
+
+  LogLevel level;
+  Event event;
+  quint64 commandId;  // sequence number of command in transporter, 0 if none
+  QByteArray connectionId;
+  QString connectionName;
+  QList<QByteArray> command;
+  QVariantList args;
+
+  /**
+   * @brief Human readable representation of the record
+   * @return
+   */
+  QString toString() const;
+
+  static QString levelName(LogLevel level);
+};
+
+}  // namespace RedisClient
+
+Q_DECLARE_METATYPE(RedisClient::LogRecord)
@@ -0,0 +1,86 @@
+#include "namespaceaggregator.h"
+
+#include <algorithm>
+
+namespace {
+
+void sortByName(RedisClient::NamespaceAggregator::RootNamespaces& items) {
+  std::sort(items.begin(), items.end(),
+            [](const QPair<QByteArray, ulong>& a,
+               const QPair<QByteArray, ulong>& b) { return a.first < b.first; });
+}
+
+}  // namespace
+
+RedisClient::NamespaceAggregator::NamespaceAggregator(
+    const QByteArray& separator, const QByteArray& filter)
+    : m_separator(separator.isEmpty() ? QByteArray(":") : separator),
+      m_filter(filter.isEmpty() ? QByteArray("*") : filter),
+      m_prefixLength(0) {
+  // Local part of key starts after last separator of filter
+  int lastSeparator = m_filter.lastIndexOf(m_separator);
+
+  if (lastSeparator >= 0) m_prefixLength = lastSeparator + m_separator.size();
+}
+
+QByteArray RedisClient::NamespaceAggregator::matchPattern() const {
+  return m_filter + "*";
+}
+
+void RedisClient::NamespaceAggregator::addKey(const QByteArray& key) {
+  int nsEnd = key.indexOf(m_separator, m_prefixLength);
+
+  if (nsEnd < 0) {
+    if (m_rootKeys.contains(key)) return;
+
+    m_rootKeys.insert(key);
+    m_newRootKeys.append(key);
+    return;
+  }
+
+  QByteArray ns = key.left(nsEnd);
+  ++m_namespaces[ns];
+  m_changedNamespaces.insert(ns);
+}
+
+void RedisClient::NamespaceAggregator::addKeys(const QVariantList& keys) {
+  for (const QVariant& key : keys) addKey(key.toByteArray());
+}
+
+RedisClient::NamespaceAggregator::Items
+RedisClient::NamespaceAggregator::items() const {
+  RootNamespaces namespaces;
+  namespaces.reserve(m_namespaces.size());
+
+  for (auto i = m_namespaces.constBegin(); i != m_namespaces.constEnd(); ++i)
+    namespaces.append({i.key(), i.value()});
+
+  sortByName(namespaces);
+
+  RootKeys keys = m_rootKeys.values();
+  std::sort(keys.begin(), keys.end());
+
+  return Items(namespaces, keys);
+}
+
+RedisClient::NamespaceAggregator::Items
+RedisClient::NamespaceAggregator::takeChanges() {
+  RootNamespaces namespaces;
+  namespaces.reserve(m_changedNamespaces.size());
+
+  for (const QByteArray& ns : m_changedNamespaces)
+    namespaces.append({ns, m_namespaces.value(ns)});
+
+  sortByName(namespaces);
+
+  Items changes(namespaces, m_newRootKeys);
+
+  m_changedNamespaces.clear();
+  m_newRootKeys.clear();
+
+  return changes;
+}
+
+bool RedisClient::NamespaceAggregator::hasChanges() const {
+  return !m_changedNamespaces.isEmpty() || !m_newRootKeys.isEmpty();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QVariantList>
+
+namespace RedisClient {
+
+/**
+ * @brief The NamespaceAggregator class
+ * Client-side version of lua/namespace_scan.lua: splits keys returned by
+ * SCAN MATCH <filter>* into root namespaces (with key counts) and root keys
+ * of the level below filter. Keys can be added in batches, changes since
+ * last takeChanges() are tracked, so partial results can be delivered
+ * while scan is in progress.
+ */
+class NamespaceAggregator {
+ public:
+  typedef QList<QPair<QByteArray, ulong>> RootNamespaces;
+  typedef QList<QByteArray> RootKeys;
+  typedef QPair<RootNamespaces, RootKeys> Items;
+
+  NamespaceAggregator(const QByteArray& separator, const QByteArray& filter);
+
+  /**
+   * @brief Pattern for SCAN MATCH
+   */
+  QByteArray matchPattern() const;
+
+  void addKey(const QByteArray& key);
+  void addKeys(const QVariantList& keys);
+
+  /**
+   * @brief All namespaces and root keys sorted by name
+   */
+  Items items() const;
+
+  /**
+   * @brief Namespaces with changed counts (current total count is
+   * returned) and root keys added since previous call
+   */
+  Items takeChanges();
+
+  bool hasChanges() const;
+
+  int namespacesCount() const { return m_namespaces.size(); }
+  int rootKeysCount() const { return m_rootKeys.size(); }
+
+ private:
+  QByteArray m_separator;
+  QByteArray m_filter;
+  int m_prefixLength;
+
+  QHash<QByteArray, ulong> m_namespaces;
+  QSet<QByteArray> m_rootKeys;
+
+  QSet<QByteArray> m_changedNamespaces;
+  RootKeys m_newRootKeys;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,128 @@
+#include "packedkeylist.h"
+
+#include <cstring>
+
+#include "command.h"
+
+static_assert(sizeof(int) == sizeof(qint32), "Offsets are shared with files");
+
+RedisClient::PackedKeyList::PackedKeyList(bool withSlots)
+    : m_withSlots(withSlots),
+      m_offsets{0},
+      m_rawOffsets(nullptr),
+      m_rawSize(0) {}
+
+void RedisClient::PackedKeyList::reserve(int keys, int bytes) {
+  detachRawOffsets();
+
+  m_arena.reserve(bytes);
+  m_offsets.reserve(keys + 1);
+
+  if (m_withSlots) m_slots.reserve(keys);
+}
+
+void RedisClient::PackedKeyList::squeeze() {
+  m_arena.squeeze();
+  m_offsets.squeeze();
+  m_slots.squeeze();
+}
+
+void RedisClient::PackedKeyList::clear() {
+  m_rawOffsets = nullptr;
+  m_rawSize = 0;
+  m_arena.clear();
+  m_offsets.resize(1);
+  m_offsets[0] = 0;
+  m_slots.clear();
+}
+
+void RedisClient::PackedKeyList::append(const char* key, int size) {
+  detachRawOffsets();
+
+  m_arena.append(key, size);
+  m_offsets.append(m_arena.size());
+
+  if (m_withSlots) {
+    m_slots.append(
+        Command::calcKeyHashSlot(QByteArray::fromRawData(key, size)));
+  }
+}
+
+void RedisClient::PackedKeyList::append(const QVariantList& keys) {
+  // Containers grow geometrically, exact reserve() per batch would copy
+  // arena on every append
+  for (const QVariant& key : keys) append(key.toByteArray());
+}
+
+void RedisClient::PackedKeyList::append(const PackedKeyList& other) {
+  detachRawOffsets();
+
+  for (int i = 0; i < other.size(); ++i) {
+    if (m_withSlots && other.m_withSlots) {
+      m_arena.append(other.keyData(i), other.keySize(i));
+      m_offsets.append(m_arena.size());
+      m_slots.append(other.slot(i));
+    } else {
+      append(other.keyData(i), other.keySize(i));
+    }
+  }
+}
+
+QByteArray RedisClient::PackedKeyList::at(int i) const {
+  return QByteArray(keyData(i), keySize(i));
+}
+
+QByteArray RedisClient::PackedKeyList::rawAt(int i) const {
+  return QByteArray::fromRawData(keyData(i), keySize(i));
+}
+
+qint64 RedisClient::PackedKeyList::memoryUsage() const {
+  return sizeof(PackedKeyList) + m_arena.capacity() +
+         m_offsets.capacity() * qint64(sizeof(int)) +
+         m_slots.capacity() * qint64(sizeof(quint16));
+}
+
+QList<QByteArray> RedisClient::PackedKeyList::toList() const {
+  QList<QByteArray> result;
+  result.reserve(size());
+
+  for (int i = 0; i < size(); ++i) result.append(at(i));
+
+  return result;
+}
+
+RedisClient::PackedKeyList RedisClient::PackedKeyList::fromList(
+    const QList<QByteArray>& keys, bool withSlots) {
+  PackedKeyList result(withSlots);
+  int bytes = 0;
+
+  for (const QByteArray& key : keys) bytes += key.size();
+
+  result.reserve(keys.size(), bytes);
+
+  for (const QByteArray& key : keys) result.append(key);
+
+  return result;
+}
+
+RedisClient::PackedKeyList RedisClient::PackedKeyList::fromRawData(
+    const char* arena, const qint32* offsets, int size) {
+  PackedKeyList result;
+
+  result.m_arena = QByteArray::fromRawData(arena, offsets[size]);
+  result.m_offsets.clear();
+  result.m_rawOffsets = offsets;
+  result.m_rawSize = size;
+
+  return result;
+}
+
+void RedisClient::PackedKeyList::detachRawOffsets() {
+  if (!m_rawOffsets) return;
+
+  m_offsets.resize(m_rawSize + 1);
+  memcpy(m_offsets.data(), m_rawOffsets, (m_rawSize + 1) * sizeof(qint32));
+
+  m_rawOffsets = nullptr;
+  m_rawSize = 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QVariantList>
+#include <QVector>
+
+namespace RedisClient {
+
+/**
+ * @brief The PackedKeyList class
+ * Append-only list of keys stored in one contiguous byte arena with offset
+ * array: one allocation for all key bytes instead of QByteArray per key.
+ * Optionally keeps cluster hash slot of every key calculated on append.
+ * Arena is limited by QByteArray size (2GB).
+ *
+ * Implicitly shared, like Qt containers.
+ */
+class PackedKeyList {
+ public:
+  explicit PackedKeyList(bool withSlots = false);
+
+  void reserve(int keys, int bytes);
+  void squeeze();
+  void clear();
+
+  void append(const char* key, int size);
+  void append(const QByteArray& key) { append(key.constData(), key.size()); }
+  void append(const QVariantList& keys);
+  void append(const PackedKeyList& other);
+
+  int size() const {
+    return m_rawOffsets ? m_rawSize : m_offsets.size() - 1;
+  }
+  bool isEmpty() const { return size() == 0; }
+
+  /**
+   * @brief Deep copy of key
+   */
+  QByteArray at(int i) const;
+
+  /**
+   * @brief Key without copying. Data is valid while list is not modified.
+   */
+  QByteArray rawAt(int i) const;
+
+  const char* keyData(int i) const { return m_arena.constData() + offset(i); }
+  int keySize(int i) const { return offset(i + 1) - offset(i); }
+
+  bool hasSlots() const { return m_withSlots; }
+  quint16 slot(int i) const { return m_slots.at(i); }
+
+  /**
+   * @brief Size of key bytes
+   */
+  int bytes() const { return m_arena.size(); }
+
+  /**
+   * @brief Approximate memory used by list
+   */
+  qint64 memoryUsage() const;
+
+  QList<QByteArray> toList() const;
+  static PackedKeyList fromList(const QList<QByteArray>& keys,
+                                bool withSlots = false);
+
+  /**
+   * @brief List over external arena and offsets (e.g. memory-mapped file),
+   * which are not copied until list is modified. Both must outlive the list
+   * and its copies.
+   * @param offsets - size + 1 items, first is 0
+   */
+  static PackedKeyList fromRawData(const char* arena, const qint32* offsets,
+                                   int size);
+
+ private:
+  int offset(int i) const {
+    return m_rawOffsets ? m_rawOffsets[i] : m_offsets.at(i);
+  }
+
+  void detachRawOffsets();
+
+ private:
+  bool m_withSlots;
+  QByteArray m_arena;
+  QVector<int> m_offsets;  // size() + 1 items, key i is [i, i + 1)
+  QVector<quint16> m_slots;
+
+  // External offsets of fromRawData(), m_offsets is empty while set
+  const qint32* m_rawOffsets;
+  int m_rawSize;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,40 @@
+#include "responsebatch.h"
+
+void RedisClient::ResponseBatch::add(const RedisClient::ResponseEmitter &emitter,
+                                     const RedisClient::Response &r,
+                                     const QString &err,
+                                     const RedisClient::DeliveryStamp &stamp) {
+  QThread *ownerThread = emitter.m_ownerThread;
+
+  if (emitter.m_guard.isNull() || !ownerThread) return;
+
+  if (emitter.m_inline || ownerThread == QThread::currentThread()) {
+    ResponseEmitter::invoke(emitter.m_callback, r, err, emitter.m_stats, stamp);
+    return;
+  }
+
+  m_pending[ownerThread].append(Delivery{emitter.m_guard, emitter.m_callback,
+                                         r, err, emitter.m_stats, stamp});
+}
+
+void RedisClient::ResponseBatch::flush() {
+  if (m_pending.isEmpty()) return;
+
+  for (auto i = m_pending.constBegin(); i != m_pending.constEnd(); ++i) {
+    QVector<Delivery> deliveries = i.value();
+
+    ResponseEmitter::post(i.key(), [deliveries]() {
+      for (const Delivery &d : deliveries) {
+        if (d.owner.isNull()) continue;
+
+        ResponseEmitter::invoke(d.callback, d.response, d.error, d.stats,
+                                d.stamp);
+      }
+    });
+  }
+
+  m_pending.clear();
+}
+
+bool RedisClient::ResponseBatch::isEmpty() const { return m_pending.isEmpty(); }
+
@@ -0,0 +1,42 @@
+#pragma once
+#include <QHash>
+#include <QPointer>
+#include <QThread>
+#include <QVector>
+#include "qredisclient/command.h"
+#include "qredisclient/response.h"
+#include "responseemmiter.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The ResponseBatch class
+ * Collects responses for owners living in other threads and delivers
+ * them with one posted call per owner thread. Callbacks are invoked in the
+ * order responses were added. Owners from the current thread and inline
+ * emitters are called directly.
+ * THIS IS IMPLEMENTATION CLASS AND SHOULDN'T BE USED DIRECTLY.
+ */
+class ResponseBatch {
+ public:
+  void add(const ResponseEmitter &emitter, const Response &r,
+           const QString &err,
+           const DeliveryStamp &stamp = DeliveryStamp());
+  void flush();
+  bool isEmpty() const;
+
+ private:
+  struct Delivery {
+    QPointer<QObject> owner;
+    Command::Callback callback;
+    Response response;
+    QString error;
+    QSharedPointer<CommandStats> stats;
+    DeliveryStamp stamp;
+  };
+
+ private:
+  QHash<QThread *, QVector<Delivery>> m_pending;
+};
+
+}  // namespace RedisClient
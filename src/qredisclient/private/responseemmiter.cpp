@@ -0,0 +1,135 @@
+#include "responseemmiter.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadStorage>
+
+namespace {
+
+const QEvent::Type DELIVERY_EVENT =
+    static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class DeliveryEvent : public QEvent {
+ public:
+  explicit DeliveryEvent(const std::function<void()> &call)
+      : QEvent(DELIVERY_EVENT), call(call) {}
+
+  std::function<void()> call;
+};
+
+// Receives posted deliveries in owner thread
+class DeliveryContext : public QObject {
+ public:
+  bool event(QEvent *e) override {
+    if (e->type() != DELIVERY_EVENT) return QObject::event(e);
+
+    static_cast<DeliveryEvent *>(e)->call();
+    return true;
+  }
+};
+
+// Context of owner thread used by one posting thread. Lock is taken only by
+// this posting thread and by owner thread when it finishes.
+struct ContextEntry {
+  ContextEntry() : context(nullptr) {}
+
+  QMutex lock;
+  DeliveryContext *context;
+  QMetaObject::Connection finished;
+  QMetaObject::Connection destroyed;
+};
+
+void releaseEntry(const QSharedPointer<ContextEntry> &entry, bool later) {
+  QMutexLocker l(&entry->lock);
+
+  if (!entry->context) return;
+
+  if (later)
+    entry->context->deleteLater();
+  else
+    delete entry->context;
+
+  entry->context = nullptr;
+}
+
+// Contexts of owner threads, one table per posting thread, so delivery
+// doesn't take a process-wide lock
+class DeliveryContexts {
+ public:
+  ~DeliveryContexts() {
+    for (auto entry : m_entries) {
+      QObject::disconnect(entry->finished);
+      QObject::disconnect(entry->destroyed);
+
+      // Owner thread can be running
+      releaseEntry(entry, true);
+    }
+  }
+
+  void post(QThread *thread, const std::function<void()> &call) {
+    QSharedPointer<ContextEntry> entry = m_entries.value(thread);
+
+    // Thread finished or was destroyed and its address was reused
+    if (entry.isNull() || !postTo(entry, call)) {
+      entry = createEntry(thread);
+      postTo(entry, call);
+    }
+  }
+
+ private:
+  bool postTo(const QSharedPointer<ContextEntry> &entry,
+              const std::function<void()> &call) {
+    QMutexLocker l(&entry->lock);
+
+    if (!entry->context) return false;
+
+    QCoreApplication::postEvent(entry->context, new DeliveryEvent(call));
+    return true;
+  }
+
+  QSharedPointer<ContextEntry> createEntry(QThread *thread) {
+    QSharedPointer<ContextEntry> old = m_entries.take(thread);
+
+    if (old) {
+      QObject::disconnect(old->finished);
+      QObject::disconnect(old->destroyed);
+    }
+
+    QSharedPointer<ContextEntry> entry(new ContextEntry());
+    entry->context = new DeliveryContext();
+    entry->context->moveToThread(thread);
+
+    // Both are called directly: context is deleted in owner thread when it
+    // finishes, or with thread which was never started
+    QWeakPointer<ContextEntry> weak = entry;
+    entry->finished = QObject::connect(thread, &QThread::finished, [weak]() {
+      if (auto e = weak.toStrongRef()) releaseEntry(e, false);
+    });
+    entry->destroyed = QObject::connect(thread, &QObject::destroyed, [weak]() {
+      if (auto e = weak.toStrongRef()) releaseEntry(e, false);
+    });
+
+    m_entries.insert(thread, entry);
+    return entry;
+  }
+
+ private:
+  QHash<QThread *, QSharedPointer<ContextEntry>> m_entries;
+};
+
+QThreadStorage<DeliveryContexts *> deliveryContexts;
+
+}  // namespace
+
+void RedisClient::ResponseEmitter::post(QThread *thread,
+                                        const std::function<void()> &call) {
+  if (!thread) return;
+
+  if (!deliveryContexts.hasLocalData())
+    deliveryContexts.setLocalData(new DeliveryContexts());
+
+  deliveryContexts.localData()->post(thread, call);
+}
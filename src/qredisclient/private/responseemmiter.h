@@ -1,28 +1,128 @@
+#pragma once
 #include <QObject>
+#include <QPointer>
+#include <functional>
 #include "qredisclient/command.h"
 #include "qredisclient/response.h"
+#include "qredisclient/stats.h"
+#include "qredisclient/tracer.h"
 
 namespace RedisClient {
 
+/**
+ * @brief The DeliveryStamp struct
+ * Information about parsed response used to measure delivery latency.
+ * Tracer is set only if tracing is enabled.
+ * THIS IS IMPLEMENTATION CLASS AND SHOULDN'T BE USED DIRECTLY.
+ */
+struct DeliveryStamp {
+  DeliveryStamp() : parsedAt(0), commandId(0) {}
+
+  qint64 parsedAt;
+  quint64 commandId;
+  QByteArray name;
+  QSharedPointer<Tracer> tracer;
+};
+
 /**
  * @brief The ResponseEmitter class
- * Class used to send responses to callers.
+ * Lightweight value type used to send responses to callers.
+ * Responses are delivered with Qt::AutoConnection semantics: directly if
+ * owner lives in the current thread, as posted call to owner thread otherwise.
+ * Inline emitters call callback directly in the current thread.
+ * Nothing is delivered if owner was destroyed.
+ * If command statistics are attached, time between response parsing and
+ * callback invocation is recorded as delivery latency, callback execution is
+ * traced if delivery stamp contains tracer.
  * THIS IS IMPLEMENTATION CLASS AND SHOULDN'T BE USED DIRECTLY.
  */
-class ResponseEmitter : public QObject {
-  Q_OBJECT
+class ResponseEmitter {
  public:
-  ResponseEmitter(QObject *owner, Command::Callback callback) : owner(owner) {
-    QObject::connect(this, &ResponseEmitter::response, owner, callback,
-                     Qt::AutoConnection);
+  ResponseEmitter()
+      : owner(nullptr), m_ownerThread(nullptr), m_inline(false) {}
+
+  /**
+   * @brief Should be called in owner thread
+   */
+  ResponseEmitter(
+      QObject *owner, Command::Callback callback, bool inlineCallback = false,
+      QSharedPointer<CommandStats> stats = QSharedPointer<CommandStats>())
+      : ResponseEmitter(QPointer<QObject>(owner),
+                        owner ? owner->thread() : nullptr, callback,
+                        inlineCallback, stats) {}
+
+  ResponseEmitter(
+      QPointer<QObject> guard, QThread *ownerThread, Command::Callback callback,
+      bool inlineCallback = false,
+      QSharedPointer<CommandStats> stats = QSharedPointer<CommandStats>())
+      : owner(guard.data()),
+        m_guard(guard),
+        m_ownerThread(ownerThread),
+        m_callback(callback),
+        m_inline(inlineCallback),
+        m_stats(stats) {}
+
+  bool isValid() const { return owner && m_callback; }
+
+  bool isInline() const { return m_inline; }
+
+  QThread *ownerThread() const { return m_ownerThread; }
+
+  void sendResponse(const Response &r, const QString &err,
+                    const DeliveryStamp &stamp = DeliveryStamp()) const {
+    if (m_inline || m_ownerThread == QThread::currentThread()) {
+      if (!m_guard.isNull()) invoke(m_callback, r, err, m_stats, stamp);
+      return;
+    }
+
+    if (!m_ownerThread) return;
+
+    QPointer<QObject> guard = m_guard;
+    Command::Callback callback = m_callback;
+    QSharedPointer<CommandStats> stats = m_stats;
+    post(m_ownerThread, [guard, callback, r, err, stats, stamp]() {
+      // Owner can be destroyed only in this thread
+      if (guard.isNull()) return;
+
+      invoke(callback, r, err, stats, stamp);
+    });
   }
 
-  void sendResponse(const Response &r, const QString &err) {
-    emit response(r, err);
+  /**
+   * @brief Call function in event loop of given thread. Calls are posted
+   * to per-thread context object, not to owner, so posting is safe while
+   * owner is being destroyed. Nothing is called once thread has finished.
+   */
+  static void post(QThread *thread, const std::function<void()> &call);
+
+  static void invoke(const Command::Callback &callback, const Response &r,
+                     const QString &err,
+                     const QSharedPointer<CommandStats> &stats,
+                     const DeliveryStamp &stamp) {
+    if (stamp.parsedAt <= 0) return callback(r, err);
+
+    qint64 startedAt = ConnectionStats::now();
+
+    if (stats) stats->delivery.record(startedAt - stamp.parsedAt);
+
+    callback(r, err);
+
+    if (stamp.tracer)
+      stamp.tracer->addCallback(stamp.commandId, stamp.name, stamp.parsedAt,
+                                startedAt, ConnectionStats::now());
   }
+
+  // Identity of owner, must not be dereferenced outside of owner thread
   QObject *owner;
- signals:
-  void response(Response, QString);
+
+ private:
+  friend class ResponseBatch;
+
+  QPointer<QObject> m_guard;
+  QThread *m_ownerThread;
+  Command::Callback m_callback;
+  bool m_inline;
+  QSharedPointer<CommandStats> m_stats;
 };
 
 }  // namespace RedisClient
@@ -0,0 +1,125 @@
+#include "runningcommand.h"
+
+#include <new>
+
+RedisClient::RunningCommand::RunningCommand(
+    const RedisClient::Command& cmd,
+    QSharedPointer<RedisClient::CommandStats> stats)
+    : cmd(cmd),
+      stats(stats),
+      sentAt(ConnectionStats::now()),
+      parseTime(0),
+      id(0),
+      writtenAt(0),
+      firstByteAt(0),
+      next(nullptr) {
+  auto callback = cmd.getCallBack();
+  auto owner = cmd.getOwner();
+  if (callback && owner) {
+    emitter = ResponseEmitter(cmd.getOwnerGuard(), cmd.getOwnerThread(),
+                              callback, cmd.hasInlineCallback(), stats);
+  }
+}
+
+RedisClient::RunningCommandQueue::RunningCommandQueue()
+    : m_head(nullptr), m_tail(nullptr), m_freeList(nullptr), m_size(0) {}
+
+RedisClient::RunningCommandQueue::~RunningCommandQueue() {
+  clear();
+
+  for (Slot* slab : m_slabs) {
+    delete[] slab;
+  }
+}
+
+RedisClient::RunningCommand& RedisClient::RunningCommandQueue::enqueue(
+    const RedisClient::Command& cmd,
+    QSharedPointer<RedisClient::CommandStats> stats) {
+  RunningCommand* c = allocate(cmd, stats);
+
+  if (m_tail)
+    m_tail->next = c;
+  else
+    m_head = c;
+
+  m_tail = c;
+  ++m_size;
+  return *c;
+}
+
+RedisClient::RunningCommand RedisClient::RunningCommandQueue::dequeue() {
+  Q_ASSERT(m_head);
+
+  RunningCommand* c = m_head;
+  m_head = c->next;
+
+  if (!m_head) m_tail = nullptr;
+
+  RunningCommand result(std::move(*c));
+  result.next = nullptr;
+
+  release(c);
+  return result;
+}
+
+RedisClient::RunningCommand& RedisClient::RunningCommandQueue::first() {
+  Q_ASSERT(m_head);
+  return *m_head;
+}
+
+const RedisClient::RunningCommand& RedisClient::RunningCommandQueue::first()
+    const {
+  Q_ASSERT(m_head);
+  return *m_head;
+}
+
+RedisClient::RunningCommand& RedisClient::RunningCommandQueue::last() {
+  Q_ASSERT(m_tail);
+  return *m_tail;
+}
+
+int RedisClient::RunningCommandQueue::size() const { return m_size; }
+
+bool RedisClient::RunningCommandQueue::isEmpty() const { return m_size == 0; }
+
+void RedisClient::RunningCommandQueue::clear() {
+  RunningCommand* curr = m_head;
+
+  while (curr) {
+    RunningCommand* next = curr->next;
+    release(curr);
+    curr = next;
+  }
+
+  m_head = m_tail = nullptr;
+}
+
+RedisClient::RunningCommand* RedisClient::RunningCommandQueue::allocate(
+    const RedisClient::Command& cmd,
+    const QSharedPointer<RedisClient::CommandStats>& stats) {
+  if (!m_freeList) {
+    Slot* slab = new Slot[SLAB_SIZE];
+
+    for (int i = 0; i < SLAB_SIZE - 1; ++i) {
+      slab[i].nextFree = &slab[i + 1];
+    }
+    slab[SLAB_SIZE - 1].nextFree = nullptr;
+
+    m_slabs.append(slab);
+    m_freeList = slab;
+  }
+
+  Slot* slot = m_freeList;
+  m_freeList = slot->nextFree;
+
+  return new (&slot->storage) RunningCommand(cmd, stats);
+}
+
+void RedisClient::RunningCommandQueue::release(RedisClient::RunningCommand* c) {
+  c->~RunningCommand();
+
+  Slot* slot = reinterpret_cast<Slot*>(c);
+  slot->nextFree = m_freeList;
+  m_freeList = slot;
+  --m_size;
+}
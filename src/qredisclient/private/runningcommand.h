@@ -0,0 +1,138 @@
+#pragma once
+#include <QVector>
+#include <QtGlobal>
+#include <type_traits>
+#include "qredisclient/command.h"
+#include "qredisclient/stats.h"
+#include "responseemmiter.h"
+
+namespace RedisClient {
+
+class RunningCommandQueue;
+
+/**
+ * @brief The RunningCommand struct
+ * Completion record of the command sent to redis-server.
+ * THIS IS IMPLEMENTATION CLASS AND SHOULDN'T BE USED DIRECTLY.
+ */
+struct RunningCommand {
+  RunningCommand(
+      const Command& cmd,
+      QSharedPointer<CommandStats> stats = QSharedPointer<CommandStats>());
+
+  Command cmd;
+  ResponseEmitter emitter;
+  QSharedPointer<CommandStats> stats;
+  qint64 sentAt;      // ConnectionStats::now()
+  qint64 parseTime;   // accumulated for all responses of pipeline
+  quint64 id;
+
+  // Set only if tracing is enabled or command has timing
+  qint64 writtenAt;
+  qint64 firstByteAt;
+
+ private:
+  friend class RunningCommandQueue;
+  RunningCommand* next;
+};
+
+/**
+ * @brief The RunningCommandQueue class
+ * FIFO of running commands. Records are linked intrusively and allocated
+ * from slabs which are reused after dequeue, so steady-state enqueue/dequeue
+ * doesn't touch the heap.
+ * THIS IS IMPLEMENTATION CLASS AND SHOULDN'T BE USED DIRECTLY.
+ */
+class RunningCommandQueue {
+ public:
+  class const_iterator {
+   public:
+    const_iterator(const RunningCommand* c) : m_current(c) {}
+
+    const RunningCommand& operator*() const { return *m_current; }
+    const RunningCommand* operator->() const { return m_current; }
+
+    const_iterator& operator++() {
+      m_current = m_current->next;
+      return *this;
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return m_current != other.m_current;
+    }
+
+   private:
+    const RunningCommand* m_current;
+  };
+
+ public:
+  RunningCommandQueue();
+  ~RunningCommandQueue();
+
+  RunningCommand& enqueue(
+      const Command& cmd,
+      QSharedPointer<CommandStats> stats = QSharedPointer<CommandStats>());
+  RunningCommand dequeue();
+
+  RunningCommand& first();
+  const RunningCommand& first() const;
+  RunningCommand& last();
+
+  int size() const;
+  bool isEmpty() const;
+  void clear();
+
+  template <typename Predicate>
+  int removeIf(Predicate shouldRemove) {
+    int removed = 0;
+    RunningCommand* prev = nullptr;
+    RunningCommand* curr = m_head;
+
+    while (curr) {
+      RunningCommand* next = curr->next;
+
+      if (shouldRemove(static_cast<const RunningCommand&>(*curr))) {
+        if (prev)
+          prev->next = next;
+        else
+          m_head = next;
+
+        if (curr == m_tail) m_tail = prev;
+
+        release(curr);
+        ++removed;
+      } else {
+        prev = curr;
+      }
+      curr = next;
+    }
+    return removed;
+  }
+
+  const_iterator begin() const { return const_iterator(m_head); }
+  const_iterator end() const { return const_iterator(nullptr); }
+
+ private:
+  union Slot {
+    Slot* nextFree;
+    std::aligned_storage<sizeof(RunningCommand),
+                         alignof(RunningCommand)>::type storage;
+  };
+
+  static const int SLAB_SIZE = 64;
+
+  RunningCommand* allocate(const Command& cmd,
+                           const QSharedPointer<CommandStats>& stats);
+  void release(RunningCommand* c);
+
+ private:
+  Q_DISABLE_COPY(RunningCommandQueue)
+
+  RunningCommand* m_head;
+  RunningCommand* m_tail;
+  Slot* m_freeList;
+  int m_size;
+  QVector<Slot*> m_slabs;
+};
+
+}  // namespace RedisClient
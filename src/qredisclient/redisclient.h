@@ -3,6 +3,7 @@
 #include "command.h"
 #include "connection.h"
 #include "connectionconfig.h"
+#include "logging.h"
 #include "response.h"
 #include <QObject>
 #include <QVector>
@@ -16,6 +17,7 @@ inline void initRedisClient()
     qRegisterMetaType<QList<RedisClient::Command>>("QList<RedisClient::Command>");
     qRegisterMetaType<RedisClient::Response>("Response");
     qRegisterMetaType<RedisClient::Response>("RedisClient::Response");
+    qRegisterMetaType<RedisClient::LogRecord>("RedisClient::LogRecord");
     qRegisterMetaType<QVector<QVariant*>>("QVector<QVariant*>");
     qRegisterMetaType<QVariant*>("QVariant*");    
 }
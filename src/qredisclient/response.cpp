@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QVariantList>
 #include <QVector>
+#include "qredisclient/responseformatter.h"
 #include "qredisclient/utils/compat.h"
 #include "qredisclient/utils/text.h"
 
@@ -96,42 +97,13 @@ QByteArray RedisClient::Response::getChannel() const {
 
 QString RedisClient::Response::valueToHumanReadString(const QVariant& value,
                                                       int indentLevel) {
-  QString result;
-  QString indent = QString(" ").repeated(indentLevel);
+  QByteArray result;
 
-  if (value.isNull()) {
-    result.append(QString("null"));
-  } else if (value.type() == QVariant::Bool) {
-    result.append(QString(value.toBool() ? "true" : "false"));
-  } else if (value.type() == QVariant::List ||
-             value.canConvert(QVariant::List)) {
-    QVariantList list = value.value<QVariantList>();
+  ResponseFormatter formatter(
+      [&result](const QByteArray& chunk) { result.append(chunk); });
+  formatter.format(value, indentLevel);
 
-    int index = 1;
-    int whitespaceSize = QString::number(list.size()).size() + 2;
-
-    for (QVariant item : list) {
-      QString indexStr = QString("%1)").arg(QString::number(index++));
-
-      if (indexStr.size() < whitespaceSize)
-        indexStr.append(
-            QString(" ").repeated(whitespaceSize - indexStr.size()));
-
-      QString val = valueToHumanReadString(item, indentLevel + whitespaceSize);
-
-      if (item.canConvert(QVariant::List)) {
-        val = val.mid(indent.size() + indexStr.size());
-      }
-
-      QString line = QString("%1%2%3\r\n").arg(indent).arg(indexStr).arg(val);
-
-      result.append(line);
-    }
-  } else {
-    result.append(QString("\"%1\"").arg(printableString(value.toByteArray())));
-  }
-
-  return result;
+  return QString::fromUtf8(result);
 }
 
 bool RedisClient::Response::isErrorMessage() const {
@@ -163,6 +135,10 @@ bool RedisClient::Response::isWrongPasswordError() const
     return isErrorMessage() && m_result.toByteArray().startsWith("WRONGPASS");
 }
 
+bool RedisClient::Response::isNoScriptError() const {
+  return isErrorMessage() && m_result.toByteArray().startsWith("NOSCRIPT");
+}
+
 bool RedisClient::Response::isOkMessage() const {
   return m_type == Type::Status && m_result.toByteArray().startsWith("OK");
 }
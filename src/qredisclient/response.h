@@ -34,6 +34,7 @@ class Response {
   bool isDisabledCommandErrorMessage() const;
   bool isPermissionError() const;
   bool isWrongPasswordError() const;
+  bool isNoScriptError() const;
   bool isOkMessage() const;
   bool isQueuedMessage() const;
   bool isValid();
@@ -54,6 +55,10 @@ class Response {
   QByteArray getRedirectionHost() const;
   uint getRedirectionPort() const;
 
+  /**
+   * @brief Builds whole output in memory, use ResponseFormatter for big
+   * values
+   */
   static QString valueToHumanReadString(const QVariant &, int indentLevel = 0);
 
  protected:
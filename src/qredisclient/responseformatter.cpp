@@ -0,0 +1,130 @@
+#include "responseformatter.h"
+
+#include "utils/text.h"
+
+RedisClient::ResponseFormatter::ResponseFormatter(QIODevice* device,
+                                                  qint64 maxItems)
+    : m_device(device),
+      m_maxItems(maxItems),
+      m_items(0),
+      m_truncated(false),
+      m_failed(false),
+      m_atLineStart(true) {
+  m_buffer.reserve(bufferSize);
+}
+
+RedisClient::ResponseFormatter::ResponseFormatter(Writer writer,
+                                                  qint64 maxItems)
+    : m_device(nullptr),
+      m_writer(writer),
+      m_maxItems(maxItems),
+      m_items(0),
+      m_truncated(false),
+      m_failed(false),
+      m_atLineStart(true) {
+  m_buffer.reserve(bufferSize);
+}
+
+RedisClient::ResponseFormatter::~ResponseFormatter() { flush(); }
+
+bool RedisClient::ResponseFormatter::format(const QVariant& value,
+                                            int indentLevel) {
+  if (isList(value))
+    formatList(value, indentLevel, false);
+  else
+    formatScalar(value);
+
+  flush();
+  return !m_failed;
+}
+
+void RedisClient::ResponseFormatter::flush() {
+  if (m_buffer.isEmpty()) return;
+
+  if (m_device) {
+    if (m_device->write(m_buffer) != m_buffer.size()) m_failed = true;
+  } else if (m_writer) {
+    m_writer(m_buffer);
+  }
+
+  m_buffer.resize(0);
+}
+
+bool RedisClient::ResponseFormatter::isList(const QVariant& value) {
+  return value.type() == QVariant::List || value.canConvert(QVariant::List);
+}
+
+bool RedisClient::ResponseFormatter::formatList(const QVariant& value,
+                                                int indentLevel,
+                                                bool skipIndent) {
+  const QVariantList list = value.value<QVariantList>();
+  const int whitespaceSize = QByteArray::number(list.size()).size() + 2;
+  int index = 1;
+
+  for (const QVariant& item : list) {
+    if (m_failed) return false;
+
+    if (m_maxItems > 0 && m_items >= m_maxItems) {
+      if (!m_atLineStart) write("\r\n", 2);
+
+      write(QString("(output truncated after %1 items)\r\n")
+                .arg(m_maxItems)
+                .toUtf8());
+      m_truncated = true;
+      return false;
+    }
+
+    ++m_items;
+
+    // Nested list starts on the line of parent index
+    if (!skipIndent || index > 1) writeSpaces(indentLevel);
+
+    QByteArray indexStr = QByteArray::number(index++);
+    indexStr.append(')');
+    write(indexStr);
+    writeSpaces(whitespaceSize - indexStr.size());
+
+    if (isList(item)) {
+      if (!formatList(item, indentLevel + whitespaceSize, true)) return false;
+    } else {
+      formatScalar(item);
+    }
+
+    write("\r\n", 2);
+  }
+
+  return true;
+}
+
+void RedisClient::ResponseFormatter::formatScalar(const QVariant& value) {
+  if (value.isNull()) {
+    write("null", 4);
+  } else if (value.type() == QVariant::Bool) {
+    if (value.toBool())
+      write("true", 4);
+    else
+      write("false", 5);
+  } else {
+    write("\"", 1);
+    write(printableString(value.toByteArray()).toUtf8());
+    write("\"", 1);
+  }
+}
+
+void RedisClient::ResponseFormatter::write(const char* data, int size) {
+  if (size <= 0) return;
+
+  m_buffer.append(data, size);
+  m_atLineStart = data[size - 1] == '\n';
+
+  if (m_buffer.size() >= bufferSize) flush();
+}
+
+void RedisClient::ResponseFormatter::writeSpaces(int count) {
+  static const char spaces[] = "                                ";
+  const int chunk = sizeof(spaces) - 1;
+
+  for (; count > chunk; count -= chunk) write(spaces, chunk);
+
+  write(spaces, count);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QByteArray>
+#include <QIODevice>
+#include <QVariant>
+#include <functional>
+
+namespace RedisClient {
+
+/**
+ * @brief The ResponseFormatter class
+ * Streams redis-cli like representation of response value (same bytes as
+ * Response::valueToHumanReadString() in UTF-8) to QIODevice or callback.
+ * Output is written in chunks of bufferSize bytes, so huge replies are
+ * formatted in bounded memory.
+ *
+ * If maxItems > 0 output stops after given number of array items
+ * (nested items included) and truncation notice is written.
+ */
+class ResponseFormatter {
+ public:
+  typedef std::function<void(const QByteArray&)> Writer;
+
+  static const int bufferSize = 64 * 1024;
+
+  explicit ResponseFormatter(QIODevice* device, qint64 maxItems = 0);
+  explicit ResponseFormatter(Writer writer, qint64 maxItems = 0);
+
+  ~ResponseFormatter();
+
+  /**
+   * @brief Format value and flush output
+   * @return false if output device failed
+   */
+  bool format(const QVariant& value, int indentLevel = 0);
+
+  void flush();
+
+  qint64 formattedItems() const { return m_items; }
+  bool isTruncated() const { return m_truncated; }
+
+ private:
+  static bool isList(const QVariant& value);
+
+  bool formatList(const QVariant& value, int indentLevel, bool skipIndent);
+  void formatScalar(const QVariant& value);
+
+  void write(const char* data, int size);
+  void write(const QByteArray& data) { write(data.constData(), data.size()); }
+  void writeSpaces(int count);
+
+ private:
+  QIODevice* m_device;
+  Writer m_writer;
+  qint64 m_maxItems;
+  qint64 m_items;
+  bool m_truncated;
+  bool m_failed;
+  bool m_atLineStart;
+  QByteArray m_buffer;
+};
+
+}  // namespace RedisClient
@@ -13,6 +13,48 @@ void RedisClient::ScanCommand::setCursor(long long cursor)
     }
 }
 
+void RedisClient::ScanCommand::setCount(long count)
+{
+    if (count <= 0)
+        return;
+
+    int index = countIndex();
+
+    if (index < 0) {
+        m_commandWithArguments.append("COUNT");
+        m_commandWithArguments.append(QByteArray::number(qint64(count)));
+    } else {
+        m_commandWithArguments[index + 1] = QByteArray::number(qint64(count));
+    }
+}
+
+long RedisClient::ScanCommand::count() const
+{
+    int index = countIndex();
+
+    return index < 0 ? 0 : m_commandWithArguments[index + 1].toLong();
+}
+
+int RedisClient::ScanCommand::countIndex() const
+{
+    // Options start after cursor
+    int first = isKeyScanCommand(m_commandWithArguments.value(0)) ? 2 : 3;
+
+    for (int i = first; i + 1 < m_commandWithArguments.size(); i += 2) {
+        if (m_commandWithArguments[i].toUpper() == "COUNT")
+            return i;
+    }
+
+    return -1;
+}
+
+int RedisClient::ScanCommand::itemSize() const
+{
+    QByteArray cmd = m_commandWithArguments.value(0).toLower();
+
+    return cmd == "hscan" || cmd == "zscan" ? 2 : 1;
+}
+
 bool RedisClient::ScanCommand::isValidScanCommand() const
 {
     auto parts = getSplitedRepresentattion();
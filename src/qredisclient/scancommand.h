@@ -7,16 +7,44 @@ namespace RedisClient {
 class ScanCommand : public Command
 {
 public:
-    ScanCommand(const QList<QByteArray>& cmd, int db) : Command(cmd, db) {}
-    ScanCommand(const QList<QByteArray>& cmd) : Command(cmd) {}    
+    ScanCommand(const QList<QByteArray>& cmd, int db)
+        : Command(cmd, db), m_uniqueResults(false) {}
+    ScanCommand(const QList<QByteArray>& cmd)
+        : Command(cmd), m_uniqueResults(false) {}
 
     void setCursor(long long cursor);
 
+    /**
+     * @brief Set COUNT option, option is added if command doesn't have it
+     */
+    void setCount(long count);
+
+    /**
+     * @brief Value of COUNT option, 0 if command doesn't have it
+     */
+    long count() const;
+
+    /**
+     * @brief Remove elements returned more than once (e.g. during rehashing)
+     * from results of Connection::retrieveCollection(), see ScanDedupSet
+     */
+    void setUniqueResults(bool unique) { m_uniqueResults = unique; }
+    bool uniqueResults() const { return m_uniqueResults; }
+
+    /**
+     * @brief Number of response elements per item: 2 for HSCAN and ZSCAN
+     */
+    int itemSize() const;
+
     bool isValidScanCommand() const;
 
 private:
     bool isKeyScanCommand(const QString& cmd) const;
     bool isValueScanCommand(const QString& cmd) const;
+    int countIndex() const;
+
+private:
+    bool m_uniqueResults;
 };
 
 }
@@ -0,0 +1,43 @@
+#include "scancountcontroller.h"
+
+#include <QtGlobal>
+
+constexpr double RedisClient::ScanCountController::SMOOTHING;
+
+RedisClient::ScanCountController::ScanCountController(qint64 targetLatency,
+                                                      long initialCount,
+                                                      long minCount,
+                                                      long maxCount)
+    : m_targetLatency(qMax(targetLatency, qint64(1))),
+      m_minCount(qMax(minCount, 1L)),
+      m_maxCount(qMax(maxCount, m_minCount)),
+      m_count(qBound(m_minCount, initialCount, m_maxCount)),
+      m_maxItemsPerRound(0),
+      m_costPerCount(0),
+      m_itemsPerCount(0),
+      m_hasSamples(false) {}
+
+long RedisClient::ScanCountController::update(qint64 rtt, int items) {
+  double cost = qMax(rtt, qint64(1)) / double(m_count);
+  double density = qMax(items, 0) / double(m_count);
+
+  if (m_hasSamples) {
+    m_costPerCount += SMOOTHING * (cost - m_costPerCount);
+    m_itemsPerCount += SMOOTHING * (density - m_itemsPerCount);
+  } else {
+    m_costPerCount = cost;
+    m_itemsPerCount = density;
+    m_hasSamples = true;
+  }
+
+  double next = m_targetLatency / m_costPerCount;
+
+  if (m_maxItemsPerRound > 0 && m_itemsPerCount > 0)
+    next = qMin(next, m_maxItemsPerRound / m_itemsPerCount);
+
+  // Avoid oscillation on noisy measurements
+  next = qBound(m_count / 2.0, next, m_count * 2.0);
+
+  m_count = qBound(m_minCount, static_cast<long>(qRound64(next)), m_maxCount);
+  return m_count;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <QtGlobal>
+
+namespace RedisClient {
+
+/**
+ * @brief The ScanCountController class
+ * Adjusts COUNT of SCAN-like commands between rounds to keep round-trip
+ * time of a round near target latency. Server-side cost of a round is
+ * proportional to COUNT, so cost per COUNT unit is estimated from measured
+ * rounds (EWMA) and next COUNT is target / cost. Selective MATCH patterns
+ * (cheap rounds) get bigger COUNT, loaded servers get smaller one.
+ *
+ * COUNT changes at most twice per round and stays in [minCount, maxCount].
+ * If maxItemsPerRound > 0, COUNT is also limited by observed density of
+ * returned items to bound memory used by single reply.
+ */
+class ScanCountController {
+ public:
+  static const long DEFAULT_MIN_COUNT = 10;
+  static const long DEFAULT_MAX_COUNT = 1000000;
+
+  /**
+   * @param targetLatency - usec per round
+   * @param initialCount - COUNT of first round
+   */
+  ScanCountController(qint64 targetLatency, long initialCount,
+                      long minCount = DEFAULT_MIN_COUNT,
+                      long maxCount = DEFAULT_MAX_COUNT);
+
+  void setMaxItemsPerRound(int items) { m_maxItemsPerRound = items; }
+
+  qint64 targetLatency() const { return m_targetLatency; }
+  long count() const { return m_count; }
+
+  /**
+   * @brief Account finished round which used count()
+   * @param rtt - usec
+   * @param items - number of returned items
+   * @return COUNT for next round
+   */
+  long update(qint64 rtt, int items);
+
+ private:
+  static constexpr double SMOOTHING = 0.3;
+
+  qint64 m_targetLatency;
+  long m_minCount;
+  long m_maxCount;
+  long m_count;
+  int m_maxItemsPerRound;
+  double m_costPerCount;  // usec
+  double m_itemsPerCount;
+  bool m_hasSamples;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,144 @@
+#include "scandedupset.h"
+
+#include <cstring>
+
+#define SCAN_DEDUP_INITIAL_CAPACITY 1024
+
+namespace {
+
+inline quint64 mix(quint64 h) {
+  // Finalizer of MurmurHash3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+}  // namespace
+
+RedisClient::ScanDedupSet::ScanDedupSet() { clear(); }
+
+quint64 RedisClient::ScanDedupSet::fingerprint(const char* data, int size) {
+  quint64 h = 0x9e3779b97f4a7c15ULL ^ static_cast<quint64>(size);
+  int i = 0;
+
+  for (; i + 8 <= size; i += 8) {
+    quint64 word;
+    memcpy(&word, data + i, 8);
+    h = (h ^ mix(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  if (i < size) {
+    quint64 word = 0;
+    memcpy(&word, data + i, size - i);
+    h = (h ^ mix(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  h = mix(h);
+
+  // 0 marks empty slot
+  return h ? h : 1;
+}
+
+bool RedisClient::ScanDedupSet::insert(const char* data, int size) {
+  quint64 fp = fingerprint(data, size);
+  int slot = find(fp, data, size);
+
+  if (m_fingerprints.at(slot) != 0) return false;
+
+  m_fingerprints[slot] = fp;
+  m_indexes[slot] = m_elements.size();
+  m_elements.append(data, size);
+
+  // Keep load factor below 3/4
+  if (m_elements.size() * 4 > m_fingerprints.size() * 3) grow();
+
+  return true;
+}
+
+bool RedisClient::ScanDedupSet::contains(const QByteArray& value) const {
+  quint64 fp = fingerprint(value.constData(), value.size());
+
+  return m_fingerprints.at(find(fp, value.constData(), value.size())) != 0;
+}
+
+int RedisClient::ScanDedupSet::filter(QVariantList& collection, int stride) {
+  if (stride < 1) stride = 1;
+
+  int removed = 0;
+  int out = 0;
+
+  for (int i = 0; i + stride <= collection.size(); i += stride) {
+    if (!insert(collection.at(i).toByteArray())) {
+      removed++;
+      continue;
+    }
+
+    for (int j = 0; j < stride; ++j) {
+      if (out != i + j) collection[out] = collection.at(i + j);
+      out++;
+    }
+  }
+
+  collection.erase(collection.begin() + out, collection.end());
+
+  return removed;
+}
+
+qint64 RedisClient::ScanDedupSet::memoryUsage() const {
+  return m_fingerprints.capacity() * sizeof(quint64) +
+         m_indexes.capacity() * sizeof(int) + m_elements.memoryUsage();
+}
+
+void RedisClient::ScanDedupSet::clear() {
+  m_fingerprints = QVector<quint64>(SCAN_DEDUP_INITIAL_CAPACITY, 0);
+  m_indexes = QVector<int>(SCAN_DEDUP_INITIAL_CAPACITY, -1);
+  m_elements.clear();
+}
+
+int RedisClient::ScanDedupSet::find(quint64 fp, const char* data,
+                                    int size) const {
+  int mask = m_fingerprints.size() - 1;
+  int slot = static_cast<int>(fp & mask);
+
+  // Linear probing, stops on empty slot or verified match
+  while (m_fingerprints.at(slot) != 0) {
+    if (m_fingerprints.at(slot) == fp) {
+      int index = m_indexes.at(slot);
+
+      if (m_elements.keySize(index) == size &&
+          memcmp(m_elements.keyData(index), data, size) == 0)
+        return slot;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+void RedisClient::ScanDedupSet::grow() {
+  int capacity = m_fingerprints.size() * 2;
+  int mask = capacity - 1;
+
+  QVector<quint64> fingerprints(capacity, 0);
+  QVector<int> indexes(capacity, -1);
+
+  for (int i = 0; i < m_fingerprints.size(); ++i) {
+    quint64 fp = m_fingerprints.at(i);
+
+    if (fp == 0) continue;
+
+    int slot = static_cast<int>(fp & mask);
+
+    while (fingerprints.at(slot) != 0) slot = (slot + 1) & mask;
+
+    fingerprints[slot] = fp;
+    indexes[slot] = m_indexes.at(i);
+  }
+
+  m_fingerprints.swap(fingerprints);
+  m_indexes.swap(indexes);
+}
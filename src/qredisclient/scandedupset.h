@@ -0,0 +1,66 @@
+#pragma once
+#include <QByteArray>
+#include <QVariantList>
+#include <QVector>
+
+#include "packedkeylist.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The ScanDedupSet class
+ * Set of elements returned by SCAN family commands. Hash table keeps only
+ * 64-bit fingerprints with index of element in PackedKeyList arena, element
+ * bytes are compared only when fingerprints are equal. Uses much less memory
+ * than QSet<QByteArray>: no node and QByteArray header per element.
+ *
+ * SCAN may return same element more than once if keyspace is rehashed
+ * between rounds, see filter().
+ */
+class ScanDedupSet {
+ public:
+  ScanDedupSet();
+
+  /**
+   * @brief Add element
+   * @return false if element is already in set
+   */
+  bool insert(const char* data, int size);
+  bool insert(const QByteArray& value) {
+    return insert(value.constData(), value.size());
+  }
+
+  bool contains(const QByteArray& value) const;
+
+  /**
+   * @brief Remove elements which were seen in previous calls
+   * @param collection - result of SCAN round
+   * @param stride - 2 for HSCAN/ZSCAN: field/member is followed by
+   * value/score which is removed together with it
+   * @return number of removed duplicates
+   */
+  int filter(QVariantList& collection, int stride = 1);
+
+  int size() const { return m_elements.size(); }
+  bool isEmpty() const { return size() == 0; }
+
+  /**
+   * @brief Approximate memory used by set
+   */
+  qint64 memoryUsage() const;
+
+  void clear();
+
+  static quint64 fingerprint(const char* data, int size);
+
+ private:
+  int find(quint64 fp, const char* data, int size) const;
+  void grow();
+
+ private:
+  QVector<quint64> m_fingerprints;  // 0 - empty slot
+  QVector<int> m_indexes;           // index of element in m_elements
+  PackedKeyList m_elements;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,77 @@
+#include "scanhandle.h"
+
+#include <QMutexLocker>
+
+RedisClient::ScanHandle::ScanHandle()
+    : m_state(State::Running),
+      m_cursor(0),
+      m_items(0),
+      m_rounds(0),
+      m_duplicates(0) {}
+
+void RedisClient::ScanHandle::cancel() {
+  Continuation next;
+
+  {
+    QMutexLocker lock(&m_lock);
+
+    if (m_state == State::Finished || m_state == State::Canceled) return;
+
+    m_state = State::Canceled;
+    next.swap(m_next);
+  }
+
+  // Paused scan has no round in flight, continuation delivers final callback
+  if (next) next(sharedFromThis());
+}
+
+void RedisClient::ScanHandle::pause() {
+  QMutexLocker lock(&m_lock);
+
+  if (m_state == State::Running) m_state = State::Paused;
+}
+
+void RedisClient::ScanHandle::resume() {
+  Continuation next;
+
+  {
+    QMutexLocker lock(&m_lock);
+
+    if (m_state != State::Paused) return;
+
+    m_state = State::Running;
+    next.swap(m_next);
+  }
+
+  if (next) next(sharedFromThis());
+}
+
+RedisClient::ScanHandle::State RedisClient::ScanHandle::state() const {
+  QMutexLocker lock(&m_lock);
+  return m_state;
+}
+
+RedisClient::ScanHandle::State RedisClient::ScanHandle::continueOrSuspend(
+    Continuation next) {
+  QMutexLocker lock(&m_lock);
+
+  if (m_state == State::Paused) m_next = next;
+
+  return m_state;
+}
+
+void RedisClient::ScanHandle::addRound(long long cursor, int items,
+                                       int duplicates) {
+  m_cursor.storeRelease(cursor);
+  m_items.fetchAndAddOrdered(items);
+  m_rounds.fetchAndAddOrdered(1);
+  m_duplicates.fetchAndAddOrdered(duplicates);
+}
+
+void RedisClient::ScanHandle::finish() {
+  QMutexLocker lock(&m_lock);
+
+  if (m_state != State::Canceled) m_state = State::Finished;
+
+  m_cursor.storeRelease(0);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <QAtomicInteger>
+#include <QEnableSharedFromThis>
+#include <QMutex>
+#include <QSharedPointer>
+#include <functional>
+
+#include "scancountcontroller.h"
+#include "scandedupset.h"
+
+namespace RedisClient {
+
+class Connection;
+
+/**
+ * @brief The ScanHandle class
+ * Control and progress of scan started by Connection::retrieveCollection()
+ * and other hi-level scan methods. Can be used from any thread.
+ *
+ * pause() takes effect after round which is in flight: its items are
+ * processed and next round is issued only after resume(). cancel() stops
+ * scan immediately: response of round in flight is discarded and callback
+ * is called one last time (in connection thread) with "Scan was canceled"
+ * error, so code waiting for final callback isn't left hanging.
+ *
+ * Paused scan doesn't keep its handle alive: if all references to handle
+ * are dropped, scan is released without further callbacks.
+ */
+class ScanHandle : public QEnableSharedFromThis<ScanHandle> {
+ public:
+  typedef std::function<void(QSharedPointer<ScanHandle>)> Continuation;
+
+  enum class State { Running, Paused, Canceled, Finished };
+
+  ScanHandle();
+
+  void cancel();
+  void pause();
+  void resume();
+
+  State state() const;
+  bool isCanceled() const { return state() == State::Canceled; }
+  bool isPaused() const { return state() == State::Paused; }
+  bool isFinished() const { return state() == State::Finished; }
+
+  /**
+   * @brief Cursor of next round, 0 when scan is finished
+   */
+  long long cursor() const { return m_cursor.loadAcquire(); }
+
+  /**
+   * @brief Number of items received so far
+   */
+  qint64 items() const { return m_items.loadAcquire(); }
+
+  int rounds() const { return m_rounds.loadAcquire(); }
+
+  /**
+   * @brief Number of removed duplicates, see ScanCommand::setUniqueResults()
+   */
+  qint64 duplicates() const { return m_duplicates.loadAcquire(); }
+
+  /**
+   * @brief Progress reporting of scan implementation
+   */
+  void addRound(long long cursor, int items, int duplicates = 0);
+  void finish();
+
+ private:
+  friend class Connection;
+
+  /**
+   * @brief Store continuation of scan if it's paused. Continuation gets
+   * the handle from resume() or cancel(), so it shouldn't capture it.
+   * @return state of scan: Running - continue right away, Paused -
+   * continuation is stored, Canceled - deliver final callback
+   */
+  State continueOrSuspend(Continuation next);
+
+ private:
+  mutable QMutex m_lock;
+  State m_state;
+  Continuation m_next;
+  QSharedPointer<ScanCountController> m_countController;
+  QSharedPointer<ScanDedupSet> m_seen;
+
+  QAtomicInteger<qint64> m_cursor;
+  QAtomicInteger<qint64> m_items;
+  QAtomicInteger<int> m_rounds;
+  QAtomicInteger<qint64> m_duplicates;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,49 @@
+#include "scriptcache.h"
+
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+QByteArray RedisClient::ScriptCache::sha1(const QByteArray &script) {
+  return QCryptographicHash::hash(script, QCryptographicHash::Sha1).toHex();
+}
+
+QByteArray RedisClient::ScriptCache::add(const QByteArray &script) {
+  QByteArray digest = sha1(script);
+
+  QMutexLocker lock(&m_lock);
+  m_scripts.insert(digest, script);
+
+  return digest;
+}
+
+QByteArray RedisClient::ScriptCache::script(const QByteArray &sha1) const {
+  QMutexLocker lock(&m_lock);
+  return m_scripts.value(sha1);
+}
+
+QList<QByteArray> RedisClient::ScriptCache::scripts() const {
+  QMutexLocker lock(&m_lock);
+  return m_scripts.values();
+}
+
+bool RedisClient::ScriptCache::isLoaded(const QString &node,
+                                        const QByteArray &sha1) const {
+  QMutexLocker lock(&m_lock);
+  return m_loaded.value(node).contains(sha1);
+}
+
+void RedisClient::ScriptCache::setLoaded(const QString &node,
+                                         const QByteArray &sha1,
+                                         bool loaded) {
+  QMutexLocker lock(&m_lock);
+
+  if (loaded)
+    m_loaded[node].insert(sha1);
+  else
+    m_loaded[node].remove(sha1);
+}
+
+void RedisClient::ScriptCache::resetLoaded() {
+  QMutexLocker lock(&m_lock);
+  m_loaded.clear();
+}
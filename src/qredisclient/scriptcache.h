@@ -0,0 +1,45 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+namespace RedisClient {
+
+/**
+ * @brief The ScriptCache class
+ * Lua scripts used by connection and their SHA1 digests (calculated
+ * locally, same as SCRIPT LOAD returns). Tracks nodes ("host:port") which
+ * have script in server-side cache, so EVALSHA is used for them and full
+ * script body is sent only once per node. Thread-safe.
+ */
+class ScriptCache {
+ public:
+  static QByteArray sha1(const QByteArray &script);
+
+  /**
+   * @brief Register script
+   * @return SHA1 of script in lowercase hex
+   */
+  QByteArray add(const QByteArray &script);
+
+  QByteArray script(const QByteArray &sha1) const;
+  QList<QByteArray> scripts() const;
+
+  bool isLoaded(const QString &node, const QByteArray &sha1) const;
+  void setLoaded(const QString &node, const QByteArray &sha1, bool loaded);
+
+  /**
+   * @brief Forget loaded scripts of all nodes (SCRIPT FLUSH, failover)
+   */
+  void resetLoaded();
+
+ private:
+  mutable QMutex m_lock;
+  QHash<QByteArray, QByteArray> m_scripts;
+  QHash<QString, QSet<QByteArray>> m_loaded;
+};
+
+}  // namespace RedisClient
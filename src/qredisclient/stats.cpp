@@ -0,0 +1,287 @@
+#include "stats.h"
+
+#include <QElapsedTimer>
+#include <QtAlgorithms>
+#include <limits>
+
+#include "command.h"
+
+RedisClient::LatencyHistogram::LatencyHistogram() { reset(); }
+
+void RedisClient::LatencyHistogram::record(qint64 usec) {
+  if (usec < 0) usec = 0;
+
+  m_buckets[bucketIndex(static_cast<quint64>(usec))].fetchAndAddRelaxed(1);
+  m_count.fetchAndAddRelaxed(1);
+  m_sum.fetchAndAddRelaxed(static_cast<quint64>(usec));
+
+  qint64 curr = m_min.loadAcquire();
+  while (usec < curr && !m_min.testAndSetOrdered(curr, usec, curr)) {
+  }
+
+  curr = m_max.loadAcquire();
+  while (usec > curr && !m_max.testAndSetOrdered(curr, usec, curr)) {
+  }
+}
+
+quint64 RedisClient::LatencyHistogram::count() const {
+  return m_count.loadAcquire();
+}
+
+qint64 RedisClient::LatencyHistogram::min() const {
+  return count() > 0 ? m_min.loadAcquire() : 0;
+}
+
+qint64 RedisClient::LatencyHistogram::max() const {
+  return m_max.loadAcquire();
+}
+
+double RedisClient::LatencyHistogram::mean() const {
+  quint64 c = count();
+
+  if (c == 0) return 0;
+
+  return static_cast<double>(m_sum.loadAcquire()) / c;
+}
+
+qint64 RedisClient::LatencyHistogram::percentile(double p) const {
+  quint64 total = count();
+
+  if (total == 0) return 0;
+
+  p = qBound(0.0, p, 100.0);
+
+  quint64 rank = static_cast<quint64>(p / 100.0 * total + 0.5);
+  if (rank == 0) rank = 1;
+
+  quint64 seen = 0;
+
+  for (int i = 0; i < BUCKETS; ++i) {
+    seen += m_buckets[i].loadAcquire();
+
+    if (seen >= rank) return qMin(bucketUpperBound(i), max());
+  }
+
+  return max();
+}
+
+void RedisClient::LatencyHistogram::reset() {
+  for (int i = 0; i < BUCKETS; ++i) {
+    m_buckets[i].storeRelease(0);
+  }
+  m_count.storeRelease(0);
+  m_sum.storeRelease(0);
+  m_min.storeRelease(std::numeric_limits<qint64>::max());
+  m_max.storeRelease(0);
+}
+
+QVariantMap RedisClient::LatencyHistogram::toVariantMap() const {
+  QVariantMap result;
+  result["count"] = count();
+  result["min"] = min();
+  result["max"] = max();
+  result["mean"] = mean();
+  result["p50"] = percentile(50);
+  result["p90"] = percentile(90);
+  result["p99"] = percentile(99);
+  result["p999"] = percentile(99.9);
+  return result;
+}
+
+int RedisClient::LatencyHistogram::bucketIndex(quint64 value) {
+  const quint64 maxValue = (Q_UINT64_C(1) << MAX_VALUE_BITS) - 1;
+
+  if (value > maxValue) value = maxValue;
+
+  if (value < SUB_BUCKETS) return static_cast<int>(value);
+
+  int exponent = 63 - static_cast<int>(qCountLeadingZeroBits(value));
+  int shift = exponent - SUB_BUCKET_BITS;
+  int subBucket = static_cast<int>(value >> shift) - SUB_BUCKETS;
+
+  return SUB_BUCKETS + shift * SUB_BUCKETS + subBucket;
+}
+
+qint64 RedisClient::LatencyHistogram::bucketUpperBound(int index) {
+  if (index < SUB_BUCKETS) return index;
+
+  int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+  int subBucket = (index - SUB_BUCKETS) % SUB_BUCKETS;
+
+  qint64 lowerBound = static_cast<qint64>(SUB_BUCKETS + subBucket) << shift;
+
+  return lowerBound + (Q_INT64_C(1) << shift) - 1;
+}
+
+QVariantMap RedisClient::CommandStats::toVariantMap() const {
+  QVariantMap result;
+  result["queue_wait"] = queueWait.toVariantMap();
+  result["network_rtt"] = networkRtt.toVariantMap();
+  result["parse"] = parse.toVariantMap();
+  result["delivery"] = delivery.toVariantMap();
+  return result;
+}
+
+RedisClient::ConnectionStats::ConnectionStats()
+    : m_generation(0),
+      m_bytesIn(0),
+      m_bytesOut(0),
+      m_queueDepth(0),
+      m_maxQueueDepth(0),
+      m_inFlight(0),
+      m_maxInFlight(0),
+      m_reconnects(0),
+      m_redirects(0) {}
+
+qint64 RedisClient::ConnectionStats::now() {
+  static const QElapsedTimer clock = []() {
+    QElapsedTimer t;
+    t.start();
+    return t;
+  }();
+
+  return clock.nsecsElapsed() / 1000;
+}
+
+QByteArray RedisClient::ConnectionStats::commandName(
+    const RedisClient::Command &cmd) {
+  if (cmd.isPipelineCommand())
+    return cmd.isTransaction() ? QByteArrayLiteral("MULTI")
+                               : QByteArrayLiteral("PIPELINE");
+
+  QList<QByteArray> parts = cmd.getSplitedRepresentattion();
+
+  if (parts.isEmpty()) return QByteArray();
+
+  return parts.first().toUpper();
+}
+
+QSharedPointer<RedisClient::CommandStats>
+RedisClient::ConnectionStats::command(const QByteArray &name) {
+  {
+    QReadLocker lock(&m_commandsLock);
+    auto i = m_commands.constFind(name);
+
+    if (i != m_commands.constEnd()) return i.value();
+  }
+
+  QWriteLocker lock(&m_commandsLock);
+  QSharedPointer<CommandStats> &stats = m_commands[name];
+
+  if (!stats) stats = QSharedPointer<CommandStats>(new CommandStats());
+
+  return stats;
+}
+
+quint32 RedisClient::ConnectionStats::generation() const {
+  return m_generation.loadAcquire();
+}
+
+QList<QByteArray> RedisClient::ConnectionStats::commandNames() const {
+  QReadLocker lock(&m_commandsLock);
+  return m_commands.keys();
+}
+
+void RedisClient::ConnectionStats::addBytesIn(qint64 bytes) {
+  m_bytesIn.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+}
+
+void RedisClient::ConnectionStats::addBytesOut(qint64 bytes) {
+  m_bytesOut.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+}
+
+void RedisClient::ConnectionStats::setQueueDepth(int depth) {
+  m_queueDepth.storeRelease(depth);
+  updateMax(m_maxQueueDepth, depth);
+}
+
+void RedisClient::ConnectionStats::setInFlight(int count) {
+  m_inFlight.storeRelease(count);
+  updateMax(m_maxInFlight, count);
+}
+
+void RedisClient::ConnectionStats::addReconnect() {
+  m_reconnects.fetchAndAddRelaxed(1);
+}
+
+void RedisClient::ConnectionStats::addRedirect() {
+  m_redirects.fetchAndAddRelaxed(1);
+}
+
+quint64 RedisClient::ConnectionStats::bytesIn() const {
+  return m_bytesIn.loadAcquire();
+}
+
+quint64 RedisClient::ConnectionStats::bytesOut() const {
+  return m_bytesOut.loadAcquire();
+}
+
+int RedisClient::ConnectionStats::queueDepth() const {
+  return m_queueDepth.loadAcquire();
+}
+
+int RedisClient::ConnectionStats::maxQueueDepth() const {
+  return m_maxQueueDepth.loadAcquire();
+}
+
+int RedisClient::ConnectionStats::inFlight() const {
+  return m_inFlight.loadAcquire();
+}
+
+int RedisClient::ConnectionStats::maxInFlight() const {
+  return m_maxInFlight.loadAcquire();
+}
+
+quint64 RedisClient::ConnectionStats::reconnects() const {
+  return m_reconnects.loadAcquire();
+}
+
+quint64 RedisClient::ConnectionStats::redirects() const {
+  return m_redirects.loadAcquire();
+}
+
+void RedisClient::ConnectionStats::reset() {
+  {
+    QWriteLocker lock(&m_commandsLock);
+    m_commands.clear();
+    m_generation.fetchAndAddOrdered(1);
+  }
+
+  m_bytesIn.storeRelease(0);
+  m_bytesOut.storeRelease(0);
+  m_maxQueueDepth.storeRelease(m_queueDepth.loadAcquire());
+  m_maxInFlight.storeRelease(m_inFlight.loadAcquire());
+  m_reconnects.storeRelease(0);
+  m_redirects.storeRelease(0);
+}
+
+QVariantMap RedisClient::ConnectionStats::toVariantMap() const {
+  QVariantMap commands;
+
+  {
+    QReadLocker lock(&m_commandsLock);
+
+    for (auto i = m_commands.constBegin(); i != m_commands.constEnd(); ++i) {
+      commands[QString::fromUtf8(i.key())] = i.value()->toVariantMap();
+    }
+  }
+
+  QVariantMap result;
+  result["bytes_in"] = bytesIn();
+  result["bytes_out"] = bytesOut();
+  result["queue_depth"] = queueDepth();
+  result["max_queue_depth"] = maxQueueDepth();
+  result["in_flight"] = inFlight();
+  result["max_in_flight"] = maxInFlight();
+  result["reconnects"] = reconnects();
+  result["redirects"] = redirects();
+  result["commands"] = commands;
+  return result;
+}
+
+void RedisClient::ConnectionStats::updateMax(QAtomicInteger<int> &max,
+                                             int value) {
+  int curr = max.loadAcquire();
+  while (value > curr && !max.testAndSetOrdered(curr, value, curr)) {
+  }
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QVariantMap>
+
+namespace RedisClient {
+
+class Command;
+
+/**
+ * @brief The LatencyHistogram class
+ * HDR-style log-linear histogram of durations in microseconds.
+ * Each power of two range is split into 16 linear sub-buckets, so reported
+ * percentiles have relative error below 6.25%. Values above ~19 hours are
+ * clamped. record() is lock-free and can be called from any thread.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void record(qint64 usec);
+
+  quint64 count() const;
+  qint64 min() const;
+  qint64 max() const;
+  double mean() const;
+
+  /**
+   * @brief Upper bound of the bucket containing given percentile
+   * @param p - 0..100
+   * @return value in microseconds, 0 if histogram is empty
+   */
+  qint64 percentile(double p) const;
+
+  void reset();
+
+  /**
+   * @brief count, min, max, mean, p50, p90, p99, p999
+   * @return
+   */
+  QVariantMap toVariantMap() const;
+
+ private:
+  static const int SUB_BUCKET_BITS = 4;
+  static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const int MAX_VALUE_BITS = 36;
+  static const int BUCKETS =
+      SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+  static int bucketIndex(quint64 value);
+  static qint64 bucketUpperBound(int index);
+
+ private:
+  Q_DISABLE_COPY(LatencyHistogram)
+
+  QAtomicInteger<quint64> m_buckets[BUCKETS];
+  QAtomicInteger<quint64> m_count;
+  QAtomicInteger<quint64> m_sum;
+  QAtomicInteger<qint64> m_min;
+  QAtomicInteger<qint64> m_max;
+};
+
+/**
+ * @brief The CommandStats struct
+ * Latency breakdown of single command type:
+ * queueWait - from adding to transporter queue till writing to socket
+ * networkRtt - from writing to socket till reading of the last response byte
+ * parse - time spent in response parser
+ * delivery - from end of parsing till callback invocation
+ */
+struct CommandStats {
+  LatencyHistogram queueWait;
+  LatencyHistogram networkRtt;
+  LatencyHistogram parse;
+  LatencyHistogram delivery;
+
+  QVariantMap toVariantMap() const;
+};
+
+/**
+ * @brief The ConnectionStats class
+ * Counters and per-command latency histograms of the connection.
+ * Updated by transporter thread, can be read from any thread.
+ * All timestamps are taken from monotonic clock (see now()).
+ */
+class ConnectionStats {
+ public:
+  ConnectionStats();
+
+  /**
+   * @brief Monotonic timestamp in microseconds
+   */
+  static qint64 now();
+
+  /**
+   * @brief Name used to group statistics: uppercase command name,
+   * PIPELINE or MULTI for pipelines.
+   */
+  static QByteArray commandName(const Command &cmd);
+
+  /**
+   * @brief Get (or create) statistics for command name.
+   * Returned object stays valid until reset().
+   */
+  QSharedPointer<CommandStats> command(const QByteArray &name);
+
+  /**
+   * @brief Incremented by reset(), lets callers which cache command()
+   * results drop them without taking the lock
+   */
+  quint32 generation() const;
+
+  QList<QByteArray> commandNames() const;
+
+  void addBytesIn(qint64 bytes);
+  void addBytesOut(qint64 bytes);
+  void setQueueDepth(int depth);
+  void setInFlight(int count);
+  void addReconnect();
+  void addRedirect();
+
+  quint64 bytesIn() const;
+  quint64 bytesOut() const;
+  int queueDepth() const;
+  int maxQueueDepth() const;
+  int inFlight() const;
+  int maxInFlight() const;
+  quint64 reconnects() const;
+  quint64 redirects() const;
+
+  void reset();
+
+  QVariantMap toVariantMap() const;
+
+ private:
+  Q_DISABLE_COPY(ConnectionStats)
+
+  static void updateMax(QAtomicInteger<int> &max, int value);
+
+  mutable QReadWriteLock m_commandsLock;
+  QHash<QByteArray, QSharedPointer<CommandStats>> m_commands;
+  QAtomicInteger<quint32> m_generation;
+
+  QAtomicInteger<quint64> m_bytesIn;
+  QAtomicInteger<quint64> m_bytesOut;
+  QAtomicInteger<int> m_queueDepth;
+  QAtomicInteger<int> m_maxQueueDepth;
+  QAtomicInteger<int> m_inFlight;
+  QAtomicInteger<int> m_maxInFlight;
+  QAtomicInteger<quint64> m_reconnects;
+  QAtomicInteger<quint64> m_redirects;
+};
+
+}  // namespace RedisClient
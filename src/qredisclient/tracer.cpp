@@ -0,0 +1,212 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "stats.h"
+
+RedisClient::Tracer::Tracer() : m_enabled(0), m_next(0), m_size(0) {}
+
+void RedisClient::Tracer::start(int capacity) {
+  QMutexLocker lock(&m_lock);
+
+  m_records = QVector<TraceRecord>(qMax(capacity, 1));
+  m_next = 0;
+  m_size = 0;
+  m_threadNames.clear();
+  m_enabled.store(1);
+}
+
+void RedisClient::Tracer::stop() { m_enabled.store(0); }
+
+void RedisClient::Tracer::addCommand(quint64 commandId, const QByteArray &name,
+                                     qint64 enqueuedAt, qint64 dispatchedAt,
+                                     qint64 writtenAt, qint64 firstByteAt,
+                                     qint64 parsedAt) {
+  if (!isEnabled()) return;
+
+  TraceRecord record{};
+  record.type = TraceRecord::Type::Command;
+  record.commandId = commandId;
+  record.name = name;
+  record.enqueuedAt = enqueuedAt;
+  record.dispatchedAt = dispatchedAt;
+  record.writtenAt = writtenAt;
+  record.firstByteAt = firstByteAt;
+  record.parsedAt = parsedAt;
+  add(record);
+}
+
+void RedisClient::Tracer::addCallback(quint64 commandId,
+                                      const QByteArray &name, qint64 parsedAt,
+                                      qint64 startedAt, qint64 finishedAt) {
+  if (!isEnabled()) return;
+
+  TraceRecord record{};
+  record.type = TraceRecord::Type::Callback;
+  record.commandId = commandId;
+  record.name = name;
+  record.parsedAt = parsedAt;
+  record.startedAt = startedAt;
+  record.finishedAt = finishedAt;
+  add(record);
+}
+
+void RedisClient::Tracer::addInstant(const QByteArray &name,
+                                     const QString &details) {
+  if (!isEnabled()) return;
+
+  TraceRecord record{};
+  record.type = TraceRecord::Type::Instant;
+  record.name = name;
+  record.details = details;
+  record.startedAt = ConnectionStats::now();
+  add(record);
+}
+
+QVector<RedisClient::TraceRecord> RedisClient::Tracer::records() const {
+  QMutexLocker lock(&m_lock);
+  QVector<TraceRecord> result;
+  result.reserve(m_size);
+
+  int capacity = m_records.size();
+
+  for (int i = 0; i < m_size; ++i) {
+    result.append(m_records.at((m_next - m_size + i + capacity) % capacity));
+  }
+
+  return result;
+}
+
+bool RedisClient::Tracer::writeChromeTrace(QIODevice *device) const {
+  if (!device) return false;
+
+  QVector<TraceRecord> traceRecords = records();
+  QHash<quintptr, QString> threadNames;
+
+  {
+    QMutexLocker lock(&m_lock);
+    threadNames = m_threadNames;
+  }
+
+  // Chrome trace expects small numeric thread ids
+  QHash<quintptr, int> tids;
+  for (auto i = threadNames.constBegin(); i != threadNames.constEnd(); ++i) {
+    tids.insert(i.key(), tids.size() + 1);
+  }
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray events;
+
+  auto event = [pid, &tids](const QByteArray &name, const QString &phase,
+                            qint64 ts, quintptr thread) {
+    QJsonObject e;
+    e["name"] = QString::fromUtf8(name);
+    e["ph"] = phase;
+    e["ts"] = ts;
+    e["pid"] = pid;
+    e["tid"] = tids.value(thread);
+    return e;
+  };
+
+  // Async slice in the command track
+  auto slice = [&events, &event](const TraceRecord &r, const QByteArray &name,
+                                 qint64 from, qint64 to) {
+    if (from <= 0 || to < from) return;
+
+    QJsonObject begin = event(name, "b", from, r.threadId);
+    begin["cat"] = "command";
+    begin["id"] = QString::number(r.commandId);
+    events.append(begin);
+
+    QJsonObject end = event(name, "e", to, r.threadId);
+    end["cat"] = "command";
+    end["id"] = QString::number(r.commandId);
+    events.append(end);
+  };
+
+  for (const TraceRecord &r : traceRecords) {
+    switch (r.type) {
+      case TraceRecord::Type::Command: {
+        qint64 startedAt = r.enqueuedAt > 0 ? r.enqueuedAt : r.dispatchedAt;
+
+        slice(r, r.name, startedAt, r.parsedAt);
+        slice(r, "queue", r.enqueuedAt, r.dispatchedAt);
+        slice(r, "write", r.dispatchedAt, r.writtenAt);
+
+        if (r.firstByteAt > 0) {
+          slice(r, "server", r.writtenAt, r.firstByteAt);
+          slice(r, "read", r.firstByteAt, r.parsedAt);
+        } else {
+          slice(r, "server", r.writtenAt, r.parsedAt);
+        }
+        break;
+      }
+      case TraceRecord::Type::Callback: {
+        slice(r, "delivery", r.parsedAt, r.startedAt);
+
+        QJsonObject callback = event(r.name, "X", r.startedAt, r.threadId);
+        callback["cat"] = "callback";
+        callback["dur"] = r.finishedAt - r.startedAt;
+        callback["args"] = QJsonObject{{"id", QString::number(r.commandId)}};
+        events.append(callback);
+        break;
+      }
+      case TraceRecord::Type::Instant: {
+        QJsonObject instant = event(r.name, "i", r.startedAt, r.threadId);
+        instant["s"] = "g";
+        instant["args"] = QJsonObject{{"details", r.details}};
+        events.append(instant);
+        break;
+      }
+    }
+  }
+
+  for (auto i = threadNames.constBegin(); i != threadNames.constEnd(); ++i) {
+    QJsonObject meta = event("thread_name", "M", 0, i.key());
+    meta["args"] = QJsonObject{{"name", i.value()}};
+    events.append(meta);
+  }
+
+  QJsonObject root;
+  root["traceEvents"] = events;
+  root["displayTimeUnit"] = "ms";
+
+  QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+
+  return device->write(json) == json.size();
+}
+
+bool RedisClient::Tracer::saveChromeTrace(const QString &path) const {
+  QFile file(path);
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+  return writeChromeTrace(&file);
+}
+
+void RedisClient::Tracer::add(RedisClient::TraceRecord record) {
+  record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+  QMutexLocker lock(&m_lock);
+
+  if (m_records.isEmpty()) return;
+
+  if (!m_threadNames.contains(record.threadId)) {
+    QString name = QThread::currentThread()->objectName();
+
+    if (name.isEmpty())
+      name = QString("thread %1").arg(m_threadNames.size() + 1);
+
+    m_threadNames.insert(record.threadId, name);
+  }
+
+  m_records[m_next] = record;
+  m_next = (m_next + 1) % m_records.size();
+  m_size = qMin(m_size + 1, m_records.size());
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace RedisClient {
+
+/**
+ * @brief The TraceRecord struct
+ * Command lifecycle stamps (monotonic, see ConnectionStats::now()).
+ * Command records are written by transporter thread when response is
+ * parsed, callback records - by thread which invoked callback.
+ */
+struct TraceRecord {
+  enum class Type { Command, Callback, Instant };
+
+  Type type;
+  quint64 commandId;
+  QByteArray name;
+  quintptr threadId;
+  QString details;
+
+  // Command: enqueuedAt (0 for internal commands) .. parsedAt
+  qint64 enqueuedAt;
+  qint64 dispatchedAt;
+  qint64 writtenAt;
+  qint64 firstByteAt;
+  qint64 parsedAt;
+
+  // Callback: parsedAt, startedAt .. finishedAt
+  // Instant: startedAt
+  qint64 startedAt;
+  qint64 finishedAt;
+};
+
+/**
+ * @brief The Tracer class
+ * Optional ring buffer of command lifecycle records with export to
+ * Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+ * Each command is shown as async track with queue, write, server, read and
+ * delivery phases, callbacks are shown on threads which executed them.
+ * Disabled tracer costs one atomic load per command.
+ */
+class Tracer {
+ public:
+  Tracer();
+
+  /**
+   * @brief Start tracing, previous records are dropped.
+   * @param capacity - number of records kept in ring buffer
+   */
+  void start(int capacity);
+  void stop();
+
+  bool isEnabled() const { return m_enabled.load() != 0; }
+
+  void addCommand(quint64 commandId, const QByteArray &name, qint64 enqueuedAt,
+                  qint64 dispatchedAt, qint64 writtenAt, qint64 firstByteAt,
+                  qint64 parsedAt);
+
+  void addCallback(quint64 commandId, const QByteArray &name, qint64 parsedAt,
+                   qint64 startedAt, qint64 finishedAt);
+
+  void addInstant(const QByteArray &name, const QString &details);
+
+  /**
+   * @brief Records in chronological order
+   * @return
+   */
+  QVector<TraceRecord> records() const;
+
+  bool writeChromeTrace(QIODevice *device) const;
+  bool saveChromeTrace(const QString &path) const;
+
+ private:
+  void add(TraceRecord record);
+
+ private:
+  Q_DISABLE_COPY(Tracer)
+
+  QAtomicInt m_enabled;
+  mutable QMutex m_lock;
+  QVector<TraceRecord> m_records;
+  int m_next;
+  int m_size;
+  QHash<quintptr, QString> m_threadNames;
+};
+
+}  // namespace RedisClient
@@ -1,13 +1,10 @@
 #include "abstracttransporter.h"
 
-#include <QDateTime>
 #include <QDebug>
 #include <QNetworkProxy>
 #include <QSettings>
 
 #include "qredisclient/connection.h"
-#include "qredisclient/private/responseemmiter.h"
-#include "qredisclient/utils/text.h"
 
 #define MAX_CLUSTER_REDIRECTS 5
 
@@ -17,14 +14,26 @@ RedisClient::AbstractTransporter::AbstractTransporter(
       m_reconnectEnabled(true),
       m_pendingClusterRedirect(false),
       m_connectionInitialized(false),
-      m_followedClusterRedirects(0) {
+      m_followedClusterRedirects(0),
+      m_batchResponses(false),
+      m_stats(connection->m_stats),
+      m_tracer(connection->m_tracer),
+      m_commandStatsEnabled(connection->getConfig().commandStats()),
+      m_commandStatsGeneration(connection->m_stats->generation()),
+      m_responseTiming(),
+      m_logLevel(static_cast<int>(connection->m_logLevel)),
+      m_lastCommandId(0) {
   // connect signals & slots between connection & transporter
   connect(connection, SIGNAL(addCommandsToWorker(const QList<Command> &)), this,
           SLOT(addCommands(const QList<Command> &)));
   connect(connection, SIGNAL(reconnectTo(const QString &, int)), this,
           SLOT(reconnectTo(const QString &, int)));
-  connect(this, SIGNAL(logEvent(const QString &)), connection,
-          SIGNAL(log(const QString &)));
+  connect(this, &AbstractTransporter::logRecord, connection,
+          &Connection::processLogRecord);
+  connect(this, &AbstractTransporter::logEvent, this,
+          [this](const QString &message) {
+            log(LogLevel::Info, LogRecord::Event::Message, 0, {message});
+          });
 
   connect(this, &AbstractTransporter::errorOccurred, this,
           &AbstractTransporter::cancelRunningCommands);
@@ -43,6 +52,10 @@ int RedisClient::AbstractTransporter::pipelineCommandsLimit() const {
   return 1000;
 }
 
+void RedisClient::AbstractTransporter::setLogLevel(RedisClient::LogLevel level) {
+  m_logLevel.store(static_cast<int>(level));
+}
+
 void RedisClient::AbstractTransporter::init() {
   if (isInitialized()) return;
 
@@ -57,17 +70,24 @@ void RedisClient::AbstractTransporter::disconnectFromHost() {
   m_pendingClusterRedirect = false;
   m_followedClusterRedirects = 0;
   m_connectionInitialized = false;
+  updateQueueStats();
 }
 
 void RedisClient::AbstractTransporter::addCommands(
     const QList<Command> &commands) {
+  qint64 enqueuedAt = ConnectionStats::now();
+
   for (auto cmd : commands) {
+    cmd.setEnqueuedAt(enqueuedAt);
+
     if (cmd.isHiPriorityCommand())
       m_internalCommands.enqueue(cmd);
     else
       m_commands.enqueue(cmd);
   }
 
+  updateQueueStats();
+
   emit commandAdded();
 
   if (isInitialized())
@@ -78,21 +98,17 @@ void RedisClient::AbstractTransporter::cancelCommands(QObject *owner) {
   if (!owner) return;
 
   // Cancel running commands
-  for (auto curr = m_runningCommands.begin();
-       curr != m_runningCommands.end();) {
-    if ((*curr)->cmd.getOwner() == owner) {
-      curr = m_runningCommands.erase(curr);
-    } else {
-      ++curr;
-    }
-  }
+  m_runningCommands.removeIf([owner](const RunningCommand &c) {
+    return c.cmd.getOwner() == owner;
+  });
+  updateQueueStats();
 
   // Remove subscriptions
   Subscriptions::iterator i = m_subscriptions.begin();
   while (i != m_subscriptions.constEnd()) {
-    if (i.value()->owner == owner) {
+    if (i.value().owner == owner) {
       i = m_subscriptions.erase(i);
-      emit logEvent("Subscription was canceled.");
+      log(LogLevel::Info, LogRecord::Event::SubscriptionCanceled);
     } else {
       ++i;
     }
@@ -104,23 +120,22 @@ void RedisClient::AbstractTransporter::cancelCommands(QObject *owner) {
   for (auto curr = m_commands.begin(); curr != m_commands.end();) {
     if (curr->getOwner() == owner) {
       curr = m_commands.erase(curr);
-      emit logEvent("Command was canceled.");
+      log(LogLevel::Info, LogRecord::Event::CommandCanceled);
     } else {
       ++curr;
     }
   }
+  updateQueueStats();
 }
 
 void RedisClient::AbstractTransporter::sendResponse(
     const RedisClient::Response &response) {
-  //logResponse(response);
-
   if (response.isMessage() ||
       m_connection->m_currentMode == Connection::Mode::Monitor) {
     QByteArray channel = response.getChannel();
 
     if (m_subscriptions.contains(channel))
-      m_subscriptions[channel]->sendResponse(response, QString());
+      deliverResponse(m_subscriptions[channel], response);
 
     return;
   }
@@ -135,25 +150,30 @@ void RedisClient::AbstractTransporter::sendResponse(
     return;
   }
 
-  if (m_runningCommands.first()->cmd.isPipelineCommand()) {
-    auto pipelineCmd = m_runningCommands.first();
+  m_runningCommands.first().parseTime += m_responseTiming.parseTime;
+
+  if (m_runningCommands.first().cmd.isPipelineCommand()) {
+    RunningCommand &pipelineCmd = m_runningCommands.first();
 
-    if (pipelineCmd->cmd.isTransaction() &&
+    if (pipelineCmd.cmd.isTransaction() &&
         (response.isOkMessage() || response.isQueuedMessage())) {
       return;
     }
 
-    if (!pipelineCmd->cmd.isTransaction() && pipelineCmd->cmd.length() > 1) {
-      pipelineCmd->cmd.removeFirstPipelineCmdFromQueue();
+    if (!pipelineCmd.cmd.isTransaction() && pipelineCmd.cmd.length() > 1) {
+      pipelineCmd.cmd.removeFirstPipelineCmdFromQueue();
       return;
     }
   }
 
-  auto runningCommand = m_runningCommands.dequeue();
+  RunningCommand runningCommand = m_runningCommands.dequeue();
+  updateQueueStats();
+
+  if (isLogEnabled(LogLevel::Trace)) logResponse(runningCommand.id, response);
 
   // Re-try on protocol errors
   if (response.isProtocolErrorMessage()) {
-    m_commands.prepend(runningCommand->cmd);
+    m_commands.prepend(runningCommand.cmd);
     return;
   }
 
@@ -165,39 +185,59 @@ void RedisClient::AbstractTransporter::sendResponse(
     }
 
     // Reset cluster redirections counter on first successful reply
-    bool isKeyCmd = runningCommand->cmd.getKeyName().size() > 0;
+    bool isKeyCmd = runningCommand.cmd.getKeyName().size() > 0;
     if (isKeyCmd) {
       m_followedClusterRedirects = 0;
     }
   }
 
-  if (runningCommand->cmd.isUnSubscriptionCommand()) {
+  if (runningCommand.cmd.isUnSubscriptionCommand()) {
     QList<QByteArray> channels =
-        runningCommand->cmd.getSplitedRepresentattion().mid(1);
+        runningCommand.cmd.getSplitedRepresentattion().mid(1);
     for (QByteArray channel : channels) {
       m_subscriptions.remove(channel);
     }
   }
 
-  if (runningCommand->cmd.isSelectCommand() && response.isOkMessage()) {
+  if (runningCommand.cmd.isSelectCommand() && response.isOkMessage()) {
     m_connection->changeCurrentDbNumber(
-        runningCommand->cmd.getPartAsString(1).toInt());
+        runningCommand.cmd.getPartAsString(1).toInt());
+  }
+
+  if (m_responseTiming.readAt > 0) {
+    QSharedPointer<CommandTiming> timing = runningCommand.cmd.getTiming();
+
+    if (timing) timing->readAt = m_responseTiming.readAt;
+  }
+
+  if (runningCommand.stats && m_responseTiming.readAt > 0) {
+    runningCommand.stats->networkRtt.record(m_responseTiming.readAt -
+                                            runningCommand.sentAt);
+    runningCommand.stats->parse.record(runningCommand.parseTime);
   }
 
-  runningCommand->cmd.getDeferred().complete(response);
+  if (m_tracer->isEnabled()) {
+    m_tracer->addCommand(
+        runningCommand.id, ConnectionStats::commandName(runningCommand.cmd),
+        runningCommand.cmd.enqueuedAt(), runningCommand.sentAt,
+        runningCommand.writtenAt, runningCommand.firstByteAt,
+        m_responseTiming.parsedAt);
+  }
+
+  if (runningCommand.cmd.hasDeferred())
+    runningCommand.cmd.getDeferred().complete(response);
 
-  if (runningCommand->emitter) {
-    runningCommand->emitter->sendResponse(response, QString());
+  if (runningCommand.emitter.isValid()) {
+    deliverResponse(runningCommand.emitter, response, &runningCommand);
 
-    if (runningCommand->cmd.isSubscriptionCommand())
+    if (runningCommand.cmd.isSubscriptionCommand())
       addSubscriptionsFromRunningCommand(runningCommand);
 
-    if (runningCommand->cmd.isMonitorCommand()) {
+    if (runningCommand.cmd.isMonitorCommand()) {
         m_connection->m_currentMode = Connection::Mode::Monitor;
-        m_subscriptions.insert(QByteArray(), runningCommand->emitter);
+        m_subscriptions.insert(QByteArray(), runningCommand.emitter);
     }
   }
-  runningCommand.clear();
 }
 
 void RedisClient::AbstractTransporter::resetDbIndex() {
@@ -251,9 +291,7 @@ void RedisClient::AbstractTransporter::pickClusterNodeForNextCommand()
 
     m_pendingClusterRedirect = true;
 
-    emit logEvent(QString("Cluster node picked for next command: %1:%2")
-                      .arg(host)
-                      .arg(port));
+    log(LogLevel::Info, LogRecord::Event::ClusterNodePicked, 0, {host, port});
 
     QTimer::singleShot(0, this, [this, host, port]() {      
       reconnectTo(host, port);
@@ -280,18 +318,19 @@ bool RedisClient::AbstractTransporter::validateSystemProxy() {
 void RedisClient::AbstractTransporter::reAddRunningCommandToQueue() {
   qDebug() << "Running commands: " << m_runningCommands.size();
 
-  for (auto curr : m_runningCommands) {
-      if (curr->cmd.isHiPriorityCommand()) {
-        m_internalCommands.prepend(curr->cmd);
+  for (const RunningCommand &curr : m_runningCommands) {
+      if (curr.cmd.isHiPriorityCommand()) {
+        m_internalCommands.prepend(curr.cmd);
       } else {
-        m_commands.prepend(curr->cmd);
+        m_commands.prepend(curr.cmd);
       }
 
   }
   m_runningCommands.clear();
+  updateQueueStats();
 
   qDebug() << "Running commands were re-added to queue";
-  emit logEvent("Running commands were re-added to queue.");
+  log(LogLevel::Info, LogRecord::Event::RunningCommandsRequeued);
 }
 
 void RedisClient::AbstractTransporter::cancelRunningCommands() {
@@ -299,8 +338,9 @@ void RedisClient::AbstractTransporter::cancelRunningCommands() {
 
   qDebug() << "Cancel running commands" << this;
 
-  emit logEvent("Cancel running commands");
+  log(LogLevel::Warning, LogRecord::Event::RunningCommandsCanceled);
   m_runningCommands.clear();
+  updateQueueStats();
 }
 
 void RedisClient::AbstractTransporter::processCommandQueue() {
@@ -331,8 +371,8 @@ void RedisClient::AbstractTransporter::processCommandQueue() {
       return executeCmd(m_internalCommands.dequeue());
   }
 
-  for (auto runningCmd : m_runningCommands) {
-      if (runningCmd->cmd.isHiPriorityCommand()) {
+  for (const RunningCommand &runningCmd : m_runningCommands) {
+      if (runningCmd.cmd.isHiPriorityCommand()) {
           QTimer::singleShot(0, this, &AbstractTransporter::processCommandQueue);
           return;
       }
@@ -365,28 +405,98 @@ void RedisClient::AbstractTransporter::processCommandQueue() {
   executeCmd(nextCmd);
 }
 
+bool RedisClient::AbstractTransporter::isLogEnabled(LogLevel level) const {
+  if (static_cast<int>(level) <= m_logLevel.load())
+    return m_connection->hasLogListeners();
+
+  return level <= LogLevel::Debug && m_connection->hasTextLogListeners();
+}
+
+void RedisClient::AbstractTransporter::log(RedisClient::LogLevel level,
+                                           RedisClient::LogRecord::Event event,
+                                           quint64 commandId,
+                                           const QVariantList &args) {
+  if (!isLogEnabled(level)) return;
+
+  emit logRecord(LogRecord(level, event, commandId, args));
+}
+
 void RedisClient::AbstractTransporter::logResponse(
-    const RedisClient::Response &response) {
-  QString result;
+    quint64 commandId, const RedisClient::Response &response) {
+  QVariantList args{static_cast<int>(response.type())};
 
   if (response.type() == RedisClient::Response::Type::Status ||
       response.type() == RedisClient::Response::Type::Error) {
-    result = response.value().toByteArray();
-  } else if (response.type() == RedisClient::Response::Type::String) {
-    result = QString("Bulk");
-  } else if (response.type() == RedisClient::Response::Type::Array) {
-    result = QString("Array");
+    args.append(response.value());
+  }
+
+  log(LogLevel::Trace, LogRecord::Event::ResponseReceived, commandId, args);
+}
+
+void RedisClient::AbstractTransporter::deliverResponse(
+    const RedisClient::ResponseEmitter &emitter,
+    const RedisClient::Response &response,
+    const RunningCommand *runningCommand) {
+  DeliveryStamp stamp;
+  stamp.parsedAt = m_responseTiming.parsedAt;
+
+  if (runningCommand && m_tracer->isEnabled()) {
+    stamp.commandId = runningCommand->id;
+    stamp.name = ConnectionStats::commandName(runningCommand->cmd);
+    stamp.tracer = m_tracer;
+  }
+
+  if (m_batchResponses) {
+    m_responseBatch.add(emitter, response, QString(), stamp);
+  } else {
+    emitter.sendResponse(response, QString(), stamp);
+  }
+}
+
+void RedisClient::AbstractTransporter::stampFirstByte(qint64 readAt) {
+  if (m_runningCommands.isEmpty()) return;
+
+  RunningCommand &head = m_runningCommands.first();
+
+  if (head.firstByteAt == 0) head.firstByteAt = readAt;
+}
+
+QSharedPointer<RedisClient::CommandStats>
+RedisClient::AbstractTransporter::commandStats(const Command &cmd) {
+  if (!m_commandStatsEnabled) return QSharedPointer<CommandStats>();
+
+  quint32 generation = m_stats->generation();
+
+  if (generation != m_commandStatsGeneration) {
+    m_commandStatsCache.clear();
+    m_commandStatsGeneration = generation;
+  }
+
+  QByteArray key;
+
+  if (cmd.isPipelineCommand()) {
+    key = ConnectionStats::commandName(cmd);
+  } else {
+    QList<QByteArray> parts = cmd.getSplitedRepresentattion();
+    if (!parts.isEmpty()) key = parts.first();
   }
 
-  emit logEvent(QString("%1 > Response received : %2")
-                    .arg(m_connection->getConfig().name())
-                    .arg(result));
+  QSharedPointer<CommandStats> &stats = m_commandStatsCache[key];
+
+  if (!stats) stats = m_stats->command(ConnectionStats::commandName(cmd));
+
+  return stats;
+}
+
+void RedisClient::AbstractTransporter::updateQueueStats() {
+  m_stats->setQueueDepth(m_commands.size() + m_internalCommands.size());
+  m_stats->setInFlight(m_runningCommands.size());
 }
 
 void RedisClient::AbstractTransporter::processClusterRedirect(
-    QSharedPointer<RunningCommand> runningCommand,
+    const RunningCommand &runningCommand,
     const RedisClient::Response &response) {
-  Q_ASSERT(runningCommand);
+  m_stats->addRedirect();
 
   if (m_followedClusterRedirects >= MAX_CLUSTER_REDIRECTS) {
       emit errorOccurred("Too many cluster redirects. Connection aborted.");
@@ -394,8 +504,7 @@ void RedisClient::AbstractTransporter::processClusterRedirect(
       return;
   }
 
-  m_commands.prepend(runningCommand->cmd);
-  runningCommand.clear();
+  m_commands.prepend(runningCommand.cmd);
 
   if (m_pendingClusterRedirect) {
       return;
@@ -416,7 +525,12 @@ void RedisClient::AbstractTransporter::processClusterRedirect(
   m_connection->m_serverInfo = ServerInfo();
   m_connection->m_clusterSlots = Connection::ClusterSlots();
 
-  emit logEvent(QString("Cluster redirect to  %1:%2").arg(host).arg(port));
+  log(LogLevel::Info, LogRecord::Event::ClusterRedirect, 0, {host, port});
+
+  if (m_tracer->isEnabled()) {
+    m_tracer->addInstant(response.isMovedRedirect() ? "MOVED" : "ASK",
+                         QString("%1:%2").arg(host).arg(port));
+  }
 
   QTimer::singleShot(1, this, [this, host, port]() {        
     reconnectTo(host, port);
@@ -428,27 +542,30 @@ void RedisClient::AbstractTransporter::processClusterRedirect(
 
 void RedisClient::AbstractTransporter::reconnectTo(const QString &host,
                                                    int port) {
-  emit logEvent(QString("Reconnect to %1:%2").arg(host).arg(port));
+  log(LogLevel::Info, LogRecord::Event::Reconnect, 0, {host, port});
+
+  if (m_tracer->isEnabled()) {
+    m_tracer->addInstant("reconnect", QString("%1:%2").arg(host).arg(port));
+  }
 
   auto config = m_connection->getConfig();
   config.setHost(host);
   config.setPort(port);
   m_connection->setConnectionConfig(config);
 
+  m_stats->addReconnect();
   reconnect();
 }
 
 void RedisClient::AbstractTransporter::addSubscriptionsFromRunningCommand(
-    QSharedPointer<RunningCommand> runningCommand) {
-  Q_ASSERT(runningCommand);
-
-  if (!runningCommand->emitter) return;
+    const RunningCommand &runningCommand) {
+  if (!runningCommand.emitter.isValid()) return;
 
   QList<QByteArray> channels =
-      runningCommand->cmd.getSplitedRepresentattion().mid(1);
+      runningCommand.cmd.getSplitedRepresentattion().mid(1);
 
   for (QByteArray channel : channels) {
-    m_subscriptions.insert(channel, runningCommand->emitter);
+    m_subscriptions.insert(channel, runningCommand.emitter);
   }
 }
 
@@ -460,27 +577,54 @@ void RedisClient::AbstractTransporter::executionTimeout() {
 void RedisClient::AbstractTransporter::readyRead() {
   if (!canReadFromSocket()) return;
 
-  if (!m_parser.feedBuffer(readFromSocket())) {
+  qint64 readAt = ConnectionStats::now();
+  QByteArray data = readFromSocket();
+  m_stats->addBytesIn(data.size());
+
+  if (!m_parser.feedBuffer(data)) {
     // TODO: reset???!
     qDebug() << "Cannot feed parsing buffer";
     return;
   }
 
   QList<RedisClient::Response> responses;
+  QVector<ResponseTiming> timings;
   RedisClient::Response resp;
 
   do {
+    qint64 parseStartedAt = ConnectionStats::now();
     resp = m_parser.getNextResponse();
 
-    if (resp.isValid()) responses.append(resp);
+    if (resp.isValid()) {
+      qint64 parsedAt = ConnectionStats::now();
+      responses.append(resp);
+      timings.append(
+          ResponseTiming{readAt, parsedAt - parseStartedAt, parsedAt});
+    }
   } while (resp.isValid());
 
-  for (auto r : responses) {
+  // Responses for owners from other threads are delivered with one posted
+  // event per thread after the whole read is processed
+  m_batchResponses = true;
+
+  bool tracing = m_tracer->isEnabled();
+
+  for (int i = 0; i < responses.size(); ++i) {
     if (m_connection->m_stoppingTransporter) {
       break;
     }
-    sendResponse(r);
+    if (tracing) stampFirstByte(readAt);
+
+    m_responseTiming = timings.at(i);
+    sendResponse(responses.at(i));
   }
+
+  // Beginning of the next response is already in parser buffer
+  if (tracing && m_parser.hasUnusedBuffer()) stampFirstByte(readAt);
+
+  m_responseTiming = ResponseTiming();
+  m_batchResponses = false;
+  m_responseBatch.flush();
 }
 
 void RedisClient::AbstractTransporter::runCommand(
@@ -491,29 +635,47 @@ void RedisClient::AbstractTransporter::runCommand(
       return;
     }
     m_commands.prepend(command);
+    m_stats->addReconnect();
     reconnect();
     return;
   }
 
-  emit logEvent(QString("%1 > [runCommand] %2")
-                    .arg(m_connection->getConfig().name())
-                    .arg(printableString(command.getRawString())));
+  QSharedPointer<CommandStats> stats = commandStats(command);
 
-  // m_response.reset();
-  auto runningCommand =
-      QSharedPointer<RunningCommand>(new RunningCommand(command));
-  m_runningCommands.enqueue(runningCommand);
+  if (stats && command.enqueuedAt() > 0)
+    stats->queueWait.record(ConnectionStats::now() - command.enqueuedAt());
 
-  sendCommand(runningCommand->cmd.getByteRepresentation());
-}
+  RunningCommand &runningCommand = m_runningCommands.enqueue(command, stats);
+  runningCommand.id = ++m_lastCommandId;
+  updateQueueStats();
+
+  if (isLogEnabled(LogLevel::Debug)) {
+    LogRecord record(LogLevel::Debug, LogRecord::Event::CommandSent,
+                     runningCommand.id);
+    record.command = command.isAuthCommand()
+                         ? QList<QByteArray>{"AUTH", "*******"}
+                         : command.getSplitedRepresentattion();
+    emit logRecord(record);
+  }
+
+  QByteArray data = runningCommand.cmd.getByteRepresentation();
+  m_stats->addBytesOut(data.size());
+
+  // Write error cancels running commands, so record is not used after send
+  quint64 id = runningCommand.id;
+  QSharedPointer<CommandTiming> timing = runningCommand.cmd.getTiming();
+
+  sendCommand(data);
+
+  if (!timing && !m_tracer->isEnabled()) return;
+
+  if (m_runningCommands.isEmpty() || m_runningCommands.last().id != id) return;
+
+  RunningCommand &sent = m_runningCommands.last();
+  sent.writtenAt = ConnectionStats::now();
 
-RedisClient::AbstractTransporter::RunningCommand::RunningCommand(
-    const RedisClient::Command &cmd)
-    : cmd(cmd), emitter(nullptr), sentAt(QDateTime::currentMSecsSinceEpoch()) {
-  auto callback = cmd.getCallBack();
-  auto owner = cmd.getOwner();
-  if (callback && owner) {
-    emitter =
-        QSharedPointer<ResponseEmitter>(new ResponseEmitter(owner, callback));
+  if (timing) {
+    timing->writtenAt = sent.writtenAt;
+    timing->readAt = 0;
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QAtomicInt>
 #include <QObject>
 #include <QQueue>
 #include <QSharedPointer>
@@ -7,11 +8,16 @@
 #include <functional>
 
 #include "qredisclient/command.h"
+#include "qredisclient/logging.h"
+#include "qredisclient/private/responsebatch.h"
+#include "qredisclient/private/responseemmiter.h"
+#include "qredisclient/private/runningcommand.h"
 #include "qredisclient/responseparser.h"
+#include "qredisclient/stats.h"
+#include "qredisclient/tracer.h"
 
 namespace RedisClient {
 
-class ResponseEmitter;
 class Connection;
 
 /**
@@ -27,8 +33,18 @@ class AbstractTransporter : public QObject {
 
   virtual int pipelineCommandsLimit() const;
 
+  /**
+   * @brief Records with level above given one are not created.
+   * Can be called from any thread.
+   * @param level
+   */
+  void setLogLevel(LogLevel level);
+
  signals:
   void errorOccurred(const QString&);
+  void logRecord(const RedisClient::LogRecord&);
+
+  // Plain text messages, logged as LogRecord::Event::Message records
   void logEvent(const QString&);
   void connected();
   void commandAdded();
@@ -64,35 +80,64 @@ class AbstractTransporter : public QObject {
 
   virtual bool validateSystemProxy();
 
- protected:
-  class RunningCommand {
-   public:
-    RunningCommand(const Command& cmd);
-    Command cmd;
-    QSharedPointer<ResponseEmitter> emitter;
-    qint64 sentAt;
-  };
+  /**
+   * @brief false if level is filtered out or connection has no log
+   * listeners, so records are not even created
+   */
+  bool isLogEnabled(LogLevel level) const;
+
+  void log(LogLevel level, LogRecord::Event event, quint64 commandId = 0,
+           const QVariantList& args = QVariantList());
 
+ protected:
   void reAddRunningCommandToQueue();
 
  private:
-  void logResponse(const Response& response);
-  void processClusterRedirect(QSharedPointer<RunningCommand> runningCommand,
+  void logResponse(quint64 commandId, const Response& response);
+  void deliverResponse(const ResponseEmitter& emitter,
+                       const Response& response,
+                       const RunningCommand* runningCommand = nullptr);
+  void processClusterRedirect(const RunningCommand& runningCommand,
                               const Response& r);
   void addSubscriptionsFromRunningCommand(
-      QSharedPointer<RunningCommand> runningCommand);
+      const RunningCommand& runningCommand);
+  void updateQueueStats();
+  void stampFirstByte(qint64 readAt);
+  QSharedPointer<CommandStats> commandStats(const Command& cmd);
 
  protected:
   Connection* m_connection;
-  QQueue<QSharedPointer<RunningCommand>> m_runningCommands;
+  RunningCommandQueue m_runningCommands;
   QQueue<Command> m_commands;
   QQueue<Command> m_internalCommands;
-  typedef QHash<QByteArray, QSharedPointer<ResponseEmitter>> Subscriptions;
+  typedef QHash<QByteArray, ResponseEmitter> Subscriptions;
   Subscriptions m_subscriptions;
   bool m_reconnectEnabled;
   bool m_pendingClusterRedirect;
   bool m_connectionInitialized;
   ResponseParser m_parser;
   uint m_followedClusterRedirects;
+  ResponseBatch m_responseBatch;
+  bool m_batchResponses;
+  QSharedPointer<ConnectionStats> m_stats;
+  QSharedPointer<Tracer> m_tracer;
+
+  // Per-command stats are opt-in (see ConnectionConfig::commandStats()).
+  // Cache is keyed by raw command name and used only by transporter
+  // thread, so hot path doesn't take stats lock.
+  bool m_commandStatsEnabled;
+  QHash<QByteArray, QSharedPointer<CommandStats>> m_commandStatsCache;
+  quint32 m_commandStatsGeneration;
+
+  // Timing of the response passed to sendResponse(), all zeros if response
+  // wasn't received from socket
+  struct ResponseTiming {
+    qint64 readAt;
+    qint64 parseTime;
+    qint64 parsedAt;
+  };
+  ResponseTiming m_responseTiming;
+  QAtomicInt m_logLevel;
+  quint64 m_lastCommandId;
 };
 }  // namespace RedisClient
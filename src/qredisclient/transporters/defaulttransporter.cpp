@@ -36,7 +36,10 @@ void RedisClient::DefaultTransporter::initSocket() {
   connect(m_socket.data(), &QAbstractSocket::readyRead, this,
           &AbstractTransporter::readyRead);
   connect(m_socket.data(), &QSslSocket::encrypted, this,
-          [this]() { emit logEvent("SSL encryption: OK"); });
+          [this]() {
+            log(LogLevel::Info, LogRecord::Event::Message, 0,
+                {"SSL encryption: OK"});
+          });
   connect(m_socket.data(), &QAbstractSocket::disconnected, this, [this]() {
     if (m_runningCommands.size() > 0) {
       emit errorOccurred("Connection was interrupted");
@@ -133,13 +136,13 @@ bool RedisClient::DefaultTransporter::connectToHost() {
 
   if (connectionResult) {
     emit connected();
-    emit logEvent(QString("%1 > connected").arg(conf.name()));
+    log(LogLevel::Info, LogRecord::Event::Connected);
     return true;
   }
 
   if (!m_errorOccurred) emit errorOccurred("Connection timeout");
 
-  emit logEvent(QString("%1 > connection failed").arg(conf.name()));
+  log(LogLevel::Error, LogRecord::Event::ConnectionFailed);
   return false;
 }
 
@@ -179,7 +182,8 @@ void RedisClient::DefaultTransporter::sslError(const QList<QSslError> &errors) {
   if (errors.size() == 1 &&
       errors.first().error() == QSslError::HostNameMismatch) {
     m_socket->ignoreSslErrors();
-    emit logEvent("SSL: Ignore HostName Mismatch");
+    log(LogLevel::Warning, LogRecord::Event::Message, 0,
+        {"SSL: Ignore HostName Mismatch"});
     return;
   }
 
@@ -190,7 +194,8 @@ void RedisClient::DefaultTransporter::sslError(const QList<QSslError> &errors) {
 
   if (m_connection->getConfig().ignoreAllSslErrors()) {
       m_socket->ignoreSslErrors();
-      emit logEvent(QString("SSL: Ignoring SSL errors:\n %1").arg(allErrors));
+      log(LogLevel::Warning, LogRecord::Event::Message, 0,
+          {QString("SSL: Ignoring SSL errors:\n %1").arg(allErrors)});
       return;
   }
 
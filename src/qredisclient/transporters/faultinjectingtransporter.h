@@ -0,0 +1,296 @@
+#pragma once
+#include <QAtomicInteger>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTimer>
+#include <limits>
+#include <random>
+
+#include "qredisclient/stats.h"
+
+namespace RedisClient {
+
+class Connection;
+
+/**
+ * @brief The FaultConfig struct
+ * Faults injected by FaultInjectingTransporter. Delays are applied to the
+ * read path: received bytes are held back before they reach the parser.
+ */
+struct FaultConfig {
+  qint64 latency = 0;  // usec added to every received chunk
+  qint64 jitter = 0;   // usec, random extra delay in [0, jitter]
+  qint64 bandwidth = 0;  // received bytes per second, 0 - unlimited
+
+  int maxFragmentSize = 0;  // max bytes per read, 0 - unlimited
+  bool randomFragments = false;  // split reads at random size in [1, max]
+
+  int disconnectEvery = 0;  // drop connection after every N sent commands
+  double disconnectProbability = 0;  // chance to drop on each received chunk
+
+  // true: running commands are re-added to queue and sent again after
+  // reconnect, false: "Connection was interrupted" error is emitted and
+  // running commands are canceled
+  bool requeueOnDisconnect = true;
+
+  quint32 seed = 1;
+};
+
+/**
+ * @brief The FaultInjectingTransporter class
+ * Decorates any transporter and injects latency, jitter, bandwidth limit,
+ * fragmented reads and connection drops. Dropped connection is restored
+ * by regular reconnect logic of the transporter on the next command.
+ *
+ * Usage:
+ *   connection.setTransporter(QSharedPointer<AbstractTransporter>(
+ *       new FaultInjectingTransporter<DefaultTransporter>(&connection, faults)));
+ */
+template <class Base>
+class FaultInjectingTransporter : public Base {
+ public:
+  FaultInjectingTransporter(Connection* c,
+                            const FaultConfig& faults = FaultConfig())
+      : Base(c),
+        m_faults(faults),
+        m_random(faults.seed),
+        m_dropped(false),
+        m_readScheduled(false),
+        m_readEpoch(0),
+        m_lastReleaseAt(0),
+        m_tokens(0),
+        m_tokensAt(0),
+        m_sentCommands(0),
+        m_disconnects(0) {}
+
+  /**
+   * @brief Can be called from any thread
+   */
+  void setFaults(const FaultConfig& faults) {
+    QMutexLocker lock(&m_faultsLock);
+    m_faults = faults;
+  }
+
+  FaultConfig faults() const {
+    QMutexLocker lock(&m_faultsLock);
+    return m_faults;
+  }
+
+  /**
+   * @brief Drop connection as soon as possible. Can be called from any
+   * thread.
+   */
+  void injectDisconnect() {
+    QTimer::singleShot(0, this, [this]() { drop(); });
+  }
+
+  quint64 injectedDisconnects() const { return m_disconnects.loadAcquire(); }
+
+  void disconnectFromHost() override {
+    resetReads();
+    Base::disconnectFromHost();
+  }
+
+ protected:
+  bool isSocketReconnectRequired() const override {
+    return m_dropped || Base::isSocketReconnectRequired();
+  }
+
+  bool canReadFromSocket() override {
+    if (!this->isInitialized()) return false;
+
+    return Base::canReadFromSocket() || hasReleasedData();
+  }
+
+  QByteArray readFromSocket() override {
+    if (!this->isInitialized()) return QByteArray();
+
+    FaultConfig f = faults();
+    qint64 now = ConnectionStats::now();
+
+    if (Base::canReadFromSocket()) {
+      QByteArray data = Base::readFromSocket();
+
+      // Bytes of dropped connection never reach parser
+      if (!data.isEmpty() && !m_dropped) {
+        if (f.disconnectProbability > 0 &&
+            std::uniform_real_distribution<double>(0, 1)(m_random) <
+                f.disconnectProbability) {
+          drop();
+          return QByteArray();
+        }
+
+        qint64 delay = f.latency;
+
+        if (f.jitter > 0)
+          delay += std::uniform_int_distribution<qint64>(0, f.jitter)(m_random);
+
+        // Keep order of chunks
+        m_lastReleaseAt = qMax(m_lastReleaseAt, now + delay);
+        m_pending.append(Pending{m_lastReleaseAt, data});
+      }
+    }
+
+    int limit = readLimit(f, now);
+    QByteArray result;
+
+    while (!m_pending.isEmpty() && m_pending.first().releaseAt <= now &&
+           result.size() < limit) {
+      Pending& chunk = m_pending.first();
+      int size = qMin(chunk.data.size(), limit - result.size());
+
+      result.append(chunk.data.constData(), size);
+
+      if (size == chunk.data.size())
+        m_pending.removeFirst();
+      else
+        chunk.data.remove(0, size);
+    }
+
+    if (f.bandwidth > 0) m_tokens -= result.size();
+
+    scheduleRead(f, now);
+    return result;
+  }
+
+  bool connectToHost() override {
+    m_dropped = false;
+    resetReads();
+    return Base::connectToHost();
+  }
+
+  void sendCommand(const QByteArray& cmd) override {
+    Base::sendCommand(cmd);
+
+    int every = faults().disconnectEvery;
+
+    if (every > 0 && ++m_sentCommands % every == 0) injectDisconnect();
+  }
+
+ private:
+  struct Pending {
+    qint64 releaseAt;
+    QByteArray data;
+  };
+
+  bool hasReleasedData() const {
+    return !m_pending.isEmpty() &&
+           readWait(faults(), ConnectionStats::now()) == 0;
+  }
+
+  // Pending chunks and scheduled read of previous connection are dropped
+  void resetReads() {
+    m_pending.clear();
+    m_lastReleaseAt = 0;
+    m_readScheduled = false;
+    ++m_readEpoch;
+  }
+
+  double availableTokens(const FaultConfig& f, qint64 now) const {
+    // Token bucket with 10ms burst
+    double burst = qMax(1.0, f.bandwidth / 100.0);
+
+    if (m_tokensAt <= 0) return burst;
+
+    return qMin(burst,
+                m_tokens + f.bandwidth * (now - m_tokensAt) / 1000000.0);
+  }
+
+  /**
+   * @brief usec until first pending chunk is released and at least one
+   * byte of it can be read
+   */
+  qint64 readWait(const FaultConfig& f, qint64 now) const {
+    qint64 wait = qMax(qint64(0), m_pending.first().releaseAt - now);
+
+    if (f.bandwidth > 0) {
+      double tokens = availableTokens(f, now);
+
+      if (tokens < 1)
+        wait = qMax(wait, static_cast<qint64>((1 - tokens) * 1000000.0 /
+                                              f.bandwidth) + 1);
+    }
+
+    return wait;
+  }
+
+  int readLimit(const FaultConfig& f, qint64 now) {
+    qint64 limit = std::numeric_limits<int>::max();
+
+    if (f.maxFragmentSize > 0) {
+      limit = f.randomFragments ? std::uniform_int_distribution<int>(
+                                      1, f.maxFragmentSize)(m_random)
+                                : f.maxFragmentSize;
+    }
+
+    if (f.bandwidth > 0) {
+      m_tokens = availableTokens(f, now);
+      m_tokensAt = now;
+      limit = qMin(limit, static_cast<qint64>(m_tokens));
+    }
+
+    return static_cast<int>(limit);
+  }
+
+  void scheduleRead(const FaultConfig& f, qint64 now) {
+    if (m_pending.isEmpty() || m_readScheduled) return;
+
+    qint64 wait = readWait(f, now);
+    int epoch = m_readEpoch;
+
+    m_readScheduled = true;
+
+    QTimer::singleShot(static_cast<int>((wait + 999) / 1000), this,
+                       [this, epoch]() {
+                         if (epoch != m_readEpoch) return;
+
+                         m_readScheduled = false;
+
+                         // Timer can fire before bandwidth tokens are
+                         // refilled, empty read is not passed to parser
+                         if (!hasReleasedData()) {
+                           scheduleRead(faults(), ConnectionStats::now());
+                           return;
+                         }
+
+                         this->readyRead();
+                       });
+  }
+
+  void drop() {
+    if (m_dropped) return;
+
+    m_dropped = true;
+    resetReads();
+    m_disconnects.fetchAndAddRelaxed(1);
+
+    // Partial response of dropped connection
+    this->m_parser.reset();
+
+    if (this->m_runningCommands.size() == 0) return;
+
+    if (faults().requeueOnDisconnect) {
+      this->reAddRunningCommandToQueue();
+      this->processCommandQueue();
+    } else {
+      emit this->errorOccurred("Connection was interrupted");
+    }
+  }
+
+ private:
+  mutable QMutex m_faultsLock;
+  FaultConfig m_faults;
+  std::mt19937 m_random;
+  bool m_dropped;
+  bool m_readScheduled;
+  int m_readEpoch;
+  QList<Pending> m_pending;
+  qint64 m_lastReleaseAt;
+  double m_tokens;
+  qint64 m_tokensAt;
+  int m_sentCommands;
+  QAtomicInteger<quint64> m_disconnects;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,57 @@
+#pragma once
+#include <QSharedPointer>
+
+#include "qredisclient/connection.h"
+#include "qredisclient/connectionconfig.h"
+#include "trafficrecorder.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The RecordingTransporter class
+ * Decorates any transporter and records outgoing commands and raw incoming
+ * bytes with TrafficRecorder. Recording can be replayed by
+ * ReplayTransporter.
+ *
+ * Usage:
+ *   connection.setTransporter(QSharedPointer<AbstractTransporter>(
+ *       new RecordingTransporter<DefaultTransporter>(&connection, recorder)));
+ */
+template <class Base>
+class RecordingTransporter : public Base {
+ public:
+  RecordingTransporter(Connection* c,
+                       QSharedPointer<TrafficRecorder> recorder)
+      : Base(c), m_recorder(recorder) {}
+
+  ~RecordingTransporter() override {
+    if (m_recorder) m_recorder->record(TrafficChunk::Type::Disconnect);
+  }
+
+ protected:
+  bool connectToHost() override {
+    auto config = this->m_connection->getConfig();
+
+    m_recorder->record(
+        TrafficChunk::Type::Connect,
+        QString("%1:%2").arg(config.host()).arg(config.port()).toUtf8());
+
+    return Base::connectToHost();
+  }
+
+  QByteArray readFromSocket() override {
+    QByteArray data = Base::readFromSocket();
+    m_recorder->record(TrafficChunk::Type::In, data);
+    return data;
+  }
+
+  void sendCommand(const QByteArray& cmd) override {
+    m_recorder->record(TrafficChunk::Type::Out, cmd);
+    Base::sendCommand(cmd);
+  }
+
+ private:
+  QSharedPointer<TrafficRecorder> m_recorder;
+};
+
+}  // namespace RedisClient
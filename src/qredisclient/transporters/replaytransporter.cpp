@@ -0,0 +1,143 @@
+#include "replaytransporter.h"
+
+#include "qredisclient/connection.h"
+
+RedisClient::ReplayTransporter::ReplayTransporter(
+    RedisClient::Connection *c, const QVector<TrafficChunk> &recording,
+    Speed speed)
+    : RedisClient::AbstractTransporter(c),
+      m_speed(speed),
+      m_next(0),
+      m_lastFedAt(0),
+      m_initialized(false),
+      m_feedTimer(new QTimer(this)),
+      m_mismatches(0),
+      m_finished(0) {
+  qint64 lastOutAt = 0;
+  qint64 lastInAt = 0;
+
+  for (const TrafficChunk &chunk : recording) {
+    if (chunk.type == TrafficChunk::Type::Out) {
+      m_outgoing.append(chunk.data);
+      lastOutAt = chunk.timestamp;
+    } else if (chunk.type == TrafficChunk::Type::In && !chunk.data.isEmpty()) {
+      qint64 anchor = qMax(lastOutAt, lastInAt);
+      m_incoming.append(
+          IncomingChunk{chunk.data, m_outgoing.size(), chunk.timestamp - anchor});
+      lastInAt = chunk.timestamp;
+    }
+  }
+
+  m_feedTimer->setSingleShot(true);
+  m_feedTimer->setTimerType(Qt::PreciseTimer);
+  connect(m_feedTimer, &QTimer::timeout, this,
+          &ReplayTransporter::feedNextChunk);
+
+  if (m_incoming.isEmpty()) m_finished.store(1);
+}
+
+int RedisClient::ReplayTransporter::mismatchedCommands() const {
+  return m_mismatches.load();
+}
+
+bool RedisClient::ReplayTransporter::isFinished() const {
+  return m_finished.load() != 0;
+}
+
+void RedisClient::ReplayTransporter::disconnectFromHost() {
+  AbstractTransporter::disconnectFromHost();
+
+  m_initialized = false;
+  m_feedTimer->stop();
+  m_pending.clear();
+}
+
+bool RedisClient::ReplayTransporter::isInitialized() const {
+  return m_initialized;
+}
+
+bool RedisClient::ReplayTransporter::isSocketReconnectRequired() const {
+  return false;
+}
+
+bool RedisClient::ReplayTransporter::canReadFromSocket() {
+  return !m_pending.isEmpty();
+}
+
+QByteArray RedisClient::ReplayTransporter::readFromSocket() {
+  QByteArray data = m_pending;
+  m_pending.clear();
+  return data;
+}
+
+void RedisClient::ReplayTransporter::initSocket() {}
+
+bool RedisClient::ReplayTransporter::connectToHost() {
+  m_initialized = true;
+
+  emit connected();
+  log(LogLevel::Info, LogRecord::Event::Connected);
+
+  scheduleNextChunk();
+  return true;
+}
+
+void RedisClient::ReplayTransporter::sendCommand(const QByteArray &cmd) {
+  int index = m_sentAt.size();
+
+  if (index >= m_outgoing.size() || m_outgoing.at(index) != cmd)
+    m_mismatches.fetchAndAddRelaxed(1);
+
+  m_sentAt.append(ConnectionStats::now());
+
+  if (!m_feedTimer->isActive()) scheduleNextChunk();
+}
+
+void RedisClient::ReplayTransporter::reconnect() {
+  if (connectToHost()) {
+    resetDbIndex();
+  }
+}
+
+void RedisClient::ReplayTransporter::feedNextChunk() {
+  if (m_next >= m_incoming.size()) return;
+
+  m_pending = m_incoming.at(m_next++).data;
+  m_lastFedAt = ConnectionStats::now();
+
+  readyRead();
+
+  if (m_next >= m_incoming.size()) {
+    m_finished.store(1);
+    emit replayFinished();
+    return;
+  }
+
+  scheduleNextChunk();
+}
+
+void RedisClient::ReplayTransporter::scheduleNextChunk() {
+  if (!m_initialized || m_next >= m_incoming.size() ||
+      m_feedTimer->isActive())
+    return;
+
+  const IncomingChunk &chunk = m_incoming.at(m_next);
+
+  // Wait for commands which were sent before this chunk
+  if (chunk.sentBefore > m_sentAt.size()) return;
+
+  qint64 delay = 0;
+
+  if (m_speed == Speed::Recorded) {
+    qint64 anchor = m_lastFedAt;
+
+    if (chunk.sentBefore > 0)
+      anchor = qMax(anchor, m_sentAt.at(chunk.sentBefore - 1));
+
+    delay = qMax(qint64(0), anchor + chunk.gap - ConnectionStats::now());
+  }
+
+  // Always go through event loop: sendCommand() is called in the middle of
+  // runCommand()
+  m_feedTimer->start(static_cast<int>(delay / 1000));
+}
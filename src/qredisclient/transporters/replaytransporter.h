@@ -0,0 +1,87 @@
+#pragma once
+#include <QAtomicInt>
+#include <QTimer>
+#include <QVector>
+
+#include "abstracttransporter.h"
+#include "trafficrecorder.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The ReplayTransporter class
+ * Feeds recorded incoming bytes through AbstractTransporter::readyRead()
+ * without network. Each incoming chunk is delivered only after client has
+ * sent as many commands as were sent before it during recording, so
+ * responses always have matching running commands.
+ *
+ * Speed::Recorded keeps recorded gaps between sent commands and incoming
+ * chunks, Speed::Maximum feeds chunks as soon as possible (for parser and
+ * dispatch benchmarks). Sent commands are compared with recorded ones,
+ * see mismatchedCommands().
+ */
+class ReplayTransporter : public AbstractTransporter {
+  Q_OBJECT
+ public:
+  enum class Speed { Recorded, Maximum };
+
+  ReplayTransporter(Connection* c, const QVector<TrafficChunk>& recording,
+                    Speed speed = Speed::Maximum);
+
+  /**
+   * @brief Number of sent commands which differ from recorded ones.
+   * Can be called from any thread.
+   */
+  int mismatchedCommands() const;
+
+  /**
+   * @brief All recorded incoming chunks were delivered.
+   * Can be called from any thread.
+   */
+  bool isFinished() const;
+
+ signals:
+  void replayFinished();
+
+ public slots:
+  void disconnectFromHost() override;
+
+ protected:
+  bool isInitialized() const override;
+  bool isSocketReconnectRequired() const override;
+  bool canReadFromSocket() override;
+  QByteArray readFromSocket() override;
+  void initSocket() override;
+  bool connectToHost() override;
+  void sendCommand(const QByteArray& cmd) override;
+
+ protected slots:
+  void reconnect() override;
+
+ private slots:
+  void feedNextChunk();
+
+ private:
+  void scheduleNextChunk();
+
+ private:
+  struct IncomingChunk {
+    QByteArray data;
+    int sentBefore;  // commands sent before this chunk during recording
+    qint64 gap;      // usec after last sent command or previous chunk
+  };
+
+  Speed m_speed;
+  QVector<IncomingChunk> m_incoming;
+  QVector<QByteArray> m_outgoing;
+  QVector<qint64> m_sentAt;
+  int m_next;
+  qint64 m_lastFedAt;
+  QByteArray m_pending;
+  bool m_initialized;
+  QTimer* m_feedTimer;
+  QAtomicInt m_mismatches;
+  QAtomicInt m_finished;
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,148 @@
+#include "trafficrecorder.h"
+
+#include <QMutexLocker>
+
+#include "qredisclient/stats.h"
+
+#define RECORDING_MAGIC "QRTR"
+#define RECORDING_VERSION 1
+
+namespace {
+
+void appendVarint(QByteArray& out, quint64 value) {
+  do {
+    char byte = static_cast<char>(value & 0x7f);
+    value >>= 7;
+    if (value) byte |= 0x80;
+    out.append(byte);
+  } while (value);
+}
+
+bool readVarint(const QByteArray& in, int& pos, quint64& value) {
+  value = 0;
+
+  for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+    quint8 byte = static_cast<quint8>(in.at(pos++));
+    value |= static_cast<quint64>(byte & 0x7f) << shift;
+
+    if (!(byte & 0x80)) return true;
+  }
+
+  return false;
+}
+
+}  // namespace
+
+RedisClient::TrafficRecorder::TrafficRecorder(const QString& path)
+    : m_file(new QFile(path)),
+      m_device(m_file.data()),
+      m_startedAt(ConnectionStats::now()),
+      m_lastAt(m_startedAt) {
+  if (m_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) writeHeader();
+}
+
+RedisClient::TrafficRecorder::TrafficRecorder(QIODevice* device)
+    : m_device(device),
+      m_startedAt(ConnectionStats::now()),
+      m_lastAt(m_startedAt) {
+  if (isOpen()) writeHeader();
+}
+
+RedisClient::TrafficRecorder::~TrafficRecorder() { flush(); }
+
+bool RedisClient::TrafficRecorder::isOpen() const {
+  return m_device && m_device->isOpen() && m_device->isWritable();
+}
+
+void RedisClient::TrafficRecorder::record(TrafficChunk::Type type,
+                                          const QByteArray& data) {
+  QMutexLocker lock(&m_lock);
+
+  if (!isOpen()) return;
+
+  qint64 now = ConnectionStats::now();
+
+  QByteArray header;
+  header.reserve(16);
+  header.append(static_cast<char>(type));
+  appendVarint(header, static_cast<quint64>(qMax(now - m_lastAt, qint64(0))));
+  appendVarint(header, static_cast<quint64>(data.size()));
+
+  m_device->write(header);
+  m_device->write(data);
+  m_lastAt = now;
+
+  if (type == TrafficChunk::Type::Disconnect && m_file) m_file->flush();
+}
+
+void RedisClient::TrafficRecorder::flush() {
+  QMutexLocker lock(&m_lock);
+
+  if (m_file && m_file->isOpen()) m_file->flush();
+}
+
+void RedisClient::TrafficRecorder::writeHeader() {
+  QByteArray header(RECORDING_MAGIC);
+  header.append(static_cast<char>(RECORDING_VERSION));
+  m_device->write(header);
+}
+
+bool RedisClient::TrafficRecorder::load(QIODevice* device,
+                                        QVector<TrafficChunk>* chunks,
+                                        QString* error) {
+  auto fail = [error](const QString& msg) {
+    if (error) *error = msg;
+    return false;
+  };
+
+  if (!device || !device->isReadable()) return fail("Device is not readable");
+
+  QByteArray data = device->readAll();
+
+  if (!data.startsWith(RECORDING_MAGIC) || data.size() < 5)
+    return fail("Not a traffic recording");
+
+  if (data.at(4) != RECORDING_VERSION)
+    return fail(QString("Unsupported recording version %1")
+                    .arg(static_cast<int>(data.at(4))));
+
+  int pos = 5;
+  qint64 timestamp = 0;
+
+  chunks->clear();
+
+  while (pos < data.size()) {
+    quint8 type = static_cast<quint8>(data.at(pos++));
+    quint64 delta = 0, size = 0;
+
+    if (type < static_cast<quint8>(TrafficChunk::Type::Connect) ||
+        type > static_cast<quint8>(TrafficChunk::Type::Disconnect))
+      return fail(QString("Invalid chunk type at %1").arg(pos - 1));
+
+    if (!readVarint(data, pos, delta) || !readVarint(data, pos, size) ||
+        size > static_cast<quint64>(data.size() - pos))
+      return fail(QString("Truncated chunk at %1").arg(pos));
+
+    timestamp += static_cast<qint64>(delta);
+
+    chunks->append(TrafficChunk{static_cast<TrafficChunk::Type>(type),
+                                timestamp,
+                                data.mid(pos, static_cast<int>(size))});
+    pos += static_cast<int>(size);
+  }
+
+  return true;
+}
+
+bool RedisClient::TrafficRecorder::load(const QString& path,
+                                        QVector<TrafficChunk>* chunks,
+                                        QString* error) {
+  QFile file(path);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (error) *error = file.errorString();
+    return false;
+  }
+
+  return load(&file, chunks, error);
+}
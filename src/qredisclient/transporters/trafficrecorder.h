@@ -0,0 +1,66 @@
+#pragma once
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+
+namespace RedisClient {
+
+/**
+ * @brief The TrafficChunk struct
+ * Single piece of recorded traffic: bytes passed to sendCommand(), bytes
+ * returned by readFromSocket() or connection marker.
+ */
+struct TrafficChunk {
+  enum class Type : quint8 { Connect = 1, Out, In, Disconnect };
+
+  Type type;
+  qint64 timestamp;  // usec since start of the recording
+  QByteArray data;   // Connect: "host:port"
+};
+
+/**
+ * @brief The TrafficRecorder class
+ * Writes transporter traffic to compact binary file:
+ *   "QRTR", version (1 byte), then chunks:
+ *   type (1 byte), timestamp delta in usec (varint), size (varint), data
+ * Can be shared between transporters, all methods are thread-safe.
+ * See RecordingTransporter and ReplayTransporter.
+ */
+class TrafficRecorder {
+ public:
+  explicit TrafficRecorder(const QString& path);
+
+  /**
+   * @brief Record to already opened device, device is not owned
+   */
+  explicit TrafficRecorder(QIODevice* device);
+  ~TrafficRecorder();
+
+  bool isOpen() const;
+
+  void record(TrafficChunk::Type type, const QByteArray& data = QByteArray());
+  void flush();
+
+  static bool load(QIODevice* device, QVector<TrafficChunk>* chunks,
+                   QString* error = nullptr);
+  static bool load(const QString& path, QVector<TrafficChunk>* chunks,
+                   QString* error = nullptr);
+
+ private:
+  void writeHeader();
+
+ private:
+  Q_DISABLE_COPY(TrafficRecorder)
+
+  QScopedPointer<QFile> m_file;
+  QIODevice* m_device;
+  mutable QMutex m_lock;
+  qint64 m_startedAt;
+  qint64 m_lastAt;
+};
+
+}  // namespace RedisClient
@@ -1,6 +1,8 @@
 #include "sync.h"
 #include "qredisclient/command.h"
 
+#include <QElapsedTimer>
+
 RedisClient::SignalWaiter::SignalWaiter(uint timeout)
     : m_result(false), m_resultReceived(false) {
   m_timeoutTimer.setSingleShot(true);
@@ -36,3 +38,56 @@ void RedisClient::SignalWaiter::success() {
   m_loop.quit();
   emit succeed();
 }
+
+RedisClient::ResponseWaiter::ResponseWaiter() : m_state(new State()) {
+  m_state->finished = false;
+}
+
+std::function<void(RedisClient::Response, QString)>
+RedisClient::ResponseWaiter::callback() const {
+  QSharedPointer<State> state = m_state;
+
+  return [state](RedisClient::Response r, QString err) {
+    QMutexLocker lock(&state->lock);
+    state->response = r;
+    state->error = err;
+    state->finished = true;
+    state->done.wakeAll();
+  };
+}
+
+void RedisClient::ResponseWaiter::fail(const QString &error) const {
+  QMutexLocker lock(&m_state->lock);
+
+  if (m_state->finished) return;
+
+  m_state->error = error;
+  m_state->finished = true;
+  m_state->done.wakeAll();
+}
+
+bool RedisClient::ResponseWaiter::wait(uint timeout) {
+  QMutexLocker lock(&m_state->lock);
+  QElapsedTimer timer;
+  timer.start();
+
+  while (!m_state->finished) {
+    qint64 remaining = static_cast<qint64>(timeout) - timer.elapsed();
+
+    if (remaining <= 0) return false;
+
+    m_state->done.wait(&m_state->lock, static_cast<unsigned long>(remaining));
+  }
+
+  return true;
+}
+
+RedisClient::Response RedisClient::ResponseWaiter::response() const {
+  QMutexLocker lock(&m_state->lock);
+  return m_state->response;
+}
+
+QString RedisClient::ResponseWaiter::error() const {
+  QMutexLocker lock(&m_state->lock);
+  return m_state->error;
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include <QEventLoop>
+#include <QMutex>
 #include <QObject>
+#include <QSharedPointer>
 #include <QTimer>
+#include <QWaitCondition>
 
 #include <asyncfuture.h>
 #include <qredisclient/response.h>
@@ -51,4 +54,44 @@ class SignalWaiter : public QObject {
   bool m_result;
 };
 
+/**
+ * @brief The ResponseWaiter class
+ * Blocks calling thread on wait condition until callback() is called
+ * from other thread. Doesn't spin event loop, so callback() should be used
+ * as inline command callback (see Command::setInlineCallback()).
+ */
+class ResponseWaiter {
+ public:
+  ResponseWaiter();
+
+  std::function<void(Response, QString)> callback() const;
+
+  /**
+   * @brief Wake up waiting thread with error unless response is already
+   * received. Can be called from any thread.
+   */
+  void fail(const QString &error) const;
+
+  /**
+   * @brief wait
+   * @param timeout - in milliseconds
+   * @return false if deadline is reached before response
+   */
+  bool wait(uint timeout);
+
+  Response response() const;
+  QString error() const;
+
+ private:
+  struct State {
+    QMutex lock;
+    QWaitCondition done;
+    bool finished;
+    Response response;
+    QString error;
+  };
+
+  QSharedPointer<State> m_state;
+};
+
 }  // namespace RedisClient
@@ -1,11 +1,93 @@
 #include "text.h"
 #include <functional>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QREDISCLIENT_TEXT_SSE2
+#endif
+
+namespace {
+
+enum AsciiClass {
+  PrintableAscii,  // can be returned as is
+  ControlChars,    // has control chars, not printable in any encoding
+  NonAscii         // needs full unicode classification
+};
+
+// Same as QChar::isPrint() / QChar::isSpace() checks below for ASCII:
+// printable 0x20-0x7E, whitespace 0x09-0x0D is allowed in non-strict mode
+inline bool isAllowedAscii(unsigned char c, bool strict) {
+  return (c >= 0x20 && c < 0x7F) || (!strict && c >= 0x09 && c <= 0x0D);
+}
+
+AsciiClass classifyAscii(const QByteArray &raw, bool strict) {
+  const char *data = raw.constData();
+  const int size = raw.size();
+  bool nonAscii = false;
+  int i = 0;
+
+#ifdef QREDISCLIENT_TEXT_SSE2
+  const __m128i lowPrintable = _mm_set1_epi8(0x1F);
+  const __m128i highPrintable = _mm_set1_epi8(0x7F);
+  const __m128i lowSpace = _mm_set1_epi8(0x08);
+  const __m128i highSpace = _mm_set1_epi8(0x0E);
+
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+    // Bytes >= 0x80 are negative in signed compares below and never allowed
+    int highBits = _mm_movemask_epi8(v);
+
+    __m128i allowed = _mm_and_si128(_mm_cmpgt_epi8(v, lowPrintable),
+                                    _mm_cmplt_epi8(v, highPrintable));
+    if (!strict) {
+      allowed = _mm_or_si128(allowed,
+                             _mm_and_si128(_mm_cmpgt_epi8(v, lowSpace),
+                                           _mm_cmplt_epi8(v, highSpace)));
+    }
+
+    int allowedBits = _mm_movemask_epi8(allowed);
+
+    if ((allowedBits | highBits) != 0xFFFF) return ControlChars;
+    if (highBits) nonAscii = true;
+  }
+#endif
+
+  for (; i < size; ++i) {
+    unsigned char c = static_cast<unsigned char>(data[i]);
+
+    if (c >= 0x80)
+      nonAscii = true;
+    else if (!isAllowedAscii(c, strict))
+      return ControlChars;
+  }
+
+  return nonAscii ? NonAscii : PrintableAscii;
+}
+
+QTextCodec *utf8Codec() {
+  static QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+  return codec;
+}
+
+}  // namespace
+
 bool byteArrayToValidUnicode(const QByteArray &raw, QString *result = nullptr,
                              bool strict = false) {
+  switch (classifyAscii(raw, strict)) {
+    case ControlChars:
+      return false;
+    case PrintableAscii:
+      if (result) *result = QString::fromLatin1(raw.constData(), raw.size());
+      return true;
+    case NonAscii:
+      break;
+  }
+
   QTextCodec::ConverterState state;
-  QTextCodec *codec = QTextCodec::codecForName("UTF-8");
-  const QString text = codec->toUnicode(raw.constData(), raw.size(), &state);
+  const QString text =
+      utf8Codec()->toUnicode(raw.constData(), raw.size(), &state);
 
   if (state.invalidChars == 0) {
     foreach (QChar c, text) {
@@ -28,28 +110,38 @@ QString printableString(const QByteArray &raw, bool strictChecks) {
 
   if (byteArrayToValidUnicode(raw, &text, strictChecks)) return text;
 
-  QByteArray escapedBinaryString;
   char const hex[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
                         '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
+  // Worst case: every byte is escaped as \xHH
+  QByteArray escapedBinaryString(raw.size() * 4, Qt::Uninitialized);
+  char *out = escapedBinaryString.data();
   bool printableChar = false;
 
-  foreach (char i, raw) {
-    if (strictChecks) {
-      printableChar =
-          isprint((unsigned char)i) && (!isspace((unsigned char)i) || i == ' ');
+  for (char i : raw) {
+    unsigned char c = static_cast<unsigned char>(i);
+
+    if (c < 0x80) {
+      printableChar = c >= 0x20 && c < 0x7F;
+    } else if (strictChecks) {
+      // locale dependent for non-ASCII bytes
+      printableChar = isprint(c) && !isspace(c);
     } else {
-      printableChar = isprint((unsigned char)i);
+      printableChar = isprint(c);
     }
 
     if (printableChar) {
-      escapedBinaryString.append(i);
+      *out++ = i;
     } else {
-      escapedBinaryString.append("\\x");
-      escapedBinaryString.append(&hex[(i & 0xF0) >> 4], 1);
-      escapedBinaryString.append(&hex[i & 0xF], 1);
+      *out++ = '\\';
+      *out++ = 'x';
+      *out++ = hex[(c & 0xF0) >> 4];
+      *out++ = hex[c & 0xF];
     }
   }
+
+  escapedBinaryString.resize(
+      static_cast<int>(out - escapedBinaryString.constData()));
   return escapedBinaryString;
 }
 
@@ -0,0 +1,83 @@
+#include "valuecollection.h"
+
+RedisClient::ValueCollection::ValueCollection(Type type) : m_type(type) {}
+
+RedisClient::ValueCollection::Type RedisClient::ValueCollection::typeOf(
+    const ScanCommand& cmd) {
+  QByteArray name = cmd.getPartAsString(0).toLower().toLatin1();
+
+  if (name == "hscan") return Type::Hash;
+  if (name == "zscan") return Type::SortedSet;
+
+  return Type::Set;
+}
+
+void RedisClient::ValueCollection::append(const QVariantList& collection) {
+  if (m_type == Type::Set) {
+    m_members.append(collection);
+    return;
+  }
+
+  for (int i = 0; i + 1 < collection.size(); i += 2) {
+    m_members.append(collection.at(i).toByteArray());
+
+    if (m_type == Type::Hash)
+      m_values.append(collection.at(i + 1).toByteArray());
+    else
+      m_scores.append(collection.at(i + 1).toByteArray().toDouble());
+  }
+}
+
+void RedisClient::ValueCollection::reserve(int rows, int bytes) {
+  m_members.reserve(rows, bytes);
+
+  if (m_type == Type::Hash) m_values.reserve(rows, bytes);
+  if (m_type == Type::SortedSet) m_scores.reserve(rows);
+}
+
+void RedisClient::ValueCollection::squeeze() {
+  m_members.squeeze();
+  m_values.squeeze();
+  m_scores.squeeze();
+}
+
+void RedisClient::ValueCollection::clear() {
+  m_members.clear();
+  m_values.clear();
+  m_scores.clear();
+}
+
+int RedisClient::ValueCollection::pageCount(int pageSize) const {
+  if (pageSize <= 0) return 0;
+
+  return (size() + pageSize - 1) / pageSize;
+}
+
+QVariantList RedisClient::ValueCollection::page(int page, int pageSize) const {
+  QVariantList result;
+
+  if (page < 0 || pageSize <= 0) return result;
+
+  qint64 first = qint64(page) * pageSize;
+  int last = static_cast<int>(qMin<qint64>(first + pageSize, size()));
+
+  if (first >= last) return result;
+
+  result.reserve((last - first) * (m_type == Type::Set ? 1 : 2));
+
+  for (int i = static_cast<int>(first); i < last; ++i) {
+    result.append(m_members.at(i));
+
+    if (m_type == Type::Hash)
+      result.append(m_values.at(i));
+    else if (m_type == Type::SortedSet)
+      result.append(m_scores.at(i));
+  }
+
+  return result;
+}
+
+qint64 RedisClient::ValueCollection::memoryUsage() const {
+  return m_members.memoryUsage() + m_values.memoryUsage() +
+         m_scores.capacity() * qint64(sizeof(double));
+}
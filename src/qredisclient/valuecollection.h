@@ -0,0 +1,75 @@
+#pragma once
+#include <QByteArray>
+#include <QVariantList>
+#include <QVector>
+
+#include "packedkeylist.h"
+#include "scancommand.h"
+
+namespace RedisClient {
+
+/**
+ * @brief The ValueCollection class
+ * Typed result of HSCAN/ZSCAN/SSCAN stored in columns instead of
+ * interleaved QVariantList: members (fields of hash) and hash values are
+ * kept in PackedKeyList arenas, zset scores in array of double. Rows are
+ * converted to QVariant only for requested page, see page().
+ *
+ * Implicitly shared, like Qt containers.
+ */
+class ValueCollection {
+ public:
+  enum class Type { Set, Hash, SortedSet };
+
+  explicit ValueCollection(Type type = Type::Set);
+
+  /**
+   * @brief Type of collection returned by value scan command
+   */
+  static Type typeOf(const ScanCommand& cmd);
+
+  Type type() const { return m_type; }
+
+  /**
+   * @brief Append elements of SCAN round: members for SSCAN,
+   * field/value pairs for HSCAN, member/score pairs for ZSCAN
+   */
+  void append(const QVariantList& collection);
+
+  void reserve(int rows, int bytes);
+  void squeeze();
+  void clear();
+
+  int size() const { return m_members.size(); }
+  bool isEmpty() const { return size() == 0; }
+
+  QByteArray member(int i) const { return m_members.at(i); }
+  QByteArray value(int i) const { return m_values.at(i); }
+  double score(int i) const { return m_scores.at(i); }
+
+  const PackedKeyList& members() const { return m_members; }
+  const PackedKeyList& values() const { return m_values; }
+  const QVector<double>& scores() const { return m_scores; }
+
+  int pageCount(int pageSize) const;
+
+  /**
+   * @brief Rows of page in format of Connection::retrieveCollection():
+   * member for set, field and value for hash, member and score (double)
+   * for sorted set
+   */
+  QVariantList page(int page, int pageSize) const;
+
+  /**
+   * @brief Approximate memory used by collection
+   */
+  qint64 memoryUsage() const;
+
+ private:
+  Type m_type;
+  PackedKeyList m_members;
+  PackedKeyList m_values;   // Hash only
+  QVector<double> m_scores;  // SortedSet only
+};
+
+}  // namespace RedisClient
@@ -0,0 +1,87 @@
+#include "bench_command.h"
+#include "corpora.h"
+#include "qredisclient/command.h"
+
+#include <QTest>
+
+using namespace RedisClient;
+
+void BenchCommand::getByteRepresentation_data() {
+  QTest::addColumn<QByteArrayList>("args");
+  QTest::addColumn<int>("pipelineSize");
+
+  QTest::newRow("PING") << QByteArrayList{"PING"} << 0;
+  QTest::newRow("SET 16b") << QByteArrayList{"SET", Corpora::key(1),
+                                             Corpora::asciiValue(16)}
+                           << 0;
+  QTest::newRow("SET 4kb") << QByteArrayList{"SET", Corpora::key(1),
+                                             Corpora::binaryValue(4096)}
+                           << 0;
+
+  QByteArrayList hset{"HSET", Corpora::key(1)};
+  for (int i = 0; i < 100; ++i) {
+    hset << Corpora::key(i) << Corpora::asciiValue(32);
+  }
+  QTest::newRow("HSET 100 fields") << hset << 0;
+
+  QTest::newRow("pipeline 100 SET")
+      << QByteArrayList{"SET", Corpora::key(1), Corpora::asciiValue(16)}
+      << 100;
+}
+
+void BenchCommand::getByteRepresentation() {
+  QFETCH(QByteArrayList, args);
+  QFETCH(int, pipelineSize);
+
+  Command cmd;
+
+  if (pipelineSize > 0) {
+    for (int i = 0; i < pipelineSize; ++i) cmd.addToPipeline(args);
+  } else {
+    cmd = Command(args);
+  }
+
+  QByteArray result;
+
+  QBENCHMARK { result = cmd.getByteRepresentation(); }
+
+  QVERIFY(result.size() > 0);
+}
+
+void BenchCommand::getKeyName_data() {
+  QTest::addColumn<QByteArrayList>("args");
+
+  QTest::newRow("GET") << QByteArrayList{"GET", Corpora::key(1)};
+  QTest::newRow("BITOP") << QByteArrayList{"BITOP", "AND", Corpora::key(1),
+                                           Corpora::key(2)};
+  QTest::newRow("lowercase hset")
+      << QByteArrayList{"hset", Corpora::key(1), "field", "value"};
+  QTest::newRow("keyless") << QByteArrayList{"INFO", "all"};
+}
+
+void BenchCommand::getKeyName() {
+  QFETCH(QByteArrayList, args);
+
+  Command cmd(args);
+  QByteArray result;
+
+  QBENCHMARK { result = cmd.getKeyName(); }
+}
+
+void BenchCommand::calcKeyHashSlot_data() {
+  QTest::addColumn<QByteArray>("key");
+
+  QTest::newRow("short") << Corpora::key(1);
+  QTest::newRow("hash tag") << QByteArray("{user:1000}:profile:settings");
+  QTest::newRow("1kb") << Corpora::asciiValue(1024);
+}
+
+void BenchCommand::calcKeyHashSlot() {
+  QFETCH(QByteArray, key);
+
+  quint16 slot = 0;
+
+  QBENCHMARK { slot = Command::calcKeyHashSlot(key); }
+
+  QVERIFY(slot < 16384);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+class BenchCommand : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void getByteRepresentation_data();
+  void getByteRepresentation();
+
+  void getKeyName_data();
+  void getKeyName();
+
+  void calcKeyHashSlot_data();
+  void calcKeyHashSlot();
+};
@@ -0,0 +1,129 @@
+#include "bench_response.h"
+#include "corpora.h"
+#include "qredisclient/connection.h"
+#include "qredisclient/response.h"
+#include "qredisclient/responseparser.h"
+
+#include <QTest>
+
+using namespace RedisClient;
+
+namespace {
+
+// Typical TCP segment payload
+const int SEGMENT_SIZE = 1460;
+
+int parseAll(const QByteArray &corpus, int chunkSize) {
+  ResponseParser parser;
+  int parsed = 0;
+
+  for (int pos = 0; pos < corpus.size(); pos += chunkSize) {
+    int size = qMin(chunkSize, corpus.size() - pos);
+    parser.feedBuffer(QByteArray::fromRawData(corpus.constData() + pos, size));
+
+    while (parser.getNextResponse().isValid()) ++parsed;
+  }
+
+  return parsed;
+}
+
+Response parseFirst(const QByteArray &corpus) {
+  ResponseParser parser;
+  parser.feedBuffer(corpus);
+  return parser.getNextResponse();
+}
+
+}  // namespace
+
+void BenchResponse::parse_data() {
+  QTest::addColumn<QByteArray>("corpus");
+  QTest::addColumn<int>("chunkSize");
+  QTest::addColumn<int>("responses");
+
+  QTest::newRow("1000 status") << Corpora::statusReplies(1000) << 0 << 1000;
+  QTest::newRow("1000 integers") << Corpora::integerReplies(1000) << 0 << 1000;
+  QTest::newRow("1000 bulk 16b") << Corpora::bulkReplies(1000, 16) << 0 << 1000;
+  QTest::newRow("10 bulk 64kb") << Corpora::bulkReplies(10, 65536) << 0 << 10;
+  QTest::newRow("10 bulk 64kb segmented")
+      << Corpora::bulkReplies(10, 65536) << SEGMENT_SIZE << 10;
+  QTest::newRow("scan 1000 keys") << Corpora::scanReply(1000) << 0 << 1;
+  QTest::newRow("scan 1000 keys segmented")
+      << Corpora::scanReply(1000) << SEGMENT_SIZE << 1;
+  QTest::newRow("cluster slots 16 masters")
+      << Corpora::clusterSlotsReply(16) << 0 << 1;
+  QTest::newRow("pipeline 1000 mixed") << Corpora::pipelineReplies(1000) << 0
+                                       << 1000;
+  QTest::newRow("pipeline 1000 mixed segmented")
+      << Corpora::pipelineReplies(1000) << SEGMENT_SIZE << 1000;
+
+  QMap<QString, QByteArray> recorded = Corpora::recorded();
+
+  for (auto i = recorded.constBegin(); i != recorded.constEnd(); ++i) {
+    int responses = parseAll(i.value(), i.value().size());
+    QTest::newRow(qPrintable("recorded " + i.key()))
+        << i.value() << SEGMENT_SIZE << responses;
+  }
+}
+
+void BenchResponse::parse() {
+  QFETCH(QByteArray, corpus);
+  QFETCH(int, chunkSize);
+  QFETCH(int, responses);
+
+  if (chunkSize <= 0) chunkSize = corpus.size();
+
+  int parsed = 0;
+
+  QBENCHMARK { parsed = parseAll(corpus, chunkSize); }
+
+  QCOMPARE(parsed, responses);
+}
+
+void BenchResponse::accessors() {
+  Response status = parseFirst(Corpora::statusReplies(1));
+  Response moved = parseFirst("-MOVED 3999 127.0.0.1:6381\r\n");
+  Response message = parseFirst(
+      "*3\r\n$7\r\nmessage\r\n$7\r\nchannel\r\n$5\r\nhello\r\n");
+
+  bool result = false;
+
+  QBENCHMARK {
+    result = status.isOkMessage() && !status.isErrorMessage() &&
+             !status.isProtocolErrorMessage() && !status.isMessage() &&
+             moved.isMovedRedirect() && !moved.isAskRedirect() &&
+             moved.getRedirectionPort() == 6381 &&
+             !moved.getRedirectionHost().isEmpty() && message.isMessage() &&
+             !message.getChannel().isEmpty();
+  }
+
+  QVERIFY(result);
+}
+
+void BenchResponse::scanResponse() {
+  Response scan = parseFirst(Corpora::scanReply(1000));
+  int items = 0;
+
+  QBENCHMARK {
+    if (scan.isValidScanResponse() && scan.getCursor() > 0)
+      items = scan.getCollection().size();
+  }
+
+  QCOMPARE(items, 1000);
+}
+
+void BenchResponse::serverInfo_data() {
+  QTest::addColumn<QString>("info");
+
+  QTest::newRow("16 databases") << Corpora::infoReply(16);
+  QTest::newRow("256 databases") << Corpora::infoReply(256);
+}
+
+void BenchResponse::serverInfo() {
+  QFETCH(QString, info);
+
+  ServerInfo result;
+
+  QBENCHMARK { result = ServerInfo::fromString(info); }
+
+  QVERIFY(result.version > 0);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+class BenchResponse : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void parse_data();
+  void parse();
+
+  void accessors();
+  void scanResponse();
+
+  void serverInfo_data();
+  void serverInfo();
+};
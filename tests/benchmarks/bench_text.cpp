@@ -0,0 +1,41 @@
+#include "bench_text.h"
+#include "corpora.h"
+#include "qredisclient/utils/text.h"
+
+#include <QTest>
+
+void BenchText::values() {
+  QTest::addColumn<QByteArray>("value");
+
+  QTest::newRow("ascii 64b") << Corpora::asciiValue(64);
+  QTest::newRow("ascii 4kb") << Corpora::asciiValue(4096);
+  QTest::newRow("utf8 4kb") << QString("Привіт, світ! 你好，世界! ")
+                                   .repeated(128)
+                                   .toUtf8()
+                                   .left(4096);
+  QTest::newRow("binary 4kb") << Corpora::binaryValue(4096);
+}
+
+void BenchText::printableString_data() { values(); }
+
+void BenchText::printableString() {
+  QFETCH(QByteArray, value);
+
+  QString result;
+
+  QBENCHMARK { result = ::printableString(value); }
+
+  QVERIFY(!result.isEmpty());
+}
+
+void BenchText::isBinary_data() { values(); }
+
+void BenchText::isBinary() {
+  QFETCH(QByteArray, value);
+
+  bool result = false;
+
+  QBENCHMARK { result = ::isBinary(value); }
+
+  Q_UNUSED(result);
+}
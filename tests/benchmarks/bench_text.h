@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+class BenchText : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void printableString_data();
+  void printableString();
+
+  void isBinary_data();
+  void isBinary();
+
+ private:
+  void values();
+};
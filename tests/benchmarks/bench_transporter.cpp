@@ -0,0 +1,81 @@
+#include "bench_transporter.h"
+#include "corpora.h"
+
+#include <QTest>
+
+using namespace RedisClient;
+
+void BenchTransporter::initTestCase() {
+  m_server.reset(new FakeRedisServer());
+  m_cluster.reset(new FakeRedisServer(3));
+
+  QVERIFY(m_server->start());
+  QVERIFY(m_cluster->start());
+}
+
+void BenchTransporter::cleanupTestCase() {
+  m_server.reset();
+  m_cluster.reset();
+}
+
+void BenchTransporter::roundTrip() {
+  Connection connection(
+      ConnectionConfig(m_server->host(), "", m_server->port(), "bench"));
+  connection.execSync({"SET", "key", Corpora::asciiValue(64)});
+
+  Response result;
+
+  QBENCHMARK { result = connection.execSync({"GET", "key"}); }
+
+  QCOMPARE(result.value().toByteArray().size(), 64);
+}
+
+void BenchTransporter::pipelined_data() {
+  QTest::addColumn<int>("commands");
+  QTest::addColumn<int>("valueSize");
+
+  QTest::newRow("100 x 64b") << 100 << 64;
+  QTest::newRow("1000 x 64b") << 1000 << 64;
+  QTest::newRow("1000 x 4kb") << 1000 << 4096;
+}
+
+void BenchTransporter::pipelined() {
+  QFETCH(int, commands);
+  QFETCH(int, valueSize);
+
+  Connection connection(
+      ConnectionConfig(m_server->host(), "", m_server->port(), "bench"));
+  QVERIFY(connection.connect());
+
+  QByteArray value = Corpora::asciiValue(valueSize);
+  QList<QByteArray> keys;
+
+  for (int i = 0; i < commands; ++i) {
+    keys.append(Corpora::key(i));
+  }
+
+  // Responses are delivered in order, so PING completes after all SETs
+  QBENCHMARK {
+    for (const QByteArray &key : keys) {
+      connection.command({"SET", key, value});
+    }
+    connection.execSync({"PING"});
+  }
+}
+
+void BenchTransporter::clusterRoundTrip() {
+  Connection connection(
+      ConnectionConfig(m_cluster->host(), "", m_cluster->port(), "bench"));
+  QVERIFY(connection.connect());
+
+  QList<QByteArray> keys;
+
+  for (int i = 0; i < 64; ++i) {
+    keys.append(Corpora::key(i));
+    connection.execSync({"SET", keys.last(), "1"});
+  }
+
+  int i = 0;
+
+  QBENCHMARK { connection.execSync({"GET", keys[i++ % keys.size()]}); }
+}
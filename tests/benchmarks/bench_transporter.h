@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QtCore>
+
+#include "fakeredisserver.h"
+#include "qredisclient/connection.h"
+
+/*
+ * DefaultTransporter end-to-end: socket, parser and queue against
+ * in-process RESP server
+ */
+class BenchTransporter : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void roundTrip();
+
+  void pipelined_data();
+  void pipelined();
+
+  void clusterRoundTrip();
+
+ private:
+  QScopedPointer<FakeRedisServer> m_server;
+  QScopedPointer<FakeRedisServer> m_cluster;
+};
@@ -0,0 +1,28 @@
+QT       += core network testlib
+
+TARGET = benchmarks
+TEMPLATE = app
+
+CONFIG += release c++11 console
+CONFIG-=app_bundle
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+
+PROJECT_ROOT = $$PWD/../../
+
+isEmpty(DESTDIR) {
+    DESTDIR = $$PWD
+}
+
+HEADERS += \
+    $$PWD/*.h
+
+SOURCES += \
+    $$PWD/*.cpp
+
+include($$PROJECT_ROOT/qredisclient.pri)
+include($$PWD/../fakeserver/fakeserver.pri)
+
+OBJECTS_DIR = $$DESTDIR/obj
+MOC_DIR = $$DESTDIR/obj
+RCC_DIR = $$DESTDIR/obj
@@ -0,0 +1,224 @@
+#include "corpora.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+
+namespace {
+
+QByteArray bulk(const QByteArray &value) {
+  return "$" + QByteArray::number(value.size()) + "\r\n" + value + "\r\n";
+}
+
+QByteArray arrayHeader(int size) {
+  return "*" + QByteArray::number(size) + "\r\n";
+}
+
+// Deterministic pseudo random generator (LCG)
+quint32 nextRandom(quint32 &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 16;
+}
+
+}  // namespace
+
+QByteArray Corpora::statusReplies(int count) {
+  QByteArray result;
+  for (int i = 0; i < count; ++i) result.append("+OK\r\n");
+  return result;
+}
+
+QByteArray Corpora::integerReplies(int count) {
+  QByteArray result;
+  for (int i = 0; i < count; ++i)
+    result.append(":" + QByteArray::number(i * 7919) + "\r\n");
+  return result;
+}
+
+QByteArray Corpora::bulkReplies(int count, int size) {
+  QByteArray value = asciiValue(size);
+  QByteArray result;
+  for (int i = 0; i < count; ++i) result.append(bulk(value));
+  return result;
+}
+
+QByteArray Corpora::scanReply(int keys) {
+  QByteArray result =
+      arrayHeader(2) + bulk("17592186044416") + arrayHeader(keys);
+
+  for (int i = 0; i < keys; ++i) result.append(bulk(key(i)));
+
+  return result;
+}
+
+QByteArray Corpora::clusterSlotsReply(int masters) {
+  const int slots = 16384;
+  QByteArray result = arrayHeader(masters);
+
+  for (int i = 0; i < masters; ++i) {
+    int from = slots / masters * i;
+    int to = (i == masters - 1) ? slots - 1 : slots / masters * (i + 1) - 1;
+
+    result.append(arrayHeader(4));
+    result.append(":" + QByteArray::number(from) + "\r\n");
+    result.append(":" + QByteArray::number(to) + "\r\n");
+
+    // master & replica
+    for (int node = 0; node < 2; ++node) {
+      result.append(arrayHeader(3));
+      result.append(bulk("127.0.0.1"));
+      result.append(":" + QByteArray::number(7000 + i * 2 + node) + "\r\n");
+      result.append(bulk(QByteArray(40, 'a' + (i + node) % 26)));
+    }
+  }
+
+  return result;
+}
+
+QByteArray Corpora::pipelineReplies(int count) {
+  QByteArray result;
+
+  for (int i = 0; i < count; ++i) {
+    switch (i % 4) {
+      case 0:
+        result.append("+OK\r\n");
+        break;
+      case 1:
+        result.append(":" + QByteArray::number(i) + "\r\n");
+        break;
+      case 2:
+        result.append(bulk(asciiValue(32)));
+        break;
+      default:
+        result.append(arrayHeader(2) + bulk(key(i)) + bulk(asciiValue(16)));
+    }
+  }
+
+  return result;
+}
+
+QString Corpora::infoReply(int databases) {
+  QStringList lines{
+      "# Server",
+      "redis_version:6.2.6",
+      "redis_git_sha1:00000000",
+      "redis_git_dirty:0",
+      "redis_build_id:c6f3693d1aced7d9",
+      "redis_mode:standalone",
+      "os:Linux 5.15.0-58-generic x86_64",
+      "arch_bits:64",
+      "multiplexing_api:epoll",
+      "gcc_version:10.2.1",
+      "process_id:1",
+      "run_id:a0f7f3b4ed6d2b8b6a3e6c3a9b8e7c3e1f2d4c5b",
+      "tcp_port:6379",
+      "uptime_in_seconds:86400",
+      "uptime_in_days:1",
+      "hz:10",
+      "executable:/data/redis-server",
+      "config_file:",
+      "",
+      "# Clients",
+      "connected_clients:12",
+      "blocked_clients:0",
+      "tracking_clients:0",
+      "",
+      "# Memory",
+      "used_memory:1046208",
+      "used_memory_human:1021.69K",
+      "used_memory_rss:7950336",
+      "used_memory_peak:1106432",
+      "maxmemory:0",
+      "maxmemory_policy:noeviction",
+      "mem_fragmentation_ratio:7.81",
+      "mem_allocator:jemalloc-5.1.0",
+      "",
+      "# Persistence",
+      "loading:0",
+      "rdb_changes_since_last_save:12",
+      "rdb_bgsave_in_progress:0",
+      "rdb_last_save_time:1672531200",
+      "aof_enabled:0",
+      "",
+      "# Stats",
+      "total_connections_received:1024",
+      "total_commands_processed:1048576",
+      "instantaneous_ops_per_sec:512",
+      "keyspace_hits:65536",
+      "keyspace_misses:1024",
+      "",
+      "# Replication",
+      "role:master",
+      "connected_slaves:0",
+      "master_replid:2b0e4c5d6f7a8b9c0d1e2f3a4b5c6d7e8f9a0b1c",
+      "master_repl_offset:0",
+      "",
+      "# CPU",
+      "used_cpu_sys:12.345678",
+      "used_cpu_user:23.456789",
+      "",
+      "# Modules",
+      "module:name=search,ver=20206,api=1,filters=0,usedby=[],using=[],options=[]",
+      "",
+      "# Cluster",
+      "cluster_enabled:0",
+      "",
+      "# Keyspace"};
+
+  for (int db = 0; db < databases; ++db) {
+    lines.append(QString("db%1:keys=%2,expires=%3,avg_ttl=0")
+                     .arg(db)
+                     .arg(1000 * (db + 1))
+                     .arg(db * 10));
+  }
+
+  return lines.join("\r\n") + "\r\n";
+}
+
+QByteArray Corpora::key(int index) {
+  return "namespace:" + QByteArray::number(index % 97) + ":item:" +
+         QByteArray::number(index);
+}
+
+QByteArray Corpora::binaryValue(int size) {
+  QByteArray result(size, Qt::Uninitialized);
+  quint32 state = 42;
+
+  for (int i = 0; i < size; ++i)
+    result[i] = static_cast<char>(nextRandom(state) & 0xff);
+
+  return result;
+}
+
+QByteArray Corpora::asciiValue(int size) {
+  static const QByteArray alphabet(
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 :-_");
+  QByteArray result(size, Qt::Uninitialized);
+  quint32 state = 7;
+
+  for (int i = 0; i < size; ++i)
+    result[i] = alphabet.at(nextRandom(state) % alphabet.size());
+
+  return result;
+}
+
+QMap<QString, QByteArray> Corpora::recorded() {
+  QMap<QString, QByteArray> result;
+  QString path = QProcessEnvironment::systemEnvironment().value(
+      "QREDISCLIENT_BENCHMARK_CORPORA");
+
+  if (path.isEmpty()) return result;
+
+  QDir dir(path);
+
+  for (const QFileInfo &file :
+       dir.entryInfoList(QStringList{"*.resp"}, QDir::Files, QDir::Name)) {
+    QFile f(file.absoluteFilePath());
+
+    if (f.open(QIODevice::ReadOnly))
+      result.insert(file.completeBaseName(), f.readAll());
+  }
+
+  return result;
+}
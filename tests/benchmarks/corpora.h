@@ -0,0 +1,30 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+/**
+ * Generators of RESP replies and INFO output used by benchmarks.
+ * Generated data is deterministic, so results are comparable between runs.
+ * Recorded replies can be added with QREDISCLIENT_BENCHMARK_CORPORA
+ * environment variable pointing to directory with *.resp files.
+ */
+namespace Corpora {
+
+QByteArray statusReplies(int count);
+QByteArray integerReplies(int count);
+QByteArray bulkReplies(int count, int size);
+QByteArray scanReply(int keys);
+QByteArray clusterSlotsReply(int masters);
+QByteArray pipelineReplies(int count);
+
+QString infoReply(int databases);
+
+QByteArray key(int index);
+QByteArray binaryValue(int size);
+QByteArray asciiValue(int size);
+
+QMap<QString, QByteArray> recorded();
+
+}  // namespace Corpora
@@ -0,0 +1,46 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QProcessEnvironment>
+#include <QTest>
+
+#include "bench_command.h"
+#include "bench_response.h"
+#include "bench_text.h"
+#include "bench_transporter.h"
+#include "qredisclient/redisclient.h"
+
+/*
+ * Runs all benchmark classes. If BENCHMARK_RESULTS_DIR is set, results of
+ * each class are saved to <dir>/<ClassName>.xml, use results_to_json.py to
+ * convert them to single JSON file.
+ */
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  initRedisClient();
+
+  QString resultsDir = QProcessEnvironment::systemEnvironment().value(
+      "BENCHMARK_RESULTS_DIR");
+
+  QList<QObject *> benchmarks{new BenchCommand, new BenchResponse,
+                              new BenchText, new BenchTransporter};
+  int result = 0;
+
+  for (QObject *benchmark : benchmarks) {
+    QStringList args = app.arguments();
+
+    if (!resultsDir.isEmpty()) {
+      QDir().mkpath(resultsDir);
+      args << "-o"
+           << QDir(resultsDir).filePath(
+                  QString("%1.xml,xml")
+                      .arg(benchmark->metaObject()->className()));
+    }
+
+    result += QTest::qExec(benchmark, args);
+  }
+
+  qDeleteAll(benchmarks);
+
+  return (result != 0) ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""
+Converts QTest XML benchmark results to JSON and compares two JSON files.
+
+    results_to_json.py convert <dir with *.xml> <output.json>
+    results_to_json.py compare <base.json> <current.json> [threshold %]
+"""
+import datetime
+import glob
+import json
+import os
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "HEAD"], stderr=subprocess.DEVNULL
+        ).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def convert(results_dir, output):
+    results = []
+
+    for path in sorted(glob.glob(os.path.join(results_dir, "*.xml"))):
+        root = ET.parse(path).getroot()
+        test_case = root.get("name")
+
+        for function in root.iter("TestFunction"):
+            for result in function.iter("BenchmarkResult"):
+                results.append({
+                    "name": "%s::%s/%s" % (test_case, function.get("name"),
+                                           result.get("tag")),
+                    "metric": result.get("metric"),
+                    # value per iteration
+                    "value": float(result.get("value")),
+                    "iterations": int(result.get("iterations")),
+                })
+
+    with open(output, "w") as f:
+        json.dump({
+            "revision": git_revision(),
+            "date": datetime.datetime.utcnow().isoformat() + "Z",
+            "results": results,
+        }, f, indent=2)
+
+
+def compare(base_path, current_path, threshold):
+    with open(base_path) as f:
+        base = {r["name"]: r for r in json.load(f)["results"]}
+    with open(current_path) as f:
+        current = json.load(f)["results"]
+
+    regressions = 0
+
+    for result in current:
+        prev = base.get(result["name"])
+
+        if not prev or prev["metric"] != result["metric"] or not prev["value"]:
+            print("%-70s %12g (new)" % (result["name"], result["value"]))
+            continue
+
+        change = (result["value"] - prev["value"]) / prev["value"] * 100
+        mark = ""
+        if change > threshold:
+            mark = " REGRESSION"
+            regressions += 1
+
+        print("%-70s %12g -> %12g %+7.1f%%%s" % (
+            result["name"], prev["value"], result["value"], change, mark))
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    if len(sys.argv) >= 4 and sys.argv[1] == "convert":
+        convert(sys.argv[2], sys.argv[3])
+    elif len(sys.argv) >= 4 and sys.argv[1] == "compare":
+        threshold = float(sys.argv[4]) if len(sys.argv) > 4 else 10.0
+        sys.exit(compare(sys.argv[2], sys.argv[3], threshold))
+    else:
+        print(__doc__)
+        sys.exit(2)
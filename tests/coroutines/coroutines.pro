@@ -0,0 +1,35 @@
+# Compiles and runs qredisclient/coroutines.h awaitables, requires compiler
+# with C++20 coroutines (GCC 10+, Clang 14+, MSVC 2019 16.8+)
+
+QT       += core network testlib
+
+TARGET = coroutine_tests
+TEMPLATE = app
+
+CONFIG += debug c++2a console
+CONFIG-=app_bundle
+
+*g++*: QMAKE_CXXFLAGS += -std=c++20 -fcoroutines
+*clang*: QMAKE_CXXFLAGS += -std=c++20
+msvc: QMAKE_CXXFLAGS += /std:c++latest
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+
+PROJECT_ROOT = $$PWD/../../
+
+isEmpty(DESTDIR) {
+    DESTDIR = $$PWD
+}
+
+HEADERS += \
+    $$PWD/*.h
+
+SOURCES += \
+    $$PWD/*.cpp
+
+include($$PROJECT_ROOT/qredisclient.pri)
+include($$PWD/../fakeserver/fakeserver.pri)
+
+OBJECTS_DIR = $$DESTDIR/obj
+MOC_DIR = $$DESTDIR/obj
+RCC_DIR = $$DESTDIR/obj
@@ -0,0 +1,15 @@
+#include <QCoreApplication>
+#include <QTest>
+
+#include "qredisclient/redisclient.h"
+#include "test_coroutines.h"
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  initRedisClient();
+
+  TestCoroutines testCoroutines;
+
+  return QTest::qExec(&testCoroutines, argc, argv) != 0 ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+#include "test_coroutines.h"
+#include <QElapsedTimer>
+#include <QTest>
+#include "qredisclient/connection.h"
+#include "qredisclient/coroutines.h"
+#include "qredisclient/transporters/defaulttransporter.h"
+#include "qredisclient/transporters/faultinjectingtransporter.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "Coroutine tests require compiler with C++20 coroutines"
+#endif
+
+using namespace RedisClient;
+
+namespace {
+
+struct Result {
+  QAtomicInt done;
+  QVariant value;
+  QString error;
+};
+
+Task getAfterSet(Connection &connection, QObject *context, Result &result) {
+  try {
+    co_await exec(connection, {"SET", "foo", "bar"}, -1, context);
+    Response r = co_await exec(connection, {"GET", "foo"}, -1, context);
+    result.value = r.value();
+  } catch (const Connection::Exception &e) {
+    result.error = e.what();
+  }
+
+  result.done.storeRelease(1);
+}
+
+Task runPipeline(Connection &connection, Result &result) {
+  try {
+    Response r = co_await pipeline(
+        connection, {{"SET", "foo", "1"}, {"INCR", "foo"}, {"GET", "foo"}});
+    result.value = r.value();
+  } catch (const Connection::Exception &e) {
+    result.error = e.what();
+  }
+
+  result.done.storeRelease(1);
+}
+
+Task scanKeys(Connection &connection, Result &result) {
+  try {
+    result.value = co_await scan(connection, ScanCommand({"SCAN", "0"}));
+  } catch (const Connection::Exception &e) {
+    result.error = e.what();
+  }
+
+  result.done.storeRelease(1);
+}
+
+}  // namespace
+
+RedisClient::ConnectionConfig TestCoroutines::getConfig(
+    const FakeRedisServer &server) {
+  ConnectionConfig config(server.host(), "", server.port(), "fake");
+  config.setTimeouts(2000, 2000);
+  return config;
+}
+
+void TestCoroutines::exec() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+  Result result;
+
+  // when
+  getAfterSet(connection, nullptr, result);
+
+  // then
+  QTRY_VERIFY(result.done.loadAcquire());
+  QCOMPARE(result.error, QString());
+  QCOMPARE(result.value.toByteArray(), QByteArray("bar"));
+}
+
+void TestCoroutines::execInResumeContext() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+  QObject context;
+  Result result;
+
+  // when
+  getAfterSet(connection, &context, result);
+
+  // then
+  QVERIFY(!result.done.loadAcquire());
+  QTRY_VERIFY(result.done.loadAcquire());
+  QCOMPARE(result.value.toByteArray(), QByteArray("bar"));
+}
+
+void TestCoroutines::pipeline() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+  Result result;
+
+  // when
+  runPipeline(connection, result);
+
+  // then
+  QTRY_VERIFY(result.done.loadAcquire());
+  QCOMPARE(result.error, QString());
+
+  QVariantList results = result.value.toList();
+  QCOMPARE(results.size(), 3);
+  QCOMPARE(results.last().toByteArray(), QByteArray("2"));
+}
+
+void TestCoroutines::scan() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 50; ++i) {
+    connection.execSync({"SET", QString("key:%1").arg(i).toUtf8(), "v"});
+  }
+
+  Result result;
+
+  // when
+  scanKeys(connection, result);
+
+  // then
+  QTRY_VERIFY(result.done.loadAcquire());
+  QCOMPARE(result.error, QString());
+  QCOMPARE(result.value.toList().size(), 50);
+}
+
+void TestCoroutines::errorResumesCoroutine() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+
+  ConnectionConfig config = getConfig(server);
+  config.setTimeouts(10000, 10000);
+  Connection connection(config);
+
+  auto transporter =
+      new FaultInjectingTransporter<DefaultTransporter>(&connection);
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(transporter));
+  connection.execSync({"PING"});
+
+  FaultConfig faults;
+  faults.latency = 500000;
+  faults.disconnectEvery = 1;
+  faults.requeueOnDisconnect = false;
+  transporter->setFaults(faults);
+
+  QElapsedTimer timer;
+  timer.start();
+  Result result;
+
+  // when
+  getAfterSet(connection, nullptr, result);
+
+  // then
+  QTRY_VERIFY(result.done.loadAcquire());
+  QVERIFY(!result.error.isEmpty());
+  QVERIFY(timer.elapsed() < 5000);
+}
+
+void TestCoroutines::disconnectResumesCoroutine() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  FaultConfig faults;
+  faults.latency = 500000;
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(
+      new FaultInjectingTransporter<DefaultTransporter>(&connection, faults)));
+  connection.execSync({"PING"});
+
+  Result result;
+  getAfterSet(connection, nullptr, result);
+
+  // when
+  connection.disconnect();
+
+  // then
+  QTRY_VERIFY(result.done.loadAcquire());
+  QCOMPARE(result.error, QString("Connection was closed"));
+}
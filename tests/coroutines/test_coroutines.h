@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+#include "fakeredisserver.h"
+#include "qredisclient/connectionconfig.h"
+
+class TestCoroutines : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void exec();
+  void execInResumeContext();
+  void pipeline();
+  void scan();
+  void errorResumesCoroutine();
+  void disconnectResumesCoroutine();
+
+ private:
+  RedisClient::ConnectionConfig getConfig(const FakeRedisServer& server);
+};
@@ -0,0 +1,1279 @@
+#include "fakeredisserver.h"
+
+#include <QCryptographicHash>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QSet>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+#include "qredisclient/command.h"
+#include "qredisclient/response.h"
+#include "qredisclient/responseparser.h"
+
+#define HASH_SLOTS 16384
+#define DATABASES 16
+
+namespace {
+
+typedef QList<QByteArray> Args;
+
+struct Value {
+  enum class Type { String, Hash, List, Set, ZSet };
+
+  Type type;
+  QByteArray string;
+  QHash<QByteArray, QByteArray> hash;
+  QList<QByteArray> list;
+  QSet<QByteArray> set;
+  QHash<QByteArray, double> zset;
+};
+
+typedef QHash<QByteArray, Value> Keyspace;
+
+struct Client {
+  int node = 0;
+  int db = 0;
+  bool authenticated = false;
+  bool inMulti = false;
+  bool multiFailed = false;
+  QList<Args> queued;
+  QSet<QByteArray> channels;
+  QSet<QByteArray> patterns;
+  RedisClient::ResponseParser parser;
+};
+
+namespace Reply {
+
+QByteArray status(const QByteArray& s) { return "+" + s + "\r\n"; }
+
+QByteArray error(const QByteArray& s) { return "-" + s + "\r\n"; }
+
+QByteArray integer(qint64 v) { return ":" + QByteArray::number(v) + "\r\n"; }
+
+QByteArray nil() { return QByteArrayLiteral("$-1\r\n"); }
+
+QByteArray bulk(const QByteArray& v) {
+  return "$" + QByteArray::number(v.size()) + "\r\n" + v + "\r\n";
+}
+
+QByteArray array(const QList<QByteArray>& encodedItems) {
+  QByteArray result = "*" + QByteArray::number(encodedItems.size()) + "\r\n";
+
+  for (const QByteArray& item : encodedItems) result.append(item);
+
+  return result;
+}
+
+QByteArray bulkArray(const QList<QByteArray>& values) {
+  QList<QByteArray> items;
+
+  for (const QByteArray& v : values) items.append(bulk(v));
+
+  return array(items);
+}
+
+QByteArray wrongType() {
+  return error(
+      "WRONGTYPE Operation against a key holding the wrong kind of value");
+}
+
+QByteArray wrongArgs(const QByteArray& cmd) {
+  return error("ERR wrong number of arguments for '" + cmd.toLower() +
+               "' command");
+}
+
+QByteArray syntaxError() { return error("ERR syntax error"); }
+
+QByteArray notInteger() {
+  return error("ERR value is not an integer or out of range");
+}
+
+}  // namespace Reply
+
+QByteArray score(double v) { return QByteArray::number(v, 'g', 17); }
+
+QByteArray scriptSha1(const QByteArray& script) {
+  return QCryptographicHash::hash(script, QCryptographicHash::Sha1).toHex();
+}
+
+bool globMatch(const QByteArray& pattern, const QByteArray& value) {
+  if (pattern == "*") return true;
+
+  QRegExp re(QString::fromUtf8(pattern), Qt::CaseSensitive,
+             QRegExp::WildcardUnix);
+  return re.exactMatch(QString::fromUtf8(value));
+}
+
+QByteArray typeName(Value::Type t) {
+  switch (t) {
+    case Value::Type::String:
+      return "string";
+    case Value::Type::Hash:
+      return "hash";
+    case Value::Type::List:
+      return "list";
+    case Value::Type::Set:
+      return "set";
+    case Value::Type::ZSet:
+      return "zset";
+  }
+  return "none";
+}
+
+// Commands without key in first argument
+const QSet<QByteArray>& keylessCommands() {
+  static const QSet<QByteArray> commands{
+      "PING",   "ECHO",        "AUTH",       "SELECT",    "QUIT",
+      "INFO",   "CLUSTER",     "CLIENT",     "CONFIG",    "COMMAND",
+      "SCAN",   "KEYS",        "DBSIZE",     "FLUSHDB",   "FLUSHALL",
+      "MULTI",  "EXEC",        "DISCARD",    "ASKING",    "READONLY",
+      "PUBLISH", "SUBSCRIBE",  "UNSUBSCRIBE", "PSUBSCRIBE", "PUNSUBSCRIBE",
+      "RANDOMKEY", "EVAL",     "EVALSHA",    "SCRIPT"};
+  return commands;
+}
+
+// Same as blocking queued call, which takes functor only since Qt 5.10
+void runInThread(QObject* context, const std::function<void()>& call) {
+  QSemaphore done;
+  QTimer::singleShot(0, context, [&call, &done]() {
+    call();
+    done.release();
+  });
+  done.acquire();
+}
+
+}  // namespace
+
+struct FakeRedisServer::State {
+  // Not recursive: sockets are closed only after the lock is released,
+  // because disconnected() can be emitted synchronously
+  mutable QMutex lock;
+  QObject* context = nullptr;
+
+  bool cluster = false;
+  QString password;
+  QVector<Keyspace> databases = QVector<Keyspace>(DATABASES);
+  QVector<int> slots = QVector<int>(HASH_SLOTS);
+  QHash<int, int> askRedirects;
+  QHash<int, QSet<QByteArray>> scripts;  // SHA1 of loaded scripts per node
+
+  QList<QTcpServer*> servers;
+  QList<quint16> ports;
+  QHash<QTcpSocket*, QSharedPointer<Client>> clients;
+  quint64 processed = 0;
+
+  void accept(int node, QTcpServer* server);
+  void readFrom(QTcpSocket* socket);
+
+  QByteArray execute(QTcpSocket* socket, Client& client, const Args& args);
+  QByteArray executeKeyCommand(Client& client, const QByteArray& name,
+                               const Args& args);
+  QByteArray redirect(const Client& client, const QByteArray& key) const;
+
+  QByteArray info(const Client& client) const;
+  QByteArray clusterCommand(const Args& args) const;
+  QByteArray scan(const QList<QByteArray>& elements,
+                  std::function<QList<QByteArray>(const QByteArray&)> expand,
+                  const Args& args, int cursorIndex) const;
+  QByteArray subscribe(QTcpSocket* socket, Client& client, const Args& args);
+  QByteArray publish(const QByteArray& channel, const QByteArray& message);
+
+  QList<QByteArray> nodeKeys(int node, int db) const;
+  bool ownsSlot(int node, int slot) const;
+};
+
+void FakeRedisServer::State::accept(int node, QTcpServer* server) {
+  while (server->hasPendingConnections()) {
+    QTcpSocket* socket = server->nextPendingConnection();
+
+    QSharedPointer<Client> client(new Client());
+    client->node = node;
+    client->authenticated = password.isEmpty();
+
+    {
+      QMutexLocker l(&lock);
+      clients.insert(socket, client);
+    }
+
+    QObject::connect(socket, &QTcpSocket::readyRead, socket,
+                     [this, socket]() { readFrom(socket); });
+
+    QObject::connect(socket, &QTcpSocket::disconnected, socket,
+                     [this, socket]() {
+                       {
+                         QMutexLocker l(&lock);
+                         clients.remove(socket);
+                       }
+                       socket->deleteLater();
+                     });
+  }
+}
+
+void FakeRedisServer::State::readFrom(QTcpSocket* socket) {
+  QByteArray replies;
+  bool close = false;
+
+  {
+    QMutexLocker l(&lock);
+
+    QSharedPointer<Client> client = clients.value(socket);
+
+    if (!client) return;
+
+    if (!client->parser.feedBuffer(socket->readAll())) {
+      replies = Reply::error("ERR Protocol error");
+      close = true;
+    }
+
+    RedisClient::Response request;
+
+    while (!close &&
+           (request = client->parser.getNextResponse()).isValid()) {
+      Args args;
+
+      for (const QVariant& part : request.value().toList()) {
+        args.append(part.toByteArray());
+      }
+
+      if (args.isEmpty()) continue;
+
+      processed++;
+      replies.append(execute(socket, *client, args));
+
+      close = args.first().toUpper() == "QUIT";
+    }
+  }
+
+  if (!replies.isEmpty()) socket->write(replies);
+  if (close) socket->disconnectFromHost();
+}
+
+QByteArray FakeRedisServer::State::execute(QTcpSocket* socket, Client& client,
+                                           const Args& args) {
+  QByteArray name = args.first().toUpper();
+
+  if (!client.authenticated && name != "AUTH" && name != "QUIT") {
+    return Reply::error("NOAUTH Authentication required.");
+  }
+
+  if (!client.channels.isEmpty() || !client.patterns.isEmpty()) {
+    if (name.endsWith("SUBSCRIBE")) return subscribe(socket, client, args);
+
+    if (name == "PING")
+      return Reply::bulkArray({"pong", args.value(1)});
+
+    return Reply::error("ERR only (P)SUBSCRIBE / (P)UNSUBSCRIBE / PING / "
+                        "QUIT are allowed in this context");
+  }
+
+  // MEMORY USAGE <key>, OBJECT ENCODING <key>
+  int keyIndex = (name == "MEMORY" || name == "OBJECT") ? 2 : 1;
+
+  if (client.inMulti && name != "EXEC" && name != "DISCARD" &&
+      name != "MULTI") {
+    QByteArray redirection;
+
+    if (!keylessCommands().contains(name) && args.size() > keyIndex)
+      redirection = redirect(client, args[keyIndex]);
+
+    if (!redirection.isEmpty()) {
+      client.multiFailed = true;
+      return redirection;
+    }
+
+    client.queued.append(args);
+    return Reply::status("QUEUED");
+  }
+
+  if (name == "PING") {
+    return args.size() > 1 ? Reply::bulk(args[1]) : Reply::status("PONG");
+  } else if (name == "ECHO") {
+    if (args.size() != 2) return Reply::wrongArgs(name);
+    return Reply::bulk(args[1]);
+  } else if (name == "AUTH") {
+    if (args.size() < 2 || args.size() > 3) return Reply::wrongArgs(name);
+
+    if (password.isEmpty())
+      return Reply::error(
+          "ERR AUTH <password> called without any password configured for "
+          "the default user. Are you sure your configuration is correct?");
+
+    if (args.last() != password.toUtf8())
+      return Reply::error(
+          "WRONGPASS invalid username-password pair or user is disabled.");
+
+    client.authenticated = true;
+    return Reply::status("OK");
+  } else if (name == "QUIT" || name == "ASKING" || name == "READONLY") {
+    return Reply::status("OK");
+  } else if (name == "SELECT") {
+    if (args.size() != 2) return Reply::wrongArgs(name);
+
+    if (cluster)
+      return Reply::error("ERR SELECT is not allowed in cluster mode");
+
+    bool ok = false;
+    int db = args[1].toInt(&ok);
+
+    if (!ok || db < 0 || db >= DATABASES)
+      return Reply::error("ERR DB index is out of range");
+
+    client.db = db;
+    return Reply::status("OK");
+  } else if (name == "INFO") {
+    return Reply::bulk(info(client));
+  } else if (name == "CLUSTER") {
+    if (!cluster)
+      return Reply::error(
+          "ERR This instance has cluster support disabled");
+
+    return clusterCommand(args);
+  } else if (name == "CLIENT") {
+    QByteArray sub = args.value(1).toUpper();
+
+    if (sub == "GETNAME") return Reply::nil();
+    if (sub == "ID") return Reply::integer(quintptr(socket) & 0xffffff);
+
+    return Reply::status("OK");
+  } else if (name == "CONFIG" || name == "COMMAND") {
+    return Reply::array({});
+  } else if (name == "DBSIZE") {
+    return Reply::integer(nodeKeys(client.node, client.db).size());
+  } else if (name == "FLUSHDB") {
+    databases[client.db].clear();
+    return Reply::status("OK");
+  } else if (name == "FLUSHALL") {
+    for (Keyspace& db : databases) db.clear();
+    return Reply::status("OK");
+  } else if (name == "KEYS") {
+    if (args.size() != 2) return Reply::wrongArgs(name);
+
+    QList<QByteArray> result;
+
+    for (const QByteArray& key : nodeKeys(client.node, client.db)) {
+      if (globMatch(args[1], key)) result.append(key);
+    }
+
+    return Reply::bulkArray(result);
+  } else if (name == "RANDOMKEY") {
+    QList<QByteArray> keys = nodeKeys(client.node, client.db);
+    return keys.isEmpty() ? Reply::nil() : Reply::bulk(keys.first());
+  } else if (name == "SCAN") {
+    if (args.size() < 2) return Reply::wrongArgs(name);
+
+    QList<QByteArray> keys = nodeKeys(client.node, client.db);
+    std::sort(keys.begin(), keys.end());
+
+    int typeIndex = args.indexOf("TYPE");
+    if (typeIndex < 0) typeIndex = args.indexOf("type");
+
+    if (typeIndex > 1 && typeIndex + 1 < args.size()) {
+      const Keyspace& db = databases[client.db];
+      QByteArray type = args[typeIndex + 1].toLower();
+      QList<QByteArray> filtered;
+
+      for (const QByteArray& key : keys) {
+        if (typeName(db[key].type) == type) filtered.append(key);
+      }
+      keys = filtered;
+    }
+
+    return scan(
+        keys, [](const QByteArray& k) { return QList<QByteArray>{k}; }, args,
+        1);
+  } else if (name == "MULTI") {
+    if (client.inMulti)
+      return Reply::error("ERR MULTI calls can not be nested");
+
+    client.inMulti = true;
+    client.multiFailed = false;
+    client.queued.clear();
+    return Reply::status("OK");
+  } else if (name == "EXEC" || name == "DISCARD") {
+    if (!client.inMulti)
+      return Reply::error("ERR " + name + " without MULTI");
+
+    QList<Args> queued = client.queued;
+    bool failed = client.multiFailed;
+
+    client.inMulti = false;
+    client.multiFailed = false;
+    client.queued.clear();
+
+    if (name == "DISCARD") return Reply::status("OK");
+
+    if (failed)
+      return Reply::error(
+          "EXECABORT Transaction discarded because of previous errors.");
+
+    QList<QByteArray> results;
+
+    for (const Args& queuedArgs : queued) {
+      results.append(execute(socket, client, queuedArgs));
+    }
+
+    return Reply::array(results);
+  } else if (name.endsWith("SUBSCRIBE")) {
+    return subscribe(socket, client, args);
+  } else if (name == "PUBLISH") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    return publish(args[1], args[2]);
+  } else if (name == "SCRIPT") {
+    QByteArray sub = args.value(1).toUpper();
+    QSet<QByteArray>& loaded = scripts[client.node];
+
+    if (sub == "LOAD" && args.size() == 3) {
+      QByteArray sha1 = scriptSha1(args[2]);
+      loaded.insert(sha1);
+      return Reply::bulk(sha1);
+    } else if (sub == "EXISTS") {
+      QList<QByteArray> result;
+
+      for (int i = 2; i < args.size(); ++i)
+        result.append(Reply::integer(loaded.contains(args[i].toLower())));
+
+      return Reply::array(result);
+    } else if (sub == "FLUSH") {
+      loaded.clear();
+      return Reply::status("OK");
+    }
+
+    return Reply::syntaxError();
+  } else if (name == "EVAL" || name == "EVALSHA") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    QSet<QByteArray>& loaded = scripts[client.node];
+
+    if (name == "EVAL") {
+      loaded.insert(scriptSha1(args[1]));
+    } else if (!loaded.contains(args[1].toLower())) {
+      return Reply::error("NOSCRIPT No matching script. Please use EVAL.");
+    }
+
+    bool ok = false;
+    int numKeys = args[2].toInt(&ok);
+
+    if (!ok || numKeys < 0 || 3 + numKeys > args.size())
+      return Reply::error(
+          "ERR Number of keys can't be greater than number of args");
+
+    // Scripts are not executed: KEYS and ARGV are echoed back
+    return Reply::bulkArray(args.mid(3));
+  }
+
+  if (args.size() <= keyIndex) return Reply::wrongArgs(name);
+
+  QByteArray redirection = redirect(client, args[keyIndex]);
+
+  if (!redirection.isEmpty()) return redirection;
+
+  return executeKeyCommand(client, name, args);
+}
+
+QByteArray FakeRedisServer::State::executeKeyCommand(Client& client,
+                                                     const QByteArray& name,
+                                                     const Args& args) {
+  Keyspace& db = databases[client.db];
+  const QByteArray& key = args[1];
+  auto existing = db.find(key);
+  bool exists = existing != db.end();
+
+  auto typed = [&](Value::Type type) -> Value* {
+    if (!exists) {
+      Value v;
+      v.type = type;
+      existing = db.insert(key, v);
+      exists = true;
+    }
+    return existing->type == type ? &existing.value() : nullptr;
+  };
+
+  auto readable = [&](Value::Type type, bool* wrongType) -> const Value* {
+    *wrongType = exists && existing->type != type;
+    return exists && !*wrongType ? &existing.value() : nullptr;
+  };
+
+  auto dropIfEmpty = [&]() {
+    if (!exists) return;
+
+    const Value& v = existing.value();
+    bool empty = (v.type == Value::Type::Hash && v.hash.isEmpty()) ||
+                 (v.type == Value::Type::List && v.list.isEmpty()) ||
+                 (v.type == Value::Type::Set && v.set.isEmpty()) ||
+                 (v.type == Value::Type::ZSet && v.zset.isEmpty());
+    if (empty) db.erase(existing);
+  };
+
+  bool wrongType = false;
+
+  // Generic
+  if (name == "DEL" || name == "UNLINK" || name == "EXISTS") {
+    int count = 0;
+
+    for (int i = 1; i < args.size(); ++i) {
+      if (name == "EXISTS")
+        count += db.contains(args[i]) ? 1 : 0;
+      else
+        count += db.remove(args[i]);
+    }
+    return Reply::integer(count);
+  } else if (name == "TYPE") {
+    return Reply::status(exists ? typeName(existing->type) : "none");
+  } else if (name == "TTL" || name == "PTTL") {
+    return Reply::integer(exists ? -1 : -2);
+  } else if (name == "EXPIRE" || name == "PEXPIRE" || name == "PERSIST") {
+    // expiration is not simulated
+    return Reply::integer(exists ? 1 : 0);
+  } else if (name == "RENAME") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+    if (!exists) return Reply::error("ERR no such key");
+
+    Value v = existing.value();
+    db.erase(existing);
+    db.insert(args[2], v);
+    return Reply::status("OK");
+  } else if (name == "MEMORY") {
+    // MEMORY USAGE key, key is in args[2]
+    if (args.size() < 3 || args[1].toUpper() != "USAGE")
+      return Reply::syntaxError();
+
+    auto v = db.constFind(args[2]);
+    if (v == db.constEnd()) return Reply::nil();
+
+    qint64 size = 56 + args[2].size() + v->string.size();
+    for (auto i = v->hash.constBegin(); i != v->hash.constEnd(); ++i)
+      size += i.key().size() + i.value().size() + 16;
+    for (const QByteArray& item : v->list) size += item.size() + 8;
+    for (const QByteArray& item : v->set) size += item.size() + 8;
+    for (auto i = v->zset.constBegin(); i != v->zset.constEnd(); ++i)
+      size += i.key().size() + 24;
+
+    return Reply::integer(size);
+  } else if (name == "OBJECT") {
+    if (args.size() < 3 || args[1].toUpper() != "ENCODING")
+      return Reply::syntaxError();
+
+    auto v = db.constFind(args[2]);
+    if (v == db.constEnd()) return Reply::nil();
+
+    switch (v->type) {
+      case Value::Type::String: {
+        bool isInt = false;
+        v->string.toLongLong(&isInt);
+        return Reply::bulk(isInt ? "int"
+                                 : v->string.size() <= 44 ? "embstr" : "raw");
+      }
+      case Value::Type::List:
+        return Reply::bulk("quicklist");
+      case Value::Type::Set:
+        return Reply::bulk("hashtable");
+      case Value::Type::Hash:
+      case Value::Type::ZSet:
+        return Reply::bulk("listpack");
+    }
+  }
+
+  // Strings
+  if (name == "GET") {
+    const Value* v = readable(Value::Type::String, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return v ? Reply::bulk(v->string) : Reply::nil();
+  } else if (name == "SET") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    Value v;
+    v.type = Value::Type::String;
+    v.string = args[2];
+    db.insert(key, v);
+    return Reply::status("OK");
+  } else if (name == "MGET") {
+    QList<QByteArray> items;
+
+    for (int i = 1; i < args.size(); ++i) {
+      auto v = db.constFind(args[i]);
+      items.append(v != db.constEnd() && v->type == Value::Type::String
+                       ? Reply::bulk(v->string)
+                       : Reply::nil());
+    }
+    return Reply::array(items);
+  } else if (name == "MSET") {
+    if (args.size() % 2 == 0) return Reply::wrongArgs(name);
+
+    for (int i = 1; i + 1 < args.size(); i += 2) {
+      Value v;
+      v.type = Value::Type::String;
+      v.string = args[i + 1];
+      db.insert(args[i], v);
+    }
+    return Reply::status("OK");
+  } else if (name == "STRLEN") {
+    const Value* v = readable(Value::Type::String, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v ? v->string.size() : 0);
+  } else if (name == "APPEND") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    Value* v = typed(Value::Type::String);
+    if (!v) return Reply::wrongType();
+    v->string.append(args[2]);
+    return Reply::integer(v->string.size());
+  } else if (name == "INCR" || name == "DECR" || name == "INCRBY" ||
+             name == "DECRBY") {
+    qint64 delta = 1;
+
+    if (name.endsWith("BY")) {
+      bool ok = false;
+      delta = args.value(2).toLongLong(&ok);
+      if (!ok) return Reply::notInteger();
+    }
+    if (name.startsWith("DECR")) delta = -delta;
+
+    Value* v = typed(Value::Type::String);
+    if (!v) return Reply::wrongType();
+
+    bool ok = true;
+    qint64 current = v->string.isEmpty() ? 0 : v->string.toLongLong(&ok);
+    if (!ok) return Reply::notInteger();
+
+    v->string = QByteArray::number(current + delta);
+    return Reply::integer(current + delta);
+  }
+
+  // Hashes
+  if (name == "HSET" || name == "HMSET") {
+    if (args.size() < 4 || args.size() % 2 != 0) return Reply::wrongArgs(name);
+
+    Value* v = typed(Value::Type::Hash);
+    if (!v) return Reply::wrongType();
+
+    int added = 0;
+    for (int i = 2; i + 1 < args.size(); i += 2) {
+      if (!v->hash.contains(args[i])) added++;
+      v->hash.insert(args[i], args[i + 1]);
+    }
+    return name == "HMSET" ? Reply::status("OK") : Reply::integer(added);
+  } else if (name == "HGET") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Hash, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return v && v->hash.contains(args[2]) ? Reply::bulk(v->hash[args[2]])
+                                          : Reply::nil();
+  } else if (name == "HGETALL" || name == "HKEYS" || name == "HVALS") {
+    const Value* v = readable(Value::Type::Hash, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    QList<QByteArray> items;
+    if (v) {
+      for (auto i = v->hash.constBegin(); i != v->hash.constEnd(); ++i) {
+        if (name != "HVALS") items.append(i.key());
+        if (name != "HKEYS") items.append(i.value());
+      }
+    }
+    return Reply::bulkArray(items);
+  } else if (name == "HDEL") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Hash, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    if (!v) return Reply::integer(0);
+
+    int removed = 0;
+    for (int i = 2; i < args.size(); ++i)
+      removed += existing->hash.remove(args[i]);
+
+    dropIfEmpty();
+    return Reply::integer(removed);
+  } else if (name == "HLEN") {
+    const Value* v = readable(Value::Type::Hash, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v ? v->hash.size() : 0);
+  } else if (name == "HSCAN") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Hash, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    QList<QByteArray> fields = v ? v->hash.keys() : QList<QByteArray>();
+    std::sort(fields.begin(), fields.end());
+
+    return scan(
+        fields,
+        [v](const QByteArray& f) {
+          return QList<QByteArray>{f, v->hash.value(f)};
+        },
+        args, 2);
+  }
+
+  // Lists
+  if (name == "LPUSH" || name == "RPUSH") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    Value* v = typed(Value::Type::List);
+    if (!v) return Reply::wrongType();
+
+    for (int i = 2; i < args.size(); ++i) {
+      if (name == "LPUSH")
+        v->list.prepend(args[i]);
+      else
+        v->list.append(args[i]);
+    }
+    return Reply::integer(v->list.size());
+  } else if (name == "LPOP" || name == "RPOP") {
+    const Value* v = readable(Value::Type::List, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    if (!v) return Reply::nil();
+
+    QByteArray item = name == "LPOP" ? existing->list.takeFirst()
+                                     : existing->list.takeLast();
+    dropIfEmpty();
+    return Reply::bulk(item);
+  } else if (name == "LLEN") {
+    const Value* v = readable(Value::Type::List, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v ? v->list.size() : 0);
+  } else if (name == "LINDEX") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::List, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    int index = args[2].toInt();
+    if (v && index < 0) index += v->list.size();
+
+    return v && index >= 0 && index < v->list.size()
+               ? Reply::bulk(v->list.at(index))
+               : Reply::nil();
+  } else if (name == "LRANGE") {
+    if (args.size() != 4) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::List, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    if (!v) return Reply::array({});
+
+    int size = v->list.size();
+    int start = args[2].toInt(), stop = args[3].toInt();
+    if (start < 0) start = qMax(0, start + size);
+    if (stop < 0) stop += size;
+    stop = qMin(stop, size - 1);
+
+    return Reply::bulkArray(start > stop ? QList<QByteArray>()
+                                         : v->list.mid(start, stop - start + 1));
+  }
+
+  // Sets
+  if (name == "SADD") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    Value* v = typed(Value::Type::Set);
+    if (!v) return Reply::wrongType();
+
+    int added = 0;
+    for (int i = 2; i < args.size(); ++i) {
+      if (!v->set.contains(args[i])) added++;
+      v->set.insert(args[i]);
+    }
+    return Reply::integer(added);
+  } else if (name == "SREM") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Set, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    if (!v) return Reply::integer(0);
+
+    int removed = 0;
+    for (int i = 2; i < args.size(); ++i)
+      removed += existing->set.remove(args[i]) ? 1 : 0;
+
+    dropIfEmpty();
+    return Reply::integer(removed);
+  } else if (name == "SMEMBERS") {
+    const Value* v = readable(Value::Type::Set, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::bulkArray(v ? v->set.values() : QList<QByteArray>());
+  } else if (name == "SCARD") {
+    const Value* v = readable(Value::Type::Set, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v ? v->set.size() : 0);
+  } else if (name == "SISMEMBER") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Set, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v && v->set.contains(args[2]) ? 1 : 0);
+  } else if (name == "SSCAN") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::Set, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    QList<QByteArray> members = v ? v->set.values() : QList<QByteArray>();
+    std::sort(members.begin(), members.end());
+
+    return scan(
+        members, [](const QByteArray& m) { return QList<QByteArray>{m}; },
+        args, 2);
+  }
+
+  // Sorted sets
+  auto sortedMembers = [](const Value* v) {
+    QList<QByteArray> members = v ? v->zset.keys() : QList<QByteArray>();
+    std::sort(members.begin(), members.end(),
+              [v](const QByteArray& a, const QByteArray& b) {
+                double sa = v->zset.value(a), sb = v->zset.value(b);
+                return sa < sb || (sa == sb && a < b);
+              });
+    return members;
+  };
+
+  if (name == "ZADD") {
+    if (args.size() < 4 || args.size() % 2 != 0) return Reply::wrongArgs(name);
+
+    for (int i = 2; i + 1 < args.size(); i += 2) {
+      bool ok = false;
+      args[i].toDouble(&ok);
+      if (!ok) return Reply::error("ERR value is not a valid float");
+    }
+
+    Value* v = typed(Value::Type::ZSet);
+    if (!v) return Reply::wrongType();
+
+    int added = 0;
+    for (int i = 2; i + 1 < args.size(); i += 2) {
+      if (!v->zset.contains(args[i + 1])) added++;
+      v->zset.insert(args[i + 1], args[i].toDouble());
+    }
+    return Reply::integer(added);
+  } else if (name == "ZREM") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::ZSet, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    if (!v) return Reply::integer(0);
+
+    int removed = 0;
+    for (int i = 2; i < args.size(); ++i)
+      removed += existing->zset.remove(args[i]);
+
+    dropIfEmpty();
+    return Reply::integer(removed);
+  } else if (name == "ZCARD") {
+    const Value* v = readable(Value::Type::ZSet, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return Reply::integer(v ? v->zset.size() : 0);
+  } else if (name == "ZSCORE") {
+    if (args.size() != 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::ZSet, &wrongType);
+    if (wrongType) return Reply::wrongType();
+    return v && v->zset.contains(args[2])
+               ? Reply::bulk(score(v->zset.value(args[2])))
+               : Reply::nil();
+  } else if (name == "ZRANGE") {
+    if (args.size() < 4) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::ZSet, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    QList<QByteArray> members = sortedMembers(v);
+    bool withScores = args.size() > 4 && args[4].toUpper() == "WITHSCORES";
+
+    int size = members.size();
+    int start = args[2].toInt(), stop = args[3].toInt();
+    if (start < 0) start = qMax(0, start + size);
+    if (stop < 0) stop += size;
+    stop = qMin(stop, size - 1);
+
+    QList<QByteArray> result;
+    for (int i = start; i <= stop; ++i) {
+      result.append(members[i]);
+      if (withScores) result.append(score(v->zset.value(members[i])));
+    }
+    return Reply::bulkArray(result);
+  } else if (name == "ZSCAN") {
+    if (args.size() < 3) return Reply::wrongArgs(name);
+
+    const Value* v = readable(Value::Type::ZSet, &wrongType);
+    if (wrongType) return Reply::wrongType();
+
+    return scan(
+        sortedMembers(v),
+        [v](const QByteArray& m) {
+          return QList<QByteArray>{m, score(v->zset.value(m))};
+        },
+        args, 2);
+  }
+
+  return Reply::error("ERR unknown command '" + args.first() + "'");
+}
+
+QByteArray FakeRedisServer::State::redirect(const Client& client,
+                                            const QByteArray& key) const {
+  if (!cluster) return QByteArray();
+
+  int slot = RedisClient::Command::calcKeyHashSlot(key);
+  int target = -1;
+  QByteArray type;
+
+  if (askRedirects.contains(slot)) {
+    int askTarget = askRedirects.value(slot);
+
+    if (client.node == askTarget) return QByteArray();
+
+    if (client.node == slots[slot]) {
+      target = askTarget;
+      type = "ASK";
+    }
+  }
+
+  if (target < 0) {
+    if (client.node == slots[slot]) return QByteArray();
+
+    target = slots[slot];
+    type = "MOVED";
+  }
+
+  return Reply::error(type + " " + QByteArray::number(slot) + " 127.0.0.1:" +
+                      QByteArray::number(ports.value(target)));
+}
+
+QByteArray FakeRedisServer::State::info(const Client& client) const {
+  QByteArray result;
+  result.append("# Server\r\n");
+  result.append("redis_version:7.0.0\r\n");
+  result.append(cluster ? "redis_mode:cluster\r\n"
+                        : "redis_mode:standalone\r\n");
+  result.append("tcp_port:" + QByteArray::number(ports.value(client.node)) +
+                "\r\n\r\n");
+
+  result.append("# Clients\r\n");
+  result.append("connected_clients:" + QByteArray::number(clients.size()) +
+                "\r\n\r\n");
+
+  result.append("# Stats\r\n");
+  result.append("total_commands_processed:" + QByteArray::number(processed) +
+                "\r\n\r\n");
+
+  if (cluster) result.append("# Cluster\r\ncluster_enabled:1\r\n\r\n");
+
+  result.append("# Keyspace\r\n");
+
+  for (int db = 0; db < databases.size(); ++db) {
+    if (databases[db].isEmpty()) continue;
+
+    result.append("db" + QByteArray::number(db) + ":keys=" +
+                  QByteArray::number(nodeKeys(client.node, db).size()) +
+                  ",expires=0,avg_ttl=0\r\n");
+  }
+
+  return result;
+}
+
+QByteArray FakeRedisServer::State::clusterCommand(const Args& args) const {
+  QByteArray sub = args.value(1).toUpper();
+
+  if (sub == "SLOTS") {
+    QList<QByteArray> ranges;
+    int start = 0;
+
+    for (int slot = 1; slot <= HASH_SLOTS; ++slot) {
+      if (slot < HASH_SLOTS && slots[slot] == slots[start]) continue;
+
+      int node = slots[start];
+      QByteArray master = Reply::array(
+          {Reply::bulk("127.0.0.1"), Reply::integer(ports.value(node)),
+           Reply::bulk(QByteArray::number(node).rightJustified(40, '0'))});
+
+      ranges.append(Reply::array(
+          {Reply::integer(start), Reply::integer(slot - 1), master}));
+      start = slot;
+    }
+
+    return Reply::array(ranges);
+  } else if (sub == "KEYSLOT") {
+    if (args.size() != 3) return Reply::wrongArgs("cluster|keyslot");
+    return Reply::integer(RedisClient::Command::calcKeyHashSlot(args[2]));
+  } else if (sub == "INFO") {
+    return Reply::bulk("cluster_enabled:1\r\ncluster_state:ok\r\n"
+                       "cluster_slots_assigned:16384\r\ncluster_known_nodes:" +
+                       QByteArray::number(servers.size()) + "\r\n");
+  }
+
+  return Reply::error("ERR Unknown subcommand or wrong number of arguments");
+}
+
+QByteArray FakeRedisServer::State::scan(
+    const QList<QByteArray>& elements,
+    std::function<QList<QByteArray>(const QByteArray&)> expand,
+    const Args& args, int cursorIndex) const {
+  bool ok = false;
+  int cursor = args[cursorIndex].toInt(&ok);
+
+  if (!ok || cursor < 0) return Reply::error("ERR invalid cursor");
+
+  QByteArray pattern = "*";
+  int count = 10;
+
+  for (int i = cursorIndex + 1; i + 1 < args.size(); i += 2) {
+    QByteArray option = args[i].toUpper();
+
+    if (option == "MATCH") {
+      pattern = args[i + 1];
+    } else if (option == "COUNT") {
+      count = args[i + 1].toInt(&ok);
+      if (!ok || count < 1) return Reply::syntaxError();
+    } else if (option != "TYPE") {
+      return Reply::syntaxError();
+    }
+  }
+
+  // Cursor is position in sorted elements, COUNT is amount of work like in
+  // redis: filtered out elements consume it too
+  QList<QByteArray> page;
+  int end = qMin(elements.size(), cursor + count);
+
+  for (int i = cursor; i < end; ++i) {
+    if (globMatch(pattern, elements[i])) page.append(expand(elements[i]));
+  }
+
+  int next = end >= elements.size() ? 0 : end;
+
+  return Reply::array(
+      {Reply::bulk(QByteArray::number(next)), Reply::bulkArray(page)});
+}
+
+QByteArray FakeRedisServer::State::subscribe(QTcpSocket*, Client& client,
+                                             const Args& args) {
+  QByteArray name = args.first().toUpper();
+  bool patterns = name.startsWith('P');
+  bool unsubscribe = name.contains("UNSUBSCRIBE");
+  QSet<QByteArray>& target = patterns ? client.patterns : client.channels;
+  QByteArray kind = name.toLower();
+
+  QList<QByteArray> targets = args.mid(1);
+
+  if (targets.isEmpty()) {
+    if (!unsubscribe) return Reply::wrongArgs(name);
+
+    targets = target.values();
+
+    if (targets.isEmpty())
+      return Reply::array({Reply::bulk(kind), Reply::nil(),
+                           Reply::integer(client.channels.size() +
+                                          client.patterns.size())});
+  }
+
+  QByteArray result;
+
+  for (const QByteArray& t : targets) {
+    if (unsubscribe)
+      target.remove(t);
+    else
+      target.insert(t);
+
+    result.append(Reply::array(
+        {Reply::bulk(kind), Reply::bulk(t),
+         Reply::integer(client.channels.size() + client.patterns.size())}));
+  }
+
+  return result;
+}
+
+QByteArray FakeRedisServer::State::publish(const QByteArray& channel,
+                                           const QByteArray& message) {
+  int receivers = 0;
+
+  for (auto i = clients.constBegin(); i != clients.constEnd(); ++i) {
+    const Client& c = *i.value();
+
+    if (c.channels.contains(channel)) {
+      i.key()->write(Reply::bulkArray({"message", channel, message}));
+      receivers++;
+    }
+
+    for (const QByteArray& pattern : c.patterns) {
+      if (globMatch(pattern, channel)) {
+        i.key()->write(
+            Reply::bulkArray({"pmessage", pattern, channel, message}));
+        receivers++;
+      }
+    }
+  }
+
+  return Reply::integer(receivers);
+}
+
+QList<QByteArray> FakeRedisServer::State::nodeKeys(int node, int dbIndex) const {
+  const Keyspace& db = databases[dbIndex];
+
+  if (!cluster) return db.keys();
+
+  QList<QByteArray> result;
+
+  for (auto i = db.constBegin(); i != db.constEnd(); ++i) {
+    if (ownsSlot(node, RedisClient::Command::calcKeyHashSlot(i.key())))
+      result.append(i.key());
+  }
+
+  return result;
+}
+
+bool FakeRedisServer::State::ownsSlot(int node, int slot) const {
+  return slots[slot] == node;
+}
+
+FakeRedisServer::FakeRedisServer(int nodes)
+    : m_nodes(qMax(nodes, 1)), m_state(new State()) {
+  m_state->cluster = m_nodes > 1;
+
+  for (int slot = 0; slot < HASH_SLOTS; ++slot) {
+    m_state->slots[slot] = slot * m_nodes / HASH_SLOTS;
+  }
+
+  m_thread.setObjectName("fake redis-server");
+}
+
+FakeRedisServer::~FakeRedisServer() { stop(); }
+
+bool FakeRedisServer::start() {
+  if (isRunning()) return true;
+
+  m_state->context = new QObject();
+  m_state->context->moveToThread(&m_thread);
+  m_thread.start();
+
+  bool result = true;
+  State* state = m_state.data();
+  int nodes = m_nodes;
+
+  runInThread(
+      state->context,
+      [state, nodes, &result]() {
+        for (int node = 0; node < nodes; ++node) {
+          QTcpServer* server = new QTcpServer(state->context);
+
+          if (!server->listen(QHostAddress::LocalHost)) {
+            result = false;
+            return;
+          }
+
+          QObject::connect(server, &QTcpServer::newConnection, server,
+                           [state, node, server]() {
+                             state->accept(node, server);
+                           });
+
+          QMutexLocker l(&state->lock);
+          state->servers.append(server);
+          state->ports.append(server->serverPort());
+        }
+      });
+
+  if (!result) stop();
+
+  return result;
+}
+
+void FakeRedisServer::stop() {
+  if (!m_state->context) return;
+
+  State* state = m_state.data();
+
+  runInThread(
+      state->context,
+      [state]() {
+        QList<QTcpSocket*> sockets;
+        QList<QTcpServer*> servers;
+
+        {
+          QMutexLocker l(&state->lock);
+          sockets = state->clients.keys();
+          servers = state->servers;
+          state->clients.clear();
+          state->servers.clear();
+          state->ports.clear();
+        }
+
+        for (QTcpSocket* socket : sockets) {
+          socket->abort();
+        }
+
+        qDeleteAll(servers);
+      });
+
+  m_thread.quit();
+  m_thread.wait();
+
+  delete state->context;
+  state->context = nullptr;
+}
+
+bool FakeRedisServer::isRunning() const { return m_state->context != nullptr; }
+
+bool FakeRedisServer::isCluster() const { return m_state->cluster; }
+
+QString FakeRedisServer::host() const { return QStringLiteral("127.0.0.1"); }
+
+quint16 FakeRedisServer::port(int node) const {
+  QMutexLocker l(&m_state->lock);
+  return m_state->ports.value(node);
+}
+
+QList<quint16> FakeRedisServer::ports() const {
+  QMutexLocker l(&m_state->lock);
+  return m_state->ports;
+}
+
+void FakeRedisServer::setPassword(const QString& password) {
+  QMutexLocker l(&m_state->lock);
+  m_state->password = password;
+}
+
+void FakeRedisServer::moveSlot(int slot, int node) {
+  if (slot < 0 || slot >= HASH_SLOTS || node < 0 || node >= m_nodes) return;
+
+  QMutexLocker l(&m_state->lock);
+  m_state->slots[slot] = node;
+}
+
+int FakeRedisServer::slotOwner(int slot) const {
+  QMutexLocker l(&m_state->lock);
+  return m_state->slots.value(slot, -1);
+}
+
+void FakeRedisServer::setAskRedirect(int slot, int node) {
+  if (slot < 0 || slot >= HASH_SLOTS || node < 0 || node >= m_nodes) return;
+
+  QMutexLocker l(&m_state->lock);
+  m_state->askRedirects.insert(slot, node);
+}
+
+void FakeRedisServer::clearAskRedirect(int slot) {
+  QMutexLocker l(&m_state->lock);
+  m_state->askRedirects.remove(slot);
+}
+
+void FakeRedisServer::flushAll() {
+  QMutexLocker l(&m_state->lock);
+
+  for (Keyspace& db : m_state->databases) db.clear();
+}
+
+quint64 FakeRedisServer::processedCommands() const {
+  QMutexLocker l(&m_state->lock);
+  return m_state->processed;
+}
+
+int FakeRedisServer::connectedClients() const {
+  QMutexLocker l(&m_state->lock);
+  return m_state->clients.size();
+}
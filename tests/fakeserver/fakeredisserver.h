@@ -0,0 +1,79 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QScopedPointer>
+#include <QString>
+#include <QThread>
+
+/**
+ * @brief The FakeRedisServer class
+ * In-process RESP server for tests and benchmarks. Listens on localhost and
+ * runs in its own thread, so blocking client calls (Connection::execSync)
+ * work from the thread which owns the server.
+ *
+ * Supported subset:
+ *  - strings, hashes, lists, sets and sorted sets (no expiration)
+ *  - SCAN, HSCAN, SSCAN, ZSCAN with MATCH/COUNT (TYPE for SCAN)
+ *  - SUBSCRIBE/PSUBSCRIBE/UNSUBSCRIBE/PUNSUBSCRIBE/PUBLISH
+ *  - MULTI/EXEC/DISCARD, SELECT, INFO, AUTH, PING, ECHO
+ *  - CLUSTER SLOTS/KEYSLOT/INFO in cluster mode
+ *  - EVAL/EVALSHA/SCRIPT LOAD|EXISTS|FLUSH with per-node script cache;
+ *    scripts are not executed, reply is array of KEYS followed by ARGV
+ *
+ * Cluster mode (nodes > 1) listens on one port per node and splits hash
+ * slots evenly. Key commands sent to the wrong node get MOVED, slots marked
+ * with setAskRedirect() get ASK from the owner. All nodes share one
+ * keyspace, multi-key commands are routed by the first key only.
+ */
+class FakeRedisServer {
+ public:
+  explicit FakeRedisServer(int nodes = 1);
+  ~FakeRedisServer();
+
+  /**
+   * @brief Start listening on free localhost ports
+   * @return false if any of nodes can't listen
+   */
+  bool start();
+  void stop();
+
+  bool isRunning() const;
+  bool isCluster() const;
+
+  QString host() const;
+  quint16 port(int node = 0) const;
+  QList<quint16> ports() const;
+
+  /**
+   * @brief Require AUTH <password> before any other command
+   */
+  void setPassword(const QString& password);
+
+  /**
+   * @brief Make node owner of the slot, other nodes reply with MOVED
+   */
+  void moveSlot(int slot, int node);
+  int slotOwner(int slot) const;
+
+  /**
+   * @brief Slot owner replies with ASK to node until clearAskRedirect().
+   * Target node serves the slot regardless of ASKING because
+   * qredisclient re-sends redirected commands without it.
+   */
+  void setAskRedirect(int slot, int node);
+  void clearAskRedirect(int slot);
+
+  void flushAll();
+
+  quint64 processedCommands() const;
+  int connectedClients() const;
+
+ private:
+  Q_DISABLE_COPY(FakeRedisServer)
+
+  struct State;
+
+  int m_nodes;
+  QThread m_thread;
+  QScopedPointer<State> m_state;
+};
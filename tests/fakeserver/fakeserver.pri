@@ -0,0 +1,9 @@
+# In-process RESP server for unit tests and benchmarks
+
+INCLUDEPATH += $$PWD/
+
+HEADERS += \
+    $$PWD/fakeredisserver.h
+
+SOURCES += \
+    $$PWD/fakeredisserver.cpp
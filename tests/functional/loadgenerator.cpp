@@ -0,0 +1,365 @@
+#include "loadgenerator.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "qredisclient/connectionconfig.h"
+
+#define DRAIN_TIMEOUT_MS 5000
+
+bool LoadConfig::parse(const QString& distributionSpec,
+                       const QString& valueSizeSpec, QString* error)
+{
+    // uniform | zipf | zipf:<exponent>
+    QStringList dist = distributionSpec.split(':');
+    distribution = dist.first();
+
+    if (distribution != "uniform" && distribution != "zipf") {
+        *error = QString("Unknown key distribution: %1").arg(distributionSpec);
+        return false;
+    }
+
+    if (distribution == "zipf" && dist.size() > 1) {
+        bool ok = false;
+        zipfExponent = dist[1].toDouble(&ok);
+
+        if (!ok || zipfExponent <= 0) {
+            *error = QString("Invalid zipf exponent: %1").arg(dist[1]);
+            return false;
+        }
+    }
+
+    // <size> | <min>:<max>
+    QStringList sizes = valueSizeSpec.split(':');
+    bool okMin = false, okMax = false;
+    valueMin = sizes.first().toInt(&okMin);
+    valueMax = sizes.size() > 1 ? sizes[1].toInt(&okMax) : valueMin;
+
+    if (sizes.size() == 1) okMax = okMin;
+
+    if (!okMin || !okMax || valueMin < 0 || valueMax < valueMin) {
+        *error = QString("Invalid value size: %1").arg(valueSizeSpec);
+        return false;
+    }
+
+    if (connections < 1 || inflight < 1 || duration < 1 || keys < 1
+            || interval < 1 || rate < 0 || readRatio < 0 || readRatio > 1) {
+        *error = "Invalid workload parameters";
+        return false;
+    }
+
+    return true;
+}
+
+QVariantMap LoadConfig::toVariantMap() const
+{
+    QVariantMap result;
+    result["host"] = host;
+    result["port"] = port;
+    result["db"] = db;
+    result["cluster"] = cluster;
+    result["connections"] = connections;
+    result["inflight"] = inflight;
+    result["duration"] = duration;
+    result["mode"] = rate > 0 ? "open" : "closed";
+    result["rate"] = rate;
+    result["keys"] = keys;
+    result["key_prefix"] = keyPrefix;
+    result["distribution"] = distribution;
+    if (distribution == "zipf")
+        result["zipf_exponent"] = zipfExponent;
+    result["value_min"] = valueMin;
+    result["value_max"] = valueMax;
+    result["read_ratio"] = readRatio;
+    result["interval_ms"] = interval;
+    result["seed"] = seed;
+    return result;
+}
+
+LoadGenerator::LoadGenerator(const LoadConfig &config, QObject *parent)
+    : QObject(parent),
+      m_config(config),
+      m_random(config.seed),
+      m_running(false),
+      m_finished(false),
+      m_stoppedAt(0),
+      m_scheduled(0),
+      m_completed(0),
+      m_intervalOps(0),
+      m_intervalErrors(0)
+{
+    m_value = QByteArray(m_config.valueMax, 'x');
+
+    if (m_config.distribution == "zipf") {
+        m_zipfCdf.resize(m_config.keys);
+        double sum = 0;
+
+        for (int i = 0; i < m_config.keys; ++i) {
+            sum += 1.0 / std::pow(i + 1, m_config.zipfExponent);
+            m_zipfCdf[i] = sum;
+        }
+
+        for (double& v : m_zipfCdf) v /= sum;
+    }
+
+    m_scheduler.setTimerType(Qt::PreciseTimer);
+    m_scheduler.setInterval(1);
+    QObject::connect(&m_scheduler, &QTimer::timeout, this, &LoadGenerator::schedule);
+
+    m_timeline.setTimerType(Qt::PreciseTimer);
+    m_timeline.setInterval(m_config.interval);
+    QObject::connect(&m_timeline, &QTimer::timeout, this, &LoadGenerator::sampleTimeline);
+}
+
+bool LoadGenerator::start(QString *error)
+{
+    RedisClient::ConnectionConfig config(m_config.host, m_config.auth, m_config.port,
+                                         "qredis-runner");
+    config.setCommandStats(true);
+
+    for (int i = 0; i < m_config.connections; ++i) {
+        Worker w;
+        w.connection = QSharedPointer<RedisClient::Connection>(
+                    new RedisClient::Connection(config, false));
+
+        try {
+            if (!w.connection->connect(true)) {
+                *error = QString("Cannot connect to %1:%2").arg(m_config.host).arg(m_config.port);
+                return false;
+            }
+        } catch (const RedisClient::Connection::Exception& e) {
+            *error = QString("Cannot connect: %1").arg(e.what());
+            return false;
+        }
+
+        if (m_config.cluster
+                && w.connection->mode() != RedisClient::Connection::Mode::Cluster) {
+            *error = "Target is not a redis cluster";
+            return false;
+        }
+
+        m_workers.append(w);
+    }
+
+    m_clock.start();
+    m_running = true;
+    m_timeline.start();
+
+    QTimer::singleShot(m_config.duration * 1000, this, &LoadGenerator::stop);
+
+    if (m_config.rate > 0) {
+        m_scheduler.start();
+    } else {
+        for (int w = 0; w < m_workers.size(); ++w) {
+            for (int i = 0; i < m_config.inflight; ++i) {
+                issue(w, now());
+            }
+        }
+    }
+
+    return true;
+}
+
+QVariantMap LoadGenerator::report() const
+{
+    auto operation = [](const Operation& op) {
+        QVariantMap result;
+        result["latency_us"] = op.latency.toVariantMap();
+        result["errors"] = op.errors;
+        return result;
+    };
+
+    double elapsed = m_stoppedAt / 1000000.0;
+    quint64 unsent = 0;
+    QVariantList connections;
+
+    for (const Worker& w : m_workers) {
+        unsent += w.backlog.size();
+        connections.append(w.connection->stats()->toVariantMap());
+    }
+
+    QVariantMap total;
+    total["ops"] = m_total.count();
+    total["completed"] = m_completed;
+    total["errors"] = m_reads.errors + m_writes.errors;
+    total["unsent"] = unsent;
+    total["throughput"] = elapsed > 0 ? m_total.count() / elapsed : 0;
+    total["latency_us"] = m_total.toVariantMap();
+
+    QVariantMap operations;
+    operations["GET"] = operation(m_reads);
+    operations["SET"] = operation(m_writes);
+
+    QVariantMap result;
+    result["config"] = m_config.toVariantMap();
+    result["elapsed_sec"] = elapsed;
+    result["total"] = total;
+    result["operations"] = operations;
+    result["timeline"] = m_samples;
+    result["connections"] = connections;
+    return result;
+}
+
+void LoadGenerator::issue(int worker, qint64 scheduledAt)
+{
+    Worker& w = m_workers[worker];
+    bool isRead = std::uniform_real_distribution<double>(0, 1)(m_random) < m_config.readRatio;
+
+    QList<QByteArray> cmd;
+
+    if (isRead)
+        cmd << "GET" << nextKey();
+    else
+        cmd << "SET" << nextKey() << m_value.left(nextValueSize());
+
+    w.inflight++;
+
+    try {
+        w.connection->command(cmd, this,
+                              [this, worker, isRead, scheduledAt](RedisClient::Response r, QString err) {
+            onResponse(worker, isRead, scheduledAt, r, err);
+        }, m_config.db);
+    } catch (const RedisClient::Connection::Exception&) {
+        // don't re-issue from here, connection is not usable
+        w.inflight--;
+        (isRead ? m_reads : m_writes).errors++;
+        m_intervalErrors++;
+    }
+}
+
+void LoadGenerator::onResponse(int worker, bool isRead, qint64 scheduledAt,
+                               const RedisClient::Response &r, const QString &err)
+{
+    if (m_finished) return;
+
+    Worker& w = m_workers[worker];
+    w.inflight--;
+
+    qint64 latency = now() - scheduledAt;
+    Operation& op = isRead ? m_reads : m_writes;
+
+    if (!err.isEmpty() || r.isErrorMessage()) {
+        op.errors++;
+        m_intervalErrors++;
+    } else {
+        op.latency.record(latency);
+        m_total.record(latency);
+        m_intervalLatency.record(latency);
+        m_intervalOps++;
+    }
+
+    m_completed++;
+
+    if (m_running) {
+        if (m_config.rate > 0) {
+            if (!w.backlog.isEmpty()) issue(worker, w.backlog.dequeue());
+        } else {
+            issue(worker, now());
+        }
+        return;
+    }
+
+    for (const Worker& other : m_workers) {
+        if (other.inflight > 0) return;
+    }
+
+    finish();
+}
+
+void LoadGenerator::schedule()
+{
+    if (!m_running) return;
+
+    quint64 due = static_cast<quint64>(m_config.rate * now() / 1000000.0);
+
+    while (m_scheduled < due) {
+        qint64 scheduledAt = static_cast<qint64>(m_scheduled * 1000000.0 / m_config.rate);
+        int worker = m_scheduled % m_workers.size();
+        m_scheduled++;
+
+        if (m_workers[worker].inflight < m_config.inflight)
+            issue(worker, scheduledAt);
+        else
+            m_workers[worker].backlog.enqueue(scheduledAt);
+    }
+}
+
+void LoadGenerator::sampleTimeline()
+{
+    double interval = m_config.interval / 1000.0;
+
+    QVariantMap sample;
+    sample["t"] = now() / 1000000.0;
+    sample["ops"] = m_intervalOps;
+    sample["errors"] = m_intervalErrors;
+    sample["throughput"] = m_intervalOps / interval;
+    sample["p50"] = m_intervalLatency.percentile(50);
+    sample["p99"] = m_intervalLatency.percentile(99);
+    sample["max"] = m_intervalLatency.max();
+    m_samples.append(sample);
+
+    m_intervalOps = 0;
+    m_intervalErrors = 0;
+    m_intervalLatency.reset();
+}
+
+void LoadGenerator::stop()
+{
+    if (!m_running) return;
+
+    m_running = false;
+    m_stoppedAt = now();
+    m_scheduler.stop();
+    m_timeline.stop();
+
+    if (m_intervalOps > 0 || m_intervalErrors > 0) sampleTimeline();
+
+    for (const Worker& w : m_workers) {
+        if (w.inflight > 0) {
+            QTimer::singleShot(DRAIN_TIMEOUT_MS, this, &LoadGenerator::finish);
+            return;
+        }
+    }
+
+    finish();
+}
+
+void LoadGenerator::finish()
+{
+    if (m_finished) return;
+
+    m_finished = true;
+
+    for (Worker& w : m_workers) {
+        w.connection->disconnect();
+    }
+
+    emit finished();
+}
+
+QByteArray LoadGenerator::nextKey()
+{
+    int index = 0;
+
+    if (m_zipfCdf.empty()) {
+        index = std::uniform_int_distribution<int>(0, m_config.keys - 1)(m_random);
+    } else {
+        double u = std::uniform_real_distribution<double>(0, 1)(m_random);
+        index = std::lower_bound(m_zipfCdf.begin(), m_zipfCdf.end(), u) - m_zipfCdf.begin();
+        index = qMin(index, m_config.keys - 1);
+    }
+
+    return m_config.keyPrefix.toUtf8() + QByteArray::number(index);
+}
+
+int LoadGenerator::nextValueSize()
+{
+    if (m_config.valueMin == m_config.valueMax) return m_config.valueMin;
+
+    return std::uniform_int_distribution<int>(m_config.valueMin, m_config.valueMax)(m_random);
+}
+
+qint64 LoadGenerator::now() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+#include <random>
+
+#include "qredisclient/connection.h"
+#include "qredisclient/stats.h"
+
+/**
+ * @brief The LoadConfig struct
+ * Workload description for LoadGenerator
+ */
+struct LoadConfig
+{
+    QString host = "127.0.0.1";
+    uint port = 6379;
+    QString auth;
+    int db = 0;
+    bool cluster = false;           // fail if target is not a cluster
+
+    int connections = 1;
+    int inflight = 1;               // max in-flight commands per connection
+    int duration = 10;              // seconds
+    double rate = 0;                // total ops/sec, 0 - closed loop
+
+    int keys = 10000;
+    QString keyPrefix = "qredis-runner:";
+    QString distribution = "uniform";   // uniform | zipf
+    double zipfExponent = 0.99;
+
+    int valueMin = 64;
+    int valueMax = 64;
+    double readRatio = 0.9;
+
+    int interval = 1000;            // timeline interval in ms
+    quint64 seed = 1;
+
+    bool parse(const QString& distributionSpec, const QString& valueSizeSpec,
+               QString* error);
+    QVariantMap toVariantMap() const;
+};
+
+/**
+ * @brief The LoadGenerator class
+ * Runs GET/SET workload against redis on N connections with up to M
+ * in-flight commands per connection.
+ *
+ * Closed loop: every connection keeps M commands in flight, next command is
+ * sent when response is received.
+ * Open loop: commands are scheduled at fixed rate, latency is measured from
+ * scheduled time (not from actual send time) so queueing caused by slow
+ * responses is reported instead of hidden (coordinated omission).
+ */
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    LoadGenerator(const LoadConfig& config, QObject* parent = nullptr);
+
+    bool start(QString* error);
+
+    /**
+     * @brief Machine readable report (latency in microseconds)
+     */
+    QVariantMap report() const;
+
+signals:
+    void finished();
+
+private:
+    struct Worker {
+        QSharedPointer<RedisClient::Connection> connection;
+        int inflight = 0;
+        QQueue<qint64> backlog;     // scheduled but not sent (open loop)
+    };
+
+    struct Operation {
+        RedisClient::LatencyHistogram latency;
+        quint64 errors = 0;
+    };
+
+    void issue(int worker, qint64 scheduledAt);
+    void onResponse(int worker, bool isRead, qint64 scheduledAt,
+                    const RedisClient::Response& r, const QString& err);
+    void schedule();
+    void sampleTimeline();
+    void stop();
+    void finish();
+
+    QByteArray nextKey();
+    int nextValueSize();
+
+    qint64 now() const;
+
+private:
+    LoadConfig m_config;
+    QVector<Worker> m_workers;
+    QByteArray m_value;
+    std::vector<double> m_zipfCdf;
+    std::mt19937_64 m_random;
+
+    QElapsedTimer m_clock;
+    QTimer m_scheduler;
+    QTimer m_timeline;
+    bool m_running;
+    bool m_finished;
+    qint64 m_stoppedAt;
+    quint64 m_scheduled;
+    quint64 m_completed;
+
+    Operation m_reads;
+    Operation m_writes;
+    RedisClient::LatencyHistogram m_total;
+    RedisClient::LatencyHistogram m_intervalLatency;
+    quint64 m_intervalOps;
+    quint64 m_intervalErrors;
+    QVariantList m_samples;
+};
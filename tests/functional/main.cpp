@@ -9,6 +9,65 @@
 
 #include <iostream>
 #include "qredisclient/redisclient.h"
+#include "loadgenerator.h"
+
+static int runLoad(QCoreApplication& app, const QCommandLineParser& parser)
+{
+    LoadConfig config;
+    config.host = parser.value("host");
+    config.port = parser.value("port").toUInt();
+    config.auth = parser.value("auth");
+    config.db = parser.value("db").toInt();
+    config.cluster = parser.isSet("cluster");
+    config.connections = parser.value("connections").toInt();
+    config.inflight = parser.value("inflight").toInt();
+    config.duration = parser.value("duration").toInt();
+    config.rate = parser.value("rate").toDouble();
+    config.keys = parser.value("keys").toInt();
+    config.keyPrefix = parser.value("key-prefix");
+    config.readRatio = parser.value("read-ratio").toDouble();
+    config.interval = parser.value("interval").toInt();
+    config.seed = parser.value("seed").toULongLong();
+
+    QString error;
+
+    if (!config.parse(parser.value("distribution"), parser.value("value-size"), &error)) {
+        std::cerr << error.toStdString() << std::endl;
+        return 1;
+    }
+
+    LoadGenerator generator(config);
+
+    QObject::connect(&generator, &LoadGenerator::finished, &app, [&app, &generator, &parser]() {
+        QByteArray report = QJsonDocument::fromVariant(generator.report()).toJson();
+
+        if (parser.isSet("output")) {
+            QFile out(parser.value("output"));
+
+            if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                std::cerr << "Cannot write report to " << out.fileName().toStdString() << std::endl;
+                app.exit(1);
+                return;
+            }
+            out.write(report);
+        } else {
+            std::cout << report.toStdString() << std::endl;
+        }
+
+        app.exit();
+    });
+
+    QTimer::singleShot(0, &generator, [&app, &generator]() {
+        QString error;
+
+        if (!generator.start(&error)) {
+            std::cerr << error.toStdString() << std::endl;
+            app.exit(2);
+        }
+    });
+
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
@@ -22,8 +81,33 @@ int main(int argc, char *argv[])
     parser.setApplicationDescription("qredis-runner powered by qredisclient");
     parser.addHelpOption();
     parser.addVersionOption();
+    parser.addPositionalArgument("file", "JSON file with commands to run on single connection");
+    parser.addOptions({
+        {"load", "Run load generator instead of commands file"},
+        {"host", "Redis host", "host", "127.0.0.1"},
+        {"port", "Redis port", "port", "6379"},
+        {"auth", "Redis password", "password"},
+        {"db", "Database index", "db", "0"},
+        {"cluster", "Require redis cluster, commands are routed by key slot"},
+        {"connections", "Number of connections", "n", "1"},
+        {"inflight", "Max in-flight commands per connection", "n", "1"},
+        {"duration", "Test duration in seconds", "sec", "10"},
+        {"rate", "Open loop: total ops/sec, 0 - closed loop", "ops", "0"},
+        {"keys", "Key space size", "n", "10000"},
+        {"key-prefix", "Key prefix", "prefix", "qredis-runner:"},
+        {"distribution", "Key distribution: uniform, zipf[:exponent]", "dist", "uniform"},
+        {"value-size", "SET value size: <bytes> or <min>:<max>", "size", "64"},
+        {"read-ratio", "Share of GET commands (0..1)", "ratio", "0.9"},
+        {"interval", "Timeline interval in ms", "ms", "1000"},
+        {"seed", "Random seed", "seed", "1"},
+        {"output", "Write JSON report to file instead of stdout", "file"},
+    });
     parser.process(app);
 
+    if (parser.isSet("load")) {
+        return runLoad(app, parser);
+    }
+
     QStringList positionals = parser.positionalArguments();
 
     if (positionals.size() == 0) {
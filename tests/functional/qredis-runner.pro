@@ -12,6 +12,10 @@ PROJECT_ROOT = $$PWD/../../
 DESTDIR = $$PWD/bin
 
 SOURCES += \
-    $$PWD/main.cpp
+    $$PWD/main.cpp \
+    $$PWD/loadgenerator.cpp
+
+HEADERS += \
+    $$PWD/loadgenerator.h
 
 include($$PROJECT_ROOT/qredisclient.pri)
@@ -7,8 +7,11 @@
 #include "test_command.h"
 #include "test_config.h"
 #include "test_connection.h"
+#include "test_fakeserver.h"
+#include "test_keys.h"
 #include "test_response.h"
 #include "test_responseparer.h"
+#include "test_stats.h"
 #include "test_text.h"
 #include "test_transporters.h"
 
@@ -22,16 +25,22 @@ int main(int argc, char *argv[]) {
   QScopedPointer<QObject> testResponseParser(new TestResponseParser);
   QScopedPointer<QObject> testConfig(new TestConfig);
   QScopedPointer<QObject> testText(new TestText);
+  QScopedPointer<QObject> testStats(new TestStats);
   QScopedPointer<QObject> testTransporters(new TestTransporters);
   QScopedPointer<QObject> testConnection(new TestConnection);
+  QScopedPointer<QObject> testFakeServer(new TestFakeServer);
+  QScopedPointer<QObject> testKeys(new TestKeys);
 
   int allTestsResult = 0 + QTest::qExec(testCommand.data(), argc, argv) +
                        QTest::qExec(testResponseParser.data(), argc, argv) +
                        QTest::qExec(testResponse.data(), argc, argv) +
                        QTest::qExec(testConfig.data(), argc, argv) +
                        QTest::qExec(testText.data(), argc, argv) +
+                       QTest::qExec(testStats.data(), argc, argv) +
                        QTest::qExec(testTransporters.data(), argc, argv) +
-                       QTest::qExec(testConnection.data(), argc, argv);
+                       QTest::qExec(testConnection.data(), argc, argv) +
+                       QTest::qExec(testFakeServer.data(), argc, argv) +
+                       QTest::qExec(testKeys.data(), argc, argv);
 
   if (allTestsResult == 0)
     qDebug() << "[Tests PASS]";
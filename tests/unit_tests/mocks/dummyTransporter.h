@@ -98,8 +98,7 @@ class DummyTransporter : public RedisClient::AbstractTransporter {
       resp = RedisClient::Response();
     }
 
-    m_runningCommands.enqueue(
-        QSharedPointer<RunningCommand>(new RunningCommand(cmd)));
+    m_runningCommands.enqueue(cmd);
 
     sendResponse(resp);
   }
@@ -45,8 +45,11 @@ class DummyConnection : public RedisClient::Connection {
     return m_version;
   }
 
-  void retrieveCollection(const RedisClient::ScanCommand&,
-                          Connection::CollectionCallback callback) override {
+  QSharedPointer<RedisClient::ScanHandle> retrieveCollection(
+      const RedisClient::ScanCommand&,
+      Connection::CollectionCallback callback) override {
+    QSharedPointer<RedisClient::ScanHandle> handle(
+        new RedisClient::ScanHandle());
     QVariant resp;
 
     if (fakeScanCollections.size()) {
@@ -55,7 +58,10 @@ class DummyConnection : public RedisClient::Connection {
     }
 
     retrieveCollectionCalled++;
+    handle->addRound(0, resp.toList().size());
+    handle->finish();
     callback(resp, QString());
+    return handle;
   }
 
   QFuture<RedisClient::Response> runCommand(
@@ -1,6 +1,7 @@
 #include "test_command.h"
 #include "qredisclient/command.h"
 #include "qredisclient/scancommand.h"
+#include "qredisclient/scancountcontroller.h"
 
 #include <QDebug>
 #include <QTest>
@@ -104,6 +105,62 @@ void TestCommand::scanCommandIsValid_data()
     QTest::newRow("Invalid value scan") << QList<QByteArray>{"set", "test", "0"} << false;
 }
 
+void TestCommand::scanCommandSetCount()
+{
+    //given
+    QFETCH(QList<QByteArray>, rawCommandString);
+    QFETCH(QList<QByteArray>, expected);
+    RedisClient::ScanCommand cmd(rawCommandString);
+
+    //when
+    cmd.setCount(500);
+
+    //then
+    QCOMPARE(cmd.getSplitedRepresentattion(), expected);
+    QCOMPARE(cmd.count(), 500L);
+}
+
+void TestCommand::scanCommandSetCount_data()
+{
+    QTest::addColumn<QList<QByteArray>>("rawCommandString");
+    QTest::addColumn<QList<QByteArray>>("expected");
+
+    QTest::newRow("Add to scan") << QList<QByteArray>{"scan", "0", "MATCH", "*"}
+                                 << QList<QByteArray>{"scan", "0", "MATCH", "*", "COUNT", "500"};
+    QTest::newRow("Replace in scan") << QList<QByteArray>{"scan", "0", "count", "10", "TYPE", "hash"}
+                                     << QList<QByteArray>{"scan", "0", "count", "500", "TYPE", "hash"};
+    QTest::newRow("Match count pattern") << QList<QByteArray>{"scan", "0", "MATCH", "count"}
+                                         << QList<QByteArray>{"scan", "0", "MATCH", "count", "COUNT", "500"};
+    QTest::newRow("Replace in hscan") << QList<QByteArray>{"hscan", "count", "0", "COUNT", "10"}
+                                      << QList<QByteArray>{"hscan", "count", "0", "COUNT", "500"};
+}
+
+void TestCommand::scanCountController()
+{
+    //given
+    RedisClient::ScanCountController controller(10000, 100);
+    RedisClient::ScanCountController loaded(10000, 1000);
+    RedisClient::ScanCountController limited(10000, 100);
+    limited.setMaxItemsPerRound(500);
+
+    //when
+    QList<long> steps;
+    for (int i = 0; i < 10; ++i) {
+        // 1 usec per COUNT unit
+        steps.append(controller.update(controller.count(), 0));
+        // 50 usec per COUNT unit
+        loaded.update(loaded.count() * 50, 0);
+        // every scanned key is returned
+        limited.update(limited.count(), limited.count());
+    }
+
+    //then
+    QCOMPARE(steps.first(), 200L);
+    QCOMPARE(controller.count(), 10000L);
+    QCOMPARE(loaded.count(), 200L);
+    QCOMPARE(limited.count(), 500L);
+}
+
 void TestCommand::pipelineCommand()
 {
     RedisClient::Command cmd;
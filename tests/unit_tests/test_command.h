@@ -17,6 +17,9 @@ private slots:
     void scanCommandSetCursor_data();
     void scanCommandIsValid();
     void scanCommandIsValid_data();
+    void scanCommandSetCount();
+    void scanCommandSetCount_data();
+    void scanCountController();
 
     void pipelineCommand();
 
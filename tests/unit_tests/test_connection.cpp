@@ -29,6 +29,19 @@ void TestConnection::connectToHostAndRunCommand() {
   QCOMPARE(actualResult.value().toString(), QString("PONG"));
 }
 
+void TestConnection::runCommandSync() {
+  // given
+  Connection connection(config);
+
+  // when
+  Response actualResult = connection.execSync({"PING"});
+
+  // then
+  QCOMPARE(actualResult.value().toString(), QString("PONG"));
+  QVERIFY_EXCEPTION_THROWN(connection.execSync({"DEBUG", "SLEEP", "1"}, -1, 10),
+                           Connection::Exception);
+}
+
 void TestConnection::testScanCommand() {
   // given
   Connection connection(config);
@@ -411,6 +424,26 @@ void TestConnection::testWithDummyTransporter() {
   QCOMPARE(actualResult.value().toString(), QString("PONG"));
 }
 
+void TestConnection::testLogRecordFormatting() {
+  // given
+  LogRecord sent(LogLevel::Debug, LogRecord::Event::CommandSent, 1);
+  sent.connectionName = "test";
+  sent.command = {"GET", "key"};
+
+  LogRecord response(LogLevel::Trace, LogRecord::Event::ResponseReceived, 1,
+                     {Response::Type::Status, QByteArray("OK")});
+  response.connectionName = "test";
+
+  LogRecord redirect(LogLevel::Info, LogRecord::Event::ClusterRedirect, 0,
+                     {"127.0.0.1", 7001});
+
+  // when & then
+  QCOMPARE(sent.toString(), QString("test > [runCommand] GET key"));
+  QCOMPARE(response.toString(), QString("test > Response received : OK"));
+  QCOMPARE(redirect.toString(),
+           QString("Cluster redirect to  127.0.0.1:7001"));
+}
+
 void TestConnection::testParseServerInfo() {
   // given
   QString testInfo(
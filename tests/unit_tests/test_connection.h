@@ -21,6 +21,7 @@ class TestConnection : public BaseTestCase {
   void testWithDummyTransporter();
 
   void testParseServerInfo();
+  void testLogRecordFormatting();
   void testConfig();
   void connectWithInvalidConfig();
 
@@ -31,6 +32,7 @@ class TestConnection : public BaseTestCase {
    */
   void connectAndDisconnect();
   void connectToHostAndRunCommand();
+  void runCommandSync();
   void connectWithAuth();
   void connectWithInvalidAuth();
 
@@ -0,0 +1,898 @@
+#include "test_fakeserver.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTest>
+#include "qredisclient/command.h"
+#include "qredisclient/connection.h"
+#include "qredisclient/keysnapshot.h"
+#include "qredisclient/stats.h"
+#include "qredisclient/transporters/defaulttransporter.h"
+#include "qredisclient/transporters/faultinjectingtransporter.h"
+#include "qredisclient/transporters/recordingtransporter.h"
+#include "qredisclient/transporters/replaytransporter.h"
+
+using namespace RedisClient;
+
+RedisClient::ConnectionConfig TestFakeServer::getConfig(
+    const FakeRedisServer &server) {
+  ConnectionConfig config(server.host(), "", server.port(), "fake");
+  config.setTimeouts(2000, 2000);
+  return config;
+}
+
+void TestFakeServer::runCommands() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  // when
+  connection.execSync({"SET", "str", "value"});
+  connection.execSync({"HSET", "hash", "f1", "v1", "f2", "v2"});
+  connection.execSync({"RPUSH", "list", "a", "b", "c"});
+  connection.execSync({"ZADD", "zset", "2", "b", "1", "a"});
+
+  // then
+  QCOMPARE(connection.mode(), Connection::Mode::Normal);
+  QCOMPARE(connection.execSync({"GET", "str"}).value().toByteArray(),
+           QByteArray("value"));
+  QCOMPARE(connection.execSync({"HLEN", "hash"}).value().toInt(), 2);
+  QCOMPARE(connection.execSync({"LRANGE", "list", "0", "-1"}).value().toList().size(), 3);
+  QCOMPARE(connection.execSync({"ZRANGE", "zset", "0", "-1"})
+               .value()
+               .toList()
+               .first()
+               .toByteArray(),
+           QByteArray("a"));
+  QVERIFY(connection.execSync({"LPUSH", "str", "x"}).isErrorMessage());
+  QCOMPARE(connection.execSync({"TYPE", "hash"}).value().toByteArray(),
+           QByteArray("hash"));
+}
+
+void TestFakeServer::scanKeys() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 25; ++i) {
+    connection.execSync({"SET", QByteArray("key:") + QByteArray::number(i), "1"});
+  }
+  connection.execSync({"SET", "other", "1"});
+
+  Connection::RawKeysList keys;
+  bool callbackCalled = false;
+
+  // when
+  connection.getDatabaseKeys(
+      [&keys, &callbackCalled](const Connection::RawKeysList &result,
+                               const QString &) {
+        keys = result;
+        callbackCalled = true;
+      },
+      "key:*", 0, 10);
+
+  // then
+  QTRY_VERIFY(callbackCalled);
+  QCOMPARE(keys.size(), 25);
+
+  Response hscan = connection.execSync(
+      {"HSCAN", "missing", "0", "MATCH", "*", "COUNT", "10"});
+  QVERIFY(hscan.isValidScanResponse());
+}
+
+void TestFakeServer::scanKeysPacked() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 25; ++i) {
+    connection.execSync({"SET", QByteArray("key:") + QByteArray::number(i), "1"});
+  }
+  connection.execSync({"SET", "other", "1"});
+
+  PackedKeyList keys;
+  bool callbackCalled = false;
+
+  // when
+  connection.getDatabaseKeysPacked(
+      [&keys, &callbackCalled](const PackedKeyList &result, const QString &) {
+        keys = result;
+        callbackCalled = true;
+      },
+      "key:*", 0, 10, true);
+
+  // then
+  QTRY_VERIFY(callbackCalled);
+  QCOMPARE(keys.size(), 25);
+  QVERIFY(keys.hasSlots());
+
+  QList<QByteArray> list = keys.toList();
+  std::sort(list.begin(), list.end());
+  QCOMPARE(list.first(), QByteArray("key:0"));
+  QCOMPARE(keys.slot(0), Command::calcKeyHashSlot(keys.at(0)));
+}
+
+void TestFakeServer::scanValueCollection() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 25; ++i) {
+    connection.execSync({"ZADD", "zset", QByteArray::number(i),
+                         QByteArray("m") + QByteArray::number(i)});
+  }
+
+  ValueCollection result;
+  bool callbackCalled = false;
+
+  // when
+  connection.retrieveValueCollection(
+      ScanCommand({"ZSCAN", "zset", "0", "COUNT", "10"}),
+      [&result, &callbackCalled](const ValueCollection &c, const QString &) {
+        result = c;
+        callbackCalled = true;
+      });
+
+  // then
+  QTRY_VERIFY(callbackCalled);
+  QCOMPARE(result.type(), ValueCollection::Type::SortedSet);
+  QCOMPARE(result.size(), 25);
+
+  double scores = 0;
+  for (double score : result.scores()) scores += score;
+
+  QCOMPARE(scores, 300.0);
+  QCOMPARE(result.page(24, 1).size(), 2);
+}
+
+void TestFakeServer::scanHandle() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 25; ++i) {
+    connection.execSync({"SET", QByteArray("key:") + QByteArray::number(i), "1"});
+  }
+
+  ScanCommand cmd({"SCAN", "0", "MATCH", "key:*", "COUNT", "10"});
+  QSharedPointer<ScanHandle> handle;
+  int batches = 0;
+  int keys = 0;
+  bool finished = false;
+
+  // when - paused after first round
+  handle = connection.retrieveCollectionIncrementally(
+      cmd, [&handle, &batches, &keys, &finished](QVariant r, QString,
+                                                  bool final) {
+        if (batches++ == 0) handle->pause();
+
+        keys += r.toList().size();
+        finished = final;
+      });
+
+  // then
+  QTRY_COMPARE(batches, 1);
+  QTest::qWait(200);
+  QCOMPARE(batches, 1);
+  QVERIFY(handle->isPaused());
+  QCOMPARE(handle->rounds(), 1);
+  QVERIFY(handle->cursor() > 0);
+  QCOMPARE(handle->items(), qint64(keys));
+
+  // when - resumed
+  handle->resume();
+
+  // then
+  QTRY_VERIFY(finished);
+  QVERIFY(handle->isFinished());
+  QCOMPARE(handle->cursor(), 0ll);
+  QCOMPARE(handle->items(), 25ll);
+  QCOMPARE(keys, 25);
+
+  // when - canceled with round in flight
+  int callbacks = 0;
+  QString canceledError;
+  auto canceled = connection.getDatabaseKeys(
+      [&callbacks, &canceledError](const Connection::RawKeysList &,
+                                   const QString &err) {
+        callbacks++;
+        canceledError = err;
+      },
+      "key:*", 0, 10);
+  canceled->cancel();
+
+  // then - round in flight is discarded, final callback reports cancel
+  QTRY_COMPARE(callbacks, 1);
+  QVERIFY(canceledError.contains("canceled"));
+  QVERIFY(canceled->isCanceled());
+  QCOMPARE(canceled->items(), 0ll);
+
+  canceled->resume();
+  canceled->cancel();
+  QTest::qWait(100);
+  QCOMPARE(callbacks, 1);
+
+  // when - canceled while paused
+  bool pausedFinal = false;
+  QString pausedError;
+  QSharedPointer<ScanHandle> paused;
+  paused = connection.retrieveCollectionIncrementally(
+      cmd, [&paused, &pausedFinal, &pausedError](QVariant, QString err,
+                                                  bool final) {
+        paused->pause();
+        pausedError = err;
+        pausedFinal = final;
+      });
+
+  QTRY_VERIFY(paused->isPaused() && paused->rounds() == 1);
+  paused->cancel();
+
+  // then
+  QTRY_VERIFY(pausedFinal);
+  QVERIFY(pausedError.contains("canceled"));
+
+  // when - paused scan is dropped without cancel()
+  QWeakPointer<ScanHandle> dropped;
+  {
+    QSharedPointer<ScanHandle> handle;
+    handle = connection.retrieveCollectionIncrementally(
+        cmd, [&handle](QVariant, QString, bool) {
+          if (handle) handle->pause();
+        });
+    dropped = handle;
+    QTRY_VERIFY(handle->isPaused() && handle->rounds() == 1);
+    handle.clear();
+  }
+
+  // then - continuation doesn't keep it alive
+  QTRY_VERIFY(dropped.isNull());
+}
+
+void TestFakeServer::keyIndexSnapshot() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  ConnectionConfig config = getConfig(server);
+  config.setKeySnapshotDir(dir.path());
+  Connection connection(config);
+
+  for (int i = 0; i < 25; ++i) {
+    connection.execSync({"SET", QByteArray("key:") + QByteArray::number(i), "1"});
+  }
+
+  QList<QPair<QSharedPointer<KeyIndex>, bool>> loaded;
+  auto callback = [&loaded](QSharedPointer<KeyIndex> index, const QString &,
+                            bool final) { loaded.append({index, final}); };
+
+  // when - first load, no snapshot yet
+  connection.loadKeyIndex(callback, ":", 0, 10);
+
+  // then
+  QTRY_COMPARE(loaded.size(), 1);
+  QVERIFY(loaded.first().second);
+  QCOMPARE(loaded.first().first->size(), 25);
+  QTRY_VERIFY(KeySnapshot::exists(KeySnapshot::path(config, 0)));
+
+  // when - snapshot is opened right away and reconciled by scan
+  loaded.clear();
+  connection.execSync({"DEL", "key:0"});
+  connection.execSync({"SET", "other", "1"});
+  connection.loadKeyIndex(callback, ":", 0, 10);
+
+  // then
+  QCOMPARE(loaded.size(), 1);
+  QVERIFY(!loaded.first().second);
+  QCOMPARE(loaded.first().first->namespaceKeysCount("key"), 25ul);
+
+  QTRY_COMPARE(loaded.size(), 2);
+  QVERIFY(loaded.last().second);
+  QCOMPARE(loaded.last().first->namespaceKeysCount("key"), 24ul);
+  QVERIFY(loaded.last().first->contains("other"));
+}
+
+void TestFakeServer::keysMetadata() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 20; ++i) {
+    connection.execSync({"SET", QByteArray("str:") + QByteArray::number(i), "1"});
+  }
+  connection.execSync({"HSET", "hash", "f", "v"});
+
+  KeyMetadataList records;
+  QString error;
+  bool finished = false;
+  int batches = 0;
+
+  // when
+  connection.getDatabaseKeysMetadata(
+      [&](const KeyMetadataList &batch, const QString &err, bool final) {
+        records.append(batch);
+        error = err;
+        finished = final;
+        ++batches;
+      },
+      "*", 0, 5);
+
+  // then
+  QTRY_VERIFY(finished);
+  QVERIFY(error.isEmpty());
+  QVERIFY(batches > 1);
+  QCOMPARE(records.size(), 21);
+
+  for (const KeyMetadata &m : records) {
+    bool isHash = m.key == "hash";
+    QCOMPARE(m.type, QByteArray(isHash ? "hash" : "string"));
+    QCOMPARE(m.ttl, qint64(-1));
+    QVERIFY(m.memoryUsage > 0);
+    QCOMPARE(m.encoding, QByteArray(isHash ? "listpack" : "int"));
+  }
+
+  // when
+  KeyMetadataList missing;
+  connection.loadKeysMetadata(
+      {"missing"}, KeyMetadata::Type | KeyMetadata::Ttl, 0,
+      [&missing](const KeyMetadataList &result, const QString &) {
+        missing = result;
+      });
+
+  // then
+  QTRY_COMPARE(missing.size(), 1);
+  QCOMPARE(missing.first().type, QByteArray("none"));
+  QCOMPARE(missing.first().ttl, qint64(-2));
+  QCOMPARE(missing.first().memoryUsage, qint64(-1));
+}
+
+void TestFakeServer::keysMetadataOnDisconnect() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  auto transporter =
+      new FaultInjectingTransporter<DefaultTransporter>(&connection);
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(transporter));
+
+  connection.execSync({"SET", "foo", "bar"});
+
+  FaultConfig faults;
+  faults.latency = 500000;
+  faults.disconnectEvery = 1;
+  faults.requeueOnDisconnect = false;
+  transporter->setFaults(faults);
+
+  // when
+  int calls = 0;
+  QString error;
+  connection.loadKeysMetadata(
+      {"foo"}, KeyMetadata::Type | KeyMetadata::Ttl, 0,
+      [&calls, &error](const KeyMetadataList &, const QString &err) {
+        calls++;
+        error = err;
+      });
+
+  // then
+  QTRY_COMPARE(calls, 1);
+  QVERIFY(!error.isEmpty());
+  QTest::qWait(100);
+  QCOMPARE(calls, 1);
+}
+
+void TestFakeServer::namespaceItemsIncrementally() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  for (int i = 0; i < 30; ++i) {
+    connection.execSync({"SET",
+                         QByteArray("user:") + QByteArray::number(i % 3) +
+                             ":" + QByteArray::number(i),
+                         "1"});
+    connection.execSync({"SET", QByteArray("session:") + QByteArray::number(i), "1"});
+  }
+  connection.execSync({"SET", "plain", "1"});
+  connection.execSync({"SET", "user:root", "1"});
+
+  QMap<QByteArray, ulong> namespaces;
+  QList<QByteArray> keys;
+  QString error;
+  bool finished = false;
+
+  auto merge = [&](const Connection::NamespaceItems &items, const QString &err,
+                   bool final) {
+    for (auto ns : items.first) namespaces[ns.first] = ns.second;
+    keys.append(items.second);
+    error = err;
+    finished = final;
+  };
+
+  // when
+  connection.getNamespaceItemsIncrementally(merge, ":", "*", 0, 5);
+
+  // then
+  QTRY_VERIFY(finished);
+  QVERIFY(error.isEmpty());
+  QCOMPARE(namespaces.size(), 2);
+  QCOMPARE(namespaces.value("session"), 30ul);
+  QCOMPARE(namespaces.value("user"), 31ul);
+  QCOMPARE(keys, QList<QByteArray>{"plain"});
+
+  // when
+  namespaces.clear();
+  keys.clear();
+  finished = false;
+  connection.getNamespaceItemsIncrementally(merge, ":", "user:", 0, 5);
+
+  // then
+  QTRY_VERIFY(finished);
+  QCOMPARE(namespaces.size(), 3);
+  QCOMPARE(namespaces.value("user:0"), 10ul);
+  QCOMPARE(keys, QList<QByteArray>{"user:root"});
+}
+
+void TestFakeServer::evalScriptWithCache() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  ConnectionConfig config = getConfig(server);
+  config.setCommandStats(true);
+  Connection connection(config);
+  QByteArray script("return ARGV[1]");
+  QList<QVariant> results;
+
+  auto evalScript = [&connection, &script, &results]() {
+    connection.evalScript(
+        script, {}, {"arg"}, &connection,
+        [&results](const Response &r, const QString &err) {
+          results.append(err.isEmpty() ? r.value() : QVariant(err));
+        });
+  };
+  auto sentCommands = [&connection](const QByteArray &name) {
+    return connection.stats()->command(name)->networkRtt.count();
+  };
+
+  // when
+  evalScript();
+  QTRY_COMPARE(results.size(), 1);
+  evalScript();
+  QTRY_COMPARE(results.size(), 2);
+  connection.execSync({"SCRIPT", "FLUSH"});
+  evalScript();
+  QTRY_COMPARE(results.size(), 3);
+
+  // then
+  for (const QVariant &result : results)
+    QCOMPARE(result.toList(), QVariantList{QByteArray("arg")});
+
+  QCOMPARE(sentCommands("EVAL"), 2ull);
+  QCOMPARE(sentCommands("EVALSHA"), 2ull);
+
+  // when
+  Connection other(getConfig(server));
+  other.scripts()->add(script);
+  bool preloaded = false;
+  QString preloadError;
+  other.preloadScripts([&preloaded, &preloadError](const QString &err) {
+    preloadError = err;
+    preloaded = true;
+  });
+
+  // then
+  QTRY_VERIFY(preloaded);
+  QVERIFY(preloadError.isEmpty());
+  QVERIFY(other.scripts()->isLoaded(
+      QString("%1:%2").arg(server.host()).arg(server.port()),
+      RedisClient::ScriptCache::sha1(script)));
+}
+
+void TestFakeServer::subscribe() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection subscriber(getConfig(server));
+  Connection publisher(getConfig(server));
+  QList<Response> received;
+
+  QVERIFY(subscriber.connect());
+
+  // when
+  subscriber.command({"SUBSCRIBE", "news"}, this,
+                     [&received](Response r, QString) { received.append(r); });
+
+  QTRY_COMPARE(received.size(), 1);
+  Response published = publisher.execSync({"PUBLISH", "news", "hello"});
+
+  // then
+  QCOMPARE(published.value().toInt(), 1);
+  QTRY_COMPARE(received.size(), 2);
+  QVERIFY(received.last().isMessage());
+  QCOMPARE(received.last().value().toList().last().toByteArray(),
+           QByteArray("hello"));
+}
+
+void TestFakeServer::clusterMovedRedirect() {
+  // given
+  FakeRedisServer server(3);
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  connection.execSync({"SET", "foo", "bar"});
+  QCOMPARE(connection.mode(), Connection::Mode::Cluster);
+
+  int slot = Command::calcKeyHashSlot("foo");
+  server.moveSlot(slot, (server.slotOwner(slot) + 1) % 3);
+
+  // when
+  Response result = connection.execSync({"GET", "foo"});
+
+  // then
+  QCOMPARE(result.value().toByteArray(), QByteArray("bar"));
+  QVERIFY(connection.stats()->redirects() > 0);
+}
+
+void TestFakeServer::clusterAskRedirect() {
+  // given
+  FakeRedisServer server(3);
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  connection.execSync({"SET", "foo", "bar"});
+
+  int slot = Command::calcKeyHashSlot("foo");
+  server.setAskRedirect(slot, (server.slotOwner(slot) + 1) % 3);
+
+  // when
+  Response result = connection.execSync({"GET", "foo"});
+
+  // then
+  QCOMPARE(result.value().toByteArray(), QByteArray("bar"));
+  QCOMPARE(connection.stats()->redirects(), quint64(1));
+}
+
+void TestFakeServer::recordAndReplay() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+
+  QBuffer recording;
+  recording.open(QIODevice::ReadWrite);
+
+  QList<QList<QByteArray>> commands{
+      {"SET", "foo", "bar"}, {"GET", "foo"}, {"HSET", "h", "f", "v"},
+      {"HGETALL", "h"}};
+  QList<QVariant> recordedResults;
+
+  {
+    Connection connection(getConfig(server));
+    QSharedPointer<TrafficRecorder> recorder(new TrafficRecorder(&recording));
+    connection.setTransporter(QSharedPointer<AbstractTransporter>(
+        new RecordingTransporter<DefaultTransporter>(&connection, recorder)));
+
+    for (auto cmd : commands) {
+      recordedResults.append(connection.execSync(cmd).value());
+    }
+  }
+  server.stop();
+
+  QVector<TrafficChunk> chunks;
+  recording.seek(0);
+  QVERIFY(TrafficRecorder::load(&recording, &chunks));
+
+  // when
+  Connection connection(getConfig(server));
+  QSharedPointer<ReplayTransporter> replay(
+      new ReplayTransporter(&connection, chunks));
+  connection.setTransporter(replay.dynamicCast<AbstractTransporter>());
+
+  QList<QVariant> replayedResults;
+
+  for (auto cmd : commands) {
+    replayedResults.append(connection.execSync(cmd).value());
+  }
+
+  // then
+  QCOMPARE(replayedResults, recordedResults);
+  QCOMPARE(replay->mismatchedCommands(), 0);
+  QTRY_VERIFY(replay->isFinished());
+}
+
+void TestFakeServer::injectedLatencyAndFragments() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  ConnectionConfig config = getConfig(server);
+  config.setCommandStats(true);
+  Connection connection(config);
+
+  FaultConfig faults;
+  faults.latency = 20000;
+  faults.jitter = 5000;
+  faults.maxFragmentSize = 7;
+  faults.randomFragments = true;
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(
+      new FaultInjectingTransporter<DefaultTransporter>(&connection, faults)));
+
+  QByteArray value(1000, 'v');
+
+  // when
+  connection.execSync({"SET", "foo", value});
+  Response result = connection.execSync({"GET", "foo"});
+
+  // then
+  QCOMPARE(result.value().toByteArray(), value);
+  QVERIFY(connection.stats()->command("GET")->networkRtt.min() >= 20000);
+}
+
+void TestFakeServer::injectedDisconnects() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  FaultConfig faults;
+  faults.disconnectEvery = 3;
+  auto transporter = new FaultInjectingTransporter<DefaultTransporter>(
+      &connection, faults);
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(transporter));
+
+  connection.execSync({"SET", "foo", "bar"});
+
+  // when
+  for (int i = 0; i < 10; ++i) {
+    Response result = connection.execSync({"GET", "foo"});
+
+    // then
+    QCOMPARE(result.value().toByteArray(), QByteArray("bar"));
+  }
+
+  QVERIFY(transporter->injectedDisconnects() >= 3);
+  QVERIFY(connection.stats()->reconnects() >= 3);
+}
+
+void TestFakeServer::injectedBandwidthAndDisconnect() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  FaultConfig faults;
+  faults.bandwidth = 20000;
+  auto transporter = new FaultInjectingTransporter<DefaultTransporter>(
+      &connection, faults);
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(transporter));
+
+  QByteArray value(1000, 'v');
+  connection.execSync({"SET", "foo", value});
+
+  // when - response is read in bursts limited by bandwidth
+  Response result = connection.execSync({"GET", "foo"});
+
+  // then
+  QCOMPARE(result.value().toByteArray(), value);
+
+  // when - delayed read is scheduled when connection is closed
+  faults.latency = 100000;
+  transporter->setFaults(faults);
+  connection.command({"GET", "foo"});
+  QTest::qWait(20);
+  connection.disconnect();
+  QTest::qWait(200);
+
+  // then
+  QVERIFY(!connection.isConnected());
+}
+
+void TestFakeServer::execSyncOnDisconnect() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+
+  auto transporter =
+      new FaultInjectingTransporter<DefaultTransporter>(&connection);
+  connection.setTransporter(QSharedPointer<AbstractTransporter>(transporter));
+
+  connection.execSync({"SET", "foo", "bar"});
+
+  FaultConfig faults;
+  faults.latency = 500000;
+  faults.disconnectEvery = 1;
+  faults.requeueOnDisconnect = false;
+  transporter->setFaults(faults);
+
+  // when
+  QElapsedTimer timer;
+  timer.start();
+  QString error;
+
+  try {
+    connection.execSync({"GET", "foo"}, -1, 10000);
+  } catch (const Connection::Exception &e) {
+    error = e.what();
+  }
+
+  // then
+  QCOMPARE(error, QString("Connection was interrupted"));
+  QVERIFY(timer.elapsed() < 5000);
+}
+
+void TestFakeServer::commandStatsOptIn() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+  ConnectionConfig config = getConfig(server);
+  config.setCommandStats(true);
+  Connection statsConnection(config);
+
+  // when
+  connection.execSync({"SET", "foo", "bar"});
+  statsConnection.execSync({"SET", "foo", "bar"});
+  statsConnection.execSync({"get", "foo"});
+  statsConnection.execSync({"GET", "foo"});
+
+  // then
+  QVERIFY(connection.stats()->commandNames().isEmpty());
+  QVERIFY(connection.stats()->bytesOut() > 0);
+  QCOMPARE(statsConnection.stats()->command("GET")->networkRtt.count(), 2ull);
+
+  // when
+  statsConnection.stats()->reset();
+  statsConnection.execSync({"GET", "foo"});
+
+  // then
+  QCOMPARE(statsConnection.stats()->commandNames(), QList<QByteArray>{"GET"});
+  QCOMPARE(statsConnection.stats()->command("GET")->networkRtt.count(), 1ull);
+}
+
+void TestFakeServer::logRecords() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  Connection connection(getConfig(server));
+  QList<LogRecord::Event> events;
+
+  QObject::connect(&connection, &Connection::logRecord,
+                   [&events](const LogRecord &r) { events.append(r.event); });
+
+  // when
+  connection.execSync({"SET", "foo", "bar"});
+
+  // then
+  QVERIFY(connection.logLevel() == LogLevel::Info);
+  QTRY_VERIFY(events.contains(LogRecord::Event::Connected));
+  QVERIFY(!events.contains(LogRecord::Event::CommandSent));
+
+  // when
+  connection.setLogLevel(LogLevel::Debug);
+  connection.execSync({"GET", "foo"});
+
+  // then
+  QTRY_VERIFY(events.contains(LogRecord::Event::CommandSent));
+
+  // when - plain text listener at default level
+  Connection textConnection(getConfig(server));
+  QStringList messages;
+
+  QObject::connect(&textConnection, &Connection::log,
+                   [&messages](const QString &m) { messages.append(m); });
+
+  textConnection.execSync({"GET", "foo"});
+
+  // then
+  QVERIFY(textConnection.logLevel() == LogLevel::Info);
+  QTRY_VERIFY(!messages.filter("[runCommand] GET foo").isEmpty());
+}
+
+void TestFakeServer::clusterScriptCache() {
+  // given
+  FakeRedisServer server(3);
+  QVERIFY(server.start());
+  ConnectionConfig config = getConfig(server);
+  config.setCommandStats(true);
+  Connection connection(config);
+  QByteArray script("return KEYS[1]");
+
+  connection.execSync({"PING"});
+  QCOMPARE(connection.mode(), Connection::Mode::Cluster);
+
+  // One key per node
+  QList<QByteArray> keys;
+  for (int i = 0; keys.size() < 3 && i < 1000; ++i) {
+    QByteArray key = QByteArray("key:") + QByteArray::number(i);
+    int owner = server.slotOwner(Command::calcKeyHashSlot(key));
+
+    if (owner == keys.size()) keys.append(key);
+  }
+  QCOMPARE(keys.size(), 3);
+
+  connection.scripts()->add(script);
+  bool preloaded = false;
+  QString preloadError;
+
+  // when
+  connection.preloadScripts([&preloaded, &preloadError](const QString &err) {
+    preloadError = err;
+    preloaded = true;
+  });
+
+  // then
+  QTRY_VERIFY(preloaded);
+  QVERIFY(preloadError.isEmpty());
+
+  for (quint16 port : server.ports()) {
+    QVERIFY(connection.scripts()->isLoaded(
+        QString("%1:%2").arg(server.host()).arg(port),
+        RedisClient::ScriptCache::sha1(script)));
+  }
+
+  // when
+  QList<QVariant> results;
+
+  for (const QByteArray &key : keys) {
+    connection.evalScript(
+        script, {key}, {}, &connection,
+        [&results](const Response &r, const QString &err) {
+          results.append(err.isEmpty() ? r.value() : QVariant(err));
+        });
+    QTRY_COMPARE(results.size(), keys.indexOf(key) + 1);
+  }
+
+  // then
+  for (int i = 0; i < keys.size(); ++i)
+    QCOMPARE(results.at(i).toList(), QVariantList{keys.at(i)});
+
+  QCOMPARE(connection.stats()->command("EVALSHA")->networkRtt.count(), 3ull);
+  QCOMPARE(connection.stats()->command("EVAL")->networkRtt.count(), 0ull);
+}
+
+void TestFakeServer::scanMaxItemsPerRound() {
+  // given
+  FakeRedisServer server;
+  QVERIFY(server.start());
+  ConnectionConfig config = getConfig(server);
+  config.setScanTargetLatency(1000);
+  config.setScanMaxItemsPerRound(20);
+  Connection connection(config);
+
+  for (int i = 0; i < 300; ++i) {
+    connection.execSync({"SET", QByteArray("key:") + QByteArray::number(i), "1"});
+  }
+
+  ScanCommand cmd({"SCAN", "0", "MATCH", "key:*", "COUNT", "100"});
+  QList<int> rounds;
+  bool finished = false;
+
+  // when
+  connection.retrieveCollectionIncrementally(
+      cmd, [&rounds, &finished](QVariant r, QString, bool final) {
+        if (!r.toList().isEmpty()) rounds.append(r.toList().size());
+        finished = final;
+      });
+
+  // then
+  QTRY_VERIFY(finished);
+
+  int total = 0;
+  for (int i = 0; i < rounds.size(); ++i) {
+    total += rounds.at(i);
+
+    // COUNT is at most halved per round: 100, 50, 25, 20...
+    if (i >= 3) QVERIFY(rounds.at(i) <= 20);
+  }
+
+  QCOMPARE(rounds.first(), 100);
+  QVERIFY(rounds.size() > 4);
+  QCOMPARE(total, 300);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+#include "basetestcase.h"
+#include "fakeredisserver.h"
+
+/*
+ * End-to-end tests of DefaultTransporter against in-process RESP server
+ */
+class TestFakeServer : public BaseTestCase {
+  Q_OBJECT
+
+ private slots:
+  void runCommands();
+  void scanKeys();
+  void scanKeysPacked();
+  void scanValueCollection();
+  void scanHandle();
+  void scanMaxItemsPerRound();
+  void keyIndexSnapshot();
+  void keysMetadata();
+  void keysMetadataOnDisconnect();
+  void namespaceItemsIncrementally();
+  void evalScriptWithCache();
+  void clusterScriptCache();
+  void subscribe();
+  void clusterMovedRedirect();
+  void clusterAskRedirect();
+  void recordAndReplay();
+  void injectedLatencyAndFragments();
+  void injectedDisconnects();
+  void injectedBandwidthAndDisconnect();
+  void execSyncOnDisconnect();
+  void commandStatsOptIn();
+  void logRecords();
+
+ private:
+  RedisClient::ConnectionConfig getConfig(const FakeRedisServer& server);
+};
@@ -0,0 +1,324 @@
+#include "test_keys.h"
+#include "qredisclient/command.h"
+#include "qredisclient/keyindex.h"
+#include "qredisclient/keysnapshot.h"
+#include "qredisclient/namespaceaggregator.h"
+#include "qredisclient/packedkeylist.h"
+#include "qredisclient/scandedupset.h"
+#include "qredisclient/valuecollection.h"
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace RedisClient;
+
+void TestKeys::packedKeyList() {
+  // given
+  PackedKeyList keys;
+  QByteArray binaryKey("bin\x00key", 7);
+
+  // when
+  keys.append(QVariantList{QByteArray("first"), QByteArray()});
+  keys.append(binaryKey);
+  keys.append(PackedKeyList::fromList({"last"}));
+
+  // then
+  QCOMPARE(keys.size(), 4);
+  QCOMPARE(keys.bytes(), 5 + 0 + 7 + 4);
+  QCOMPARE(keys.at(0), QByteArray("first"));
+  QVERIFY(keys.at(1).isEmpty());
+  QCOMPARE(keys.rawAt(2), binaryKey);
+  QCOMPARE(keys.keySize(3), 4);
+  QCOMPARE(keys.toList(), QList<QByteArray>({"first", "", binaryKey, "last"}));
+  QVERIFY(!keys.hasSlots());
+
+  // when
+  PackedKeyList copy = keys;
+  keys.clear();
+
+  // then
+  QVERIFY(keys.isEmpty());
+  QCOMPARE(copy.size(), 4);
+
+  // when - list over external data is modified
+  const char arena[] = "ab";
+  const qint32 offsets[] = {0, 1, 2};
+  PackedKeyList raw = PackedKeyList::fromRawData(arena, offsets, 2);
+  PackedKeyList modified = raw;
+  modified.append(QByteArray("c"));
+
+  // then
+  QCOMPARE(raw.toList(), QList<QByteArray>({"a", "b"}));
+  QCOMPARE(modified.toList(), QList<QByteArray>({"a", "b", "c"}));
+  QVERIFY(raw.keyData(0) == arena);
+}
+
+void TestKeys::packedKeyListSlots() {
+  // given
+  PackedKeyList keys(true);
+  PackedKeyList withoutSlots;
+  withoutSlots.append(QByteArray("{user1}:name"));
+
+  // when
+  keys.append(QByteArray("foo"));
+  keys.append(withoutSlots);
+
+  // then
+  QCOMPARE(keys.slot(0), Command::calcKeyHashSlot("foo"));
+  QCOMPARE(keys.slot(1), Command::calcKeyHashSlot("user1"));
+}
+
+void TestKeys::scanDedupSet() {
+  // given
+  ScanDedupSet seen;
+  QByteArray binaryKey("bin\x00key", 7);
+
+  // when - enough keys to grow table few times
+  for (int i = 0; i < 5000; ++i) {
+    QVERIFY(seen.insert(QByteArray("key:") + QByteArray::number(i)));
+  }
+
+  // then
+  QCOMPARE(seen.size(), 5000);
+  QVERIFY(!seen.insert(QByteArray("key:0")));
+  QVERIFY(!seen.insert(QByteArray("key:4999")));
+  QVERIFY(seen.contains("key:2500"));
+  QVERIFY(!seen.contains("key:5000"));
+  QVERIFY(seen.insert(QByteArray()));
+  QVERIFY(!seen.insert(QByteArray()));
+  QVERIFY(seen.insert(binaryKey));
+  QVERIFY(!seen.contains(QByteArray("bin")));
+  QCOMPARE(seen.size(), 5002);
+  QVERIFY(seen.memoryUsage() > 0);
+
+  // when
+  seen.clear();
+
+  // then
+  QVERIFY(seen.isEmpty());
+  QVERIFY(!seen.contains("key:0"));
+}
+
+void TestKeys::scanDedupSetFilter() {
+  // given
+  ScanDedupSet seen;
+  QVariantList firstRound{QByteArray("a"), QByteArray("1"), QByteArray("b"),
+                          QByteArray("2")};
+  QVariantList secondRound{QByteArray("b"), QByteArray("2"), QByteArray("c"),
+                           QByteArray("3"), QByteArray("a"), QByteArray("1")};
+
+  // when
+  int firstRemoved = seen.filter(firstRound, 2);
+  int secondRemoved = seen.filter(secondRound, 2);
+
+  // then
+  QCOMPARE(firstRemoved, 0);
+  QCOMPARE(firstRound.size(), 4);
+  QCOMPARE(secondRemoved, 2);
+  QCOMPARE(secondRound,
+           QVariantList({QByteArray("c"), QByteArray("3")}));
+
+  // when - keys
+  QVariantList keys{QByteArray("c"), QByteArray("d"), QByteArray("d")};
+
+  // then
+  QCOMPARE(seen.filter(keys), 2);
+  QCOMPARE(keys, QVariantList({QByteArray("d")}));
+}
+
+void TestKeys::keyIndexQueries() {
+  // given
+  KeyIndex index;
+
+  // when - duplicates in one batch and between batches
+  index.addKeys(QVariantList{QByteArray("user:2"), QByteArray("user:1"),
+                             QByteArray("post:1"), QByteArray("user:1")});
+  index.addKeys(PackedKeyList::fromList({"user:10", "post:1", "session"}));
+  index.addKey("user:1:name");
+
+  // then
+  QCOMPARE(index.size(), 6);
+  QCOMPARE(index.at(0), QByteArray("post:1"));
+  QVERIFY(index.contains("user:10"));
+  QVERIFY(!index.contains("user"));
+  QCOMPARE(index.prefixMatch("user:1"),
+           QList<QByteArray>({"user:1", "user:10", "user:1:name"}));
+  QCOMPARE(index.prefixMatch("user:", 2),
+           QList<QByteArray>({"user:1", "user:10"}));
+  QCOMPARE(index.globMatch("user:?"), QList<QByteArray>({"user:1", "user:2"}));
+  QCOMPARE(index.globMatch("*:1"), QList<QByteArray>({"post:1", "user:1"}));
+  QCOMPARE(index.globMatch("user:[^1]*"), QList<QByteArray>({"user:2"}));
+  QCOMPARE(index.substringMatch("ess"), QList<QByteArray>({"session"}));
+  QVERIFY(index.prefixMatch("zzz").isEmpty());
+
+  // when
+  QVERIFY(index.removeKey("user:1"));
+  QVERIFY(!index.removeKey("user:1"));
+  index.addKey("user:1");
+
+  // then
+  QCOMPARE(index.size(), 6);
+  QCOMPARE(index.namespaceKeysCount("user"), 4ul);
+  QVERIFY(index.memoryUsage() > 0);
+}
+
+void TestKeys::keyIndexNamespaces_data() {
+  QTest::addColumn<QByteArray>("filter");
+
+  QTest::newRow("All") << QByteArray("*");
+  QTest::newRow("Namespace") << QByteArray("user:");
+  QTest::newRow("Nested namespace") << QByteArray("user:1:");
+  QTest::newRow("Partial name") << QByteArray("user:1");
+  QTest::newRow("Glob") << QByteArray("*:1");
+  QTest::newRow("Missing") << QByteArray("missing:");
+}
+
+void TestKeys::keyIndexNamespaces() {
+  // given
+  QFETCH(QByteArray, filter);
+
+  QVariantList keys{QByteArray("user:1:name"), QByteArray("user:1:age"),
+                    QByteArray("user:2:name"), QByteArray("user:10"),
+                    QByteArray("user!b:1"),    QByteArray("user"),
+                    QByteArray("post:1"),      QByteArray("post:1:tags"),
+                    QByteArray("session")};
+
+  KeyIndex index;
+  index.addKeys(keys);
+
+  // Filtered like SCAN MATCH <filter>*
+  NamespaceAggregator aggregator(":", filter);
+  for (const QVariant& key : keys) {
+    if (KeyIndex::matchGlob(aggregator.matchPattern(),
+                            key.toByteArray().constData(),
+                            key.toByteArray().size()))
+      aggregator.addKey(key.toByteArray());
+  }
+
+  // when
+  KeyIndex::NamespaceItems items = index.namespaceItems(filter);
+
+  // then
+  QCOMPARE(items, aggregator.items());
+}
+
+void TestKeys::keyIndexNotifications() {
+  // given
+  KeyIndex index(":", 1);
+  index.addKeys(QVariantList{QByteArray("a"), QByteArray("b")});
+
+  // when
+  QVERIFY(index.applyKeyspaceNotification("__keyspace@1__:c", "set"));
+  QVERIFY(index.applyKeyspaceNotification("__keyspace@1__:a", "expired"));
+  QVERIFY(index.applyKeyspaceNotification("__keyevent@1__:rename_from", "b"));
+  QVERIFY(index.applyKeyspaceNotification("__keyevent@1__:rename_to", "d"));
+  QVERIFY(index.applyKeyspaceNotification(
+      QVariantList{QByteArray("pmessage"), index.keyspacePattern(),
+                   QByteArray("__keyspace@1__:e"), QByteArray("hset")}));
+
+  // then - other db and channels are ignored
+  QVERIFY(!index.applyKeyspaceNotification("__keyspace@0__:f", "set"));
+  QVERIFY(!index.applyKeyspaceNotification("news", "hello"));
+  QCOMPARE(index.keyspacePattern(), QByteArray("__keyspace@1__:*"));
+  QCOMPARE(index.globMatch("*"), QList<QByteArray>({"c", "d", "e"}));
+}
+
+void TestKeys::keySnapshot() {
+  // given
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  ConnectionConfig config("127.0.0.1");
+  config.setKeySnapshotDir(dir.path());
+  QString path = KeySnapshot::path(config, 2);
+
+  KeyIndex index("::", 2);
+  index.addKeys(QVariantList{QByteArray("b::1"), QByteArray("a"),
+                             QByteArray("bin\x00key", 7), QByteArray()});
+
+  // when
+  QString error;
+  bool saved = KeySnapshot::save(index, path, &error);
+  auto snapshot = KeySnapshot::open(path, &error);
+
+  // then
+  QVERIFY2(saved, qPrintable(error));
+  QVERIFY2(snapshot, qPrintable(error));
+  QVERIFY(path.startsWith(dir.path()));
+  QCOMPARE(snapshot->size(), 4);
+  QCOMPARE(snapshot->dbIndex(), 2);
+  QCOMPARE(snapshot->separator(), QByteArray("::"));
+  QCOMPARE(snapshot->keys().toList(),
+           QList<QByteArray>({"", "a", "b::1", QByteArray("bin\x00key", 7)}));
+
+  // when - index over mapped keys is modified
+  KeyIndex reopened(snapshot);
+  reopened.addKey("c");
+  QVERIFY(reopened.removeKey("a"));
+
+  // then
+  QCOMPARE(reopened.size(), 4);
+  QCOMPARE(reopened.namespaceKeysCount("b"), 1ul);
+  QCOMPARE(reopened.globMatch("?"), QList<QByteArray>({"c"}));
+  QCOMPARE(snapshot->keys().at(1), QByteArray("a"));
+
+  // when - saved again while snapshot is mapped
+  saved = KeySnapshot::save(reopened, path, &error);
+  auto resaved = KeySnapshot::open(path, &error);
+
+  // then
+  QVERIFY2(saved, qPrintable(error));
+  QVERIFY2(resaved, qPrintable(error));
+  QVERIFY(KeySnapshot::exists(path));
+  QCOMPARE(resaved->keys().toList(),
+           QList<QByteArray>({"", "b::1", QByteArray("bin\x00key", 7), "c"}));
+  QCOMPARE(snapshot->keys().at(1), QByteArray("a"));
+
+  // when - corrupted file
+  QFile file(path + ".bad");
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("QRKS0000");
+  file.close();
+
+  // then
+  QVERIFY(KeySnapshot::open(path + ".bad").isNull());
+  QVERIFY(KeySnapshot::open(dir.filePath("missing.keys")).isNull());
+  QVERIFY(KeySnapshot::path(ConnectionConfig("127.0.0.1"), 0).isEmpty());
+}
+
+void TestKeys::valueCollection() {
+  // given
+  ValueCollection hash(
+      ValueCollection::typeOf(ScanCommand({"HSCAN", "h", "0"})));
+  ValueCollection zset(
+      ValueCollection::typeOf(ScanCommand({"zscan", "z", "0"})));
+  ValueCollection set(ValueCollection::typeOf(ScanCommand({"SSCAN", "s", "0"})));
+
+  // when
+  hash.append({QByteArray("f1"), QByteArray("v1"), QByteArray("f2"),
+               QByteArray("v2")});
+  hash.append({QByteArray("f3"), QByteArray("v3")});
+  zset.append({QByteArray("a"), QByteArray("1.5"), QByteArray("b"),
+               QByteArray("-inf")});
+  set.append({QByteArray("m1"), QByteArray("m2"), QByteArray("m3")});
+
+  // then
+  QCOMPARE(hash.type(), ValueCollection::Type::Hash);
+  QCOMPARE(hash.size(), 3);
+  QCOMPARE(hash.value(2), QByteArray("v3"));
+  QCOMPARE(hash.pageCount(2), 2);
+  QCOMPARE(hash.page(1, 2), QVariantList({QByteArray("f3"), QByteArray("v3")}));
+  QVERIFY(hash.page(2, 2).isEmpty());
+
+  QCOMPARE(zset.type(), ValueCollection::Type::SortedSet);
+  QCOMPARE(zset.member(1), QByteArray("b"));
+  QCOMPARE(zset.score(0), 1.5);
+  QVERIFY(qIsInf(zset.score(1)));
+  QCOMPARE(zset.page(0, 1), QVariantList({QByteArray("a"), 1.5}));
+
+  QCOMPARE(set.type(), ValueCollection::Type::Set);
+  QCOMPARE(set.page(1, 2), QVariantList({QByteArray("m3")}));
+  QCOMPARE(set.members().bytes(), 6);
+  QVERIFY(set.scores().isEmpty());
+  QVERIFY(set.memoryUsage() > 0);
+}
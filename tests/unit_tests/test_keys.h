@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+/*
+ * Tests of key and value containers used by hi-level loading API
+ */
+class TestKeys : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void packedKeyList();
+  void packedKeyListSlots();
+  void scanDedupSet();
+  void scanDedupSetFilter();
+  void keyIndexQueries();
+  void keyIndexNamespaces();
+  void keyIndexNamespaces_data();
+  void keyIndexNotifications();
+  void keySnapshot();
+  void valueCollection();
+};
@@ -2,6 +2,7 @@
 #include <QTest>
 #include <QtCore>
 #include "qredisclient/response.h"
+#include "qredisclient/responseformatter.h"
 #include "qredisclient/responseparser.h"
 
 void TestResponse::valueToHumanReadString() {
@@ -16,6 +17,67 @@ void TestResponse::valueToHumanReadString() {
   QCOMPARE(actualResult, QString("\"test\""));
 }
 
+void TestResponse::nestedValueToHumanReadString() {
+  // given
+  QVariantList testSource{QVariantList{"a", "b"}, QVariant(), "c\x01"};
+
+  // when
+  QString actualResult =
+      RedisClient::Response::valueToHumanReadString(testSource);
+
+  // then
+  QCOMPARE(actualResult, QString("1) 1) \"a\"\r\n"
+                                 "   2) \"b\"\r\n"
+                                 "\r\n"
+                                 "2) null\r\n"
+                                 "3) \"c\\x01\"\r\n"));
+}
+
+void TestResponse::streamingFormatter() {
+  // given
+  QVariantList testSource;
+  for (int i = 0; i < 20000; ++i) {
+    testSource.append(QByteArray("value:") + QByteArray::number(i));
+    if (i % 1000 == 0) testSource.append(QVariant(QVariantList{i, "\xff"}));
+  }
+
+  QByteArray output;
+  int chunks = 0;
+  RedisClient::ResponseFormatter formatter(
+      [&output, &chunks](const QByteArray& chunk) {
+        output.append(chunk);
+        ++chunks;
+      });
+
+  // when
+  bool result = formatter.format(testSource, 2);
+
+  // then
+  QVERIFY(result);
+  QVERIFY(!formatter.isTruncated());
+  QVERIFY(chunks > 1);
+  QCOMPARE(QString::fromUtf8(output),
+           RedisClient::Response::valueToHumanReadString(testSource, 2));
+}
+
+void TestResponse::streamingFormatterTruncation() {
+  // given
+  QVariantList testSource{"a", QVariantList{"b", "c"}, "d"};
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  RedisClient::ResponseFormatter formatter(&buffer, 3);
+
+  // when
+  formatter.format(testSource);
+
+  // then
+  QVERIFY(formatter.isTruncated());
+  QCOMPARE(formatter.formattedItems(), 3LL);
+  QCOMPARE(buffer.data(), QByteArray("1) \"a\"\r\n"
+                                     "2) 1) \"b\"\r\n"
+                                     "(output truncated after 3 items)\r\n"));
+}
+
 void TestResponse::scanResponse() {
   // given
   QString testResponse =
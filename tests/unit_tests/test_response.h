@@ -7,5 +7,8 @@ class TestResponse : public QObject {
 
  private slots:
   void valueToHumanReadString();
+  void nestedValueToHumanReadString();
+  void streamingFormatter();
+  void streamingFormatterTruncation();
   void scanResponse();
 };
@@ -0,0 +1,160 @@
+#include "test_stats.h"
+#include "qredisclient/command.h"
+#include "qredisclient/stats.h"
+#include "qredisclient/tracer.h"
+
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTest>
+
+using namespace RedisClient;
+
+void TestStats::latencyHistogramPercentiles() {
+  // given
+  LatencyHistogram histogram;
+
+  // when
+  for (int i = 1; i <= 100; ++i) {
+    histogram.record(i);
+  }
+
+  // then
+  QCOMPARE(histogram.count(), quint64(100));
+  QCOMPARE(histogram.min(), qint64(1));
+  QCOMPARE(histogram.max(), qint64(100));
+  QCOMPARE(histogram.mean(), 50.5);
+  QVERIFY(qAbs(histogram.percentile(50) - 50) <= 3);
+  QVERIFY(qAbs(histogram.percentile(99) - 99) <= 6);
+  QCOMPARE(histogram.percentile(100), qint64(100));
+
+  histogram.reset();
+  QCOMPARE(histogram.count(), quint64(0));
+  QCOMPARE(histogram.percentile(50), qint64(0));
+}
+
+void TestStats::latencyHistogramPrecision() {
+  QList<qint64> values{0, 15, 16, 17, 1000, 123456, 98765432};
+
+  for (qint64 value : values) {
+    LatencyHistogram histogram;
+    histogram.record(value);
+    histogram.record(value * 10);
+
+    qint64 p50 = histogram.percentile(50);
+
+    QVERIFY(p50 >= value);
+    QVERIFY(p50 - value <= value / 16);
+  }
+}
+
+void TestStats::connectionStatsCounters() {
+  // given
+  ConnectionStats stats;
+
+  // when
+  stats.addBytesIn(10);
+  stats.addBytesIn(5);
+  stats.addBytesOut(7);
+  stats.setQueueDepth(3);
+  stats.setQueueDepth(1);
+  stats.setInFlight(2);
+  stats.addReconnect();
+  stats.addRedirect();
+  stats.addRedirect();
+  stats.command("GET")->networkRtt.record(100);
+  stats.command("GET")->networkRtt.record(200);
+
+  // then
+  QCOMPARE(stats.bytesIn(), quint64(15));
+  QCOMPARE(stats.bytesOut(), quint64(7));
+  QCOMPARE(stats.queueDepth(), 1);
+  QCOMPARE(stats.maxQueueDepth(), 3);
+  QCOMPARE(stats.inFlight(), 2);
+  QCOMPARE(stats.reconnects(), quint64(1));
+  QCOMPARE(stats.redirects(), quint64(2));
+  QCOMPARE(stats.commandNames(), QList<QByteArray>{"GET"});
+
+  QVariantMap map = stats.toVariantMap();
+  QCOMPARE(map["bytes_in"].toULongLong(), 15ull);
+  QCOMPARE(map["commands"]
+               .toMap()["GET"]
+               .toMap()["network_rtt"]
+               .toMap()["count"]
+               .toULongLong(),
+           2ull);
+
+  stats.reset();
+  QCOMPARE(stats.bytesIn(), quint64(0));
+  QCOMPARE(stats.commandNames().size(), 0);
+}
+
+void TestStats::commandName() {
+  Command transaction;
+  transaction.addToPipeline({"SET", "key", "value"});
+
+  Command pipeline;
+  pipeline.setPipelineCommand(true, false);
+
+  QCOMPARE(ConnectionStats::commandName(Command({"get", "key"})),
+           QByteArray("GET"));
+  QCOMPARE(ConnectionStats::commandName(transaction), QByteArray("MULTI"));
+  QCOMPARE(ConnectionStats::commandName(pipeline), QByteArray("PIPELINE"));
+}
+
+void TestStats::tracerRingBuffer() {
+  // given
+  Tracer tracer;
+  tracer.addInstant("ignored", "tracing is disabled");
+
+  // when
+  tracer.start(3);
+
+  for (int i = 1; i <= 5; ++i) {
+    tracer.addCommand(i, "GET", 10 * i, 10 * i + 1, 10 * i + 2, 10 * i + 3,
+                      10 * i + 4);
+  }
+
+  // then
+  QVector<TraceRecord> records = tracer.records();
+  QCOMPARE(records.size(), 3);
+  QCOMPARE(records.first().commandId, quint64(3));
+  QCOMPARE(records.last().commandId, quint64(5));
+
+  tracer.stop();
+  tracer.addInstant("ignored", "tracing is stopped");
+  QCOMPARE(tracer.records().size(), 3);
+}
+
+void TestStats::tracerChromeTrace() {
+  // given
+  Tracer tracer;
+  tracer.start(10);
+  tracer.addCommand(1, "GET", 100, 110, 120, 150, 160);
+  tracer.addCallback(1, "GET", 160, 170, 175);
+  tracer.addInstant("MOVED", "127.0.0.1:7001");
+
+  // when
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  QVERIFY(tracer.writeChromeTrace(&buffer));
+
+  // then
+  QJsonObject root = QJsonDocument::fromJson(buffer.data()).object();
+  QJsonArray events = root["traceEvents"].toArray();
+
+  QStringList names;
+  for (const QJsonValue& e : events) {
+    names.append(e.toObject()["name"].toString());
+  }
+
+  QVERIFY(names.contains("queue"));
+  QVERIFY(names.contains("write"));
+  QVERIFY(names.contains("server"));
+  QVERIFY(names.contains("read"));
+  QVERIFY(names.contains("delivery"));
+  QVERIFY(names.contains("MOVED"));
+  QCOMPARE(names.count("GET"), 3);  // async begin/end + callback
+  QVERIFY(names.contains("thread_name"));
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore>
+
+class TestStats : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void latencyHistogramPercentiles();
+  void latencyHistogramPrecision();
+  void connectionStatsCounters();
+  void commandName();
+  void tracerRingBuffer();
+  void tracerChromeTrace();
+};
@@ -42,3 +42,73 @@ void TestText::testPrintableString()
     //then
     QCOMPARE(actualResult, QString("\\x01\\x02\\x03"));
 }
+
+void TestText::testPrintableStringBlocks_data()
+{
+    QTest::addColumn<QByteArray>("raw");
+    QTest::addColumn<bool>("strict");
+    QTest::addColumn<QString>("expected");
+
+    QByteArray longAscii(37, 'a');
+    QByteArray longWithControl = longAscii + '\x7f' + longAscii;
+    QByteArray longUnicode = longAscii + QString("☂").toUtf8() + longAscii;
+
+    QTest::newRow("empty") << QByteArray() << false << QString();
+    QTest::newRow("ascii") << QByteArray("key:1") << false << QString("key:1");
+    QTest::newRow("whitespace") << QByteArray("a\tb\n") << false
+                                << QString("a\tb\n");
+    QTest::newRow("whitespace strict") << QByteArray("a\tb c\n") << true
+                                       << QString("a\\x09b c\\x0A");
+    QTest::newRow("nul") << QByteArray("a\x00b", 3) << false
+                         << QString("a\\x00b");
+    QTest::newRow("long ascii") << longAscii << true << QString(longAscii);
+    QTest::newRow("control after first block")
+        << longWithControl << false
+        << QString(longAscii + "\\x7F" + longAscii);
+    QTest::newRow("unicode after first block")
+        << longUnicode << true << QString::fromUtf8(longUnicode);
+    QTest::newRow("invalid utf-8") << QByteArray("ab\xc3") << false
+                                   << QString("ab\\xC3");
+}
+
+void TestText::testPrintableStringBlocks()
+{
+    //given
+    QFETCH(QByteArray, raw);
+    QFETCH(bool, strict);
+    QFETCH(QString, expected);
+
+    //when
+    QString actualResult = printableString(raw, strict);
+
+    //then
+    QCOMPARE(actualResult, expected);
+}
+
+void TestText::testIsBinary_data()
+{
+    QTest::addColumn<QByteArray>("raw");
+    QTest::addColumn<bool>("binary");
+
+    QByteArray longAscii(40, 'x');
+
+    QTest::newRow("ascii") << longAscii << false;
+    QTest::newRow("multiline") << QByteArray("line1\r\nline2\r\n") << false;
+    QTest::newRow("unicode") << QString("☂ umbrella").toUtf8() << false;
+    QTest::newRow("control in tail") << longAscii + '\x01' << true;
+    QTest::newRow("invalid utf-8 in block")
+        << QByteArray("\xff") + longAscii << true;
+}
+
+void TestText::testIsBinary()
+{
+    //given
+    QFETCH(QByteArray, raw);
+    QFETCH(bool, binary);
+
+    //when
+    bool actualResult = isBinary(raw);
+
+    //then
+    QCOMPARE(actualResult, binary);
+}
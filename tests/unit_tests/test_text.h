@@ -10,6 +10,10 @@ class TestText : public QObject
 private slots:
     void testPrintableStringToBinary();
     void testPrintableString();
+    void testPrintableStringBlocks_data();
+    void testPrintableStringBlocks();
+    void testIsBinary_data();
+    void testIsBinary();
 
 };
 
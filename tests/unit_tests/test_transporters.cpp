@@ -1,7 +1,12 @@
 #include "test_transporters.h"
 #include "mocks/dummyTransporter.h"
 
+#include <QBuffer>
 #include <QSignalSpy>
+#include <QThread>
+#include <thread>
+
+#include "qredisclient/transporters/trafficrecorder.h"
 
 void TestTransporters::readPartialResponses() {
   // given
@@ -89,3 +94,195 @@ void TestTransporters::handleClusterRedirects() {
   QCOMPARE(commandReturnedResult, false);
   QCOMPARE(spy.count(), 1);
 }
+
+void TestTransporters::runningCommandQueue() {
+  // given
+  RedisClient::RunningCommandQueue queue;
+  QObject owner;
+  auto callback = [](RedisClient::Response, QString) {};
+
+  // when
+  for (int i = 0; i < 100; ++i) {
+    queue.enqueue(RedisClient::Command(
+        {"GET", QByteArray::number(i)}, (i % 2) ? &owner : nullptr, callback));
+  }
+
+  int removed = queue.removeIf([&owner](const RedisClient::RunningCommand& c) {
+    return c.cmd.getOwner() == &owner;
+  });
+
+  RedisClient::RunningCommand first = queue.dequeue();
+  queue.enqueue(RedisClient::Command(QList<QByteArray>{"PING"}));
+
+  // then
+  QCOMPARE(removed, 50);
+  QCOMPARE(first.cmd.getPartAsString(1), QString("0"));
+  QCOMPARE(first.emitter.isValid(), false);
+  QCOMPARE(queue.size(), 50);
+  QCOMPARE(queue.first().cmd.getPartAsString(1), QString("2"));
+
+  QString lastCmd;
+  for (const RedisClient::RunningCommand& c : queue) {
+    lastCmd = c.cmd.getPartAsString(0);
+  }
+  QCOMPARE(lastCmd, QString("PING"));
+
+  queue.clear();
+  QCOMPARE(queue.isEmpty(), true);
+}
+
+void TestTransporters::batchedResponseDelivery() {
+  // given
+  QThread ownerThread;
+  ownerThread.start();
+
+  QObject remoteOwner;
+  remoteOwner.moveToThread(&ownerThread);
+
+  QObject localOwner;
+
+  QList<int> remoteOrder;
+  QAtomicInt remoteCalls(0);
+  int localCalls = 0;
+
+  auto remoteCallback = [&remoteOrder, &remoteCalls](RedisClient::Response r,
+                                                     QString) {
+    remoteOrder.append(r.value().toInt());
+    remoteCalls.ref();
+  };
+
+  RedisClient::ResponseEmitter remote(&remoteOwner, remoteCallback);
+  RedisClient::ResponseEmitter local(
+      &localOwner, [&localCalls](RedisClient::Response, QString) {
+        localCalls++;
+      });
+
+  RedisClient::ResponseBatch batch;
+
+  // when
+  for (int i = 0; i < 3; ++i) {
+    batch.add(remote,
+              RedisClient::Response(RedisClient::Response::Integer, i),
+              QString());
+    batch.add(local, RedisClient::Response(RedisClient::Response::Integer, i),
+              QString());
+  }
+
+  // then
+  QCOMPARE(localCalls, 3);
+  QCOMPARE(batch.isEmpty(), false);
+
+  batch.flush();
+
+  QTRY_COMPARE(remoteCalls.load(), 3);
+  QCOMPARE(remoteOrder, QList<int>({0, 1, 2}));
+  QCOMPARE(batch.isEmpty(), true);
+
+  ownerThread.quit();
+  ownerThread.wait();
+}
+
+void TestTransporters::deliveryToDestroyedOwner() {
+  // given
+  QObject* destroyedOwner = new QObject();
+  QObject owner;
+  int destroyedOwnerCalls = 0;
+  int ownerCalls = 0;
+
+  RedisClient::ResponseEmitter toDestroyed(
+      destroyedOwner, [&destroyedOwnerCalls](RedisClient::Response, QString) {
+        destroyedOwnerCalls++;
+      });
+  RedisClient::ResponseEmitter toOwner(
+      &owner,
+      [&ownerCalls](RedisClient::Response, QString) { ownerCalls++; });
+
+  // when - responses are sent from transporter thread
+  std::thread transporterThread([&toDestroyed, &toOwner]() {
+    RedisClient::Response r(RedisClient::Response::Integer, 1);
+    toDestroyed.sendResponse(r, QString());
+    toOwner.sendResponse(r, QString());
+  });
+  transporterThread.join();
+
+  delete destroyedOwner;
+
+  // then
+  QTRY_COMPARE(ownerCalls, 1);
+  QCOMPARE(destroyedOwnerCalls, 0);
+}
+
+void TestTransporters::inlineResponseDelivery() {
+  // given
+  QThread ownerThread;
+  ownerThread.start();
+
+  QObject remoteOwner;
+  remoteOwner.moveToThread(&ownerThread);
+
+  QThread* callbackThread = nullptr;
+  RedisClient::Command cmd(
+      {"PING"}, &remoteOwner,
+      [&callbackThread](RedisClient::Response, QString) {
+        callbackThread = QThread::currentThread();
+      });
+  cmd.setInlineCallback();
+
+  RedisClient::RunningCommand runningCmd(cmd);
+  RedisClient::ResponseBatch batch;
+
+  // when
+  batch.add(runningCmd.emitter,
+            RedisClient::Response(RedisClient::Response::Status, "PONG"),
+            QString());
+
+  // then
+  QCOMPARE(runningCmd.emitter.isInline(), true);
+  QCOMPARE(batch.isEmpty(), true);
+  QCOMPARE(callbackThread, QThread::currentThread());
+
+  ownerThread.quit();
+  ownerThread.wait();
+}
+
+void TestTransporters::trafficRecording() {
+  using RedisClient::TrafficChunk;
+
+  // given
+  QBuffer buffer;
+  buffer.open(QIODevice::ReadWrite);
+  QByteArray bigChunk(100000, 'x');
+
+  // when
+  {
+    RedisClient::TrafficRecorder recorder(&buffer);
+    recorder.record(TrafficChunk::Type::Connect, "127.0.0.1:6379");
+    recorder.record(TrafficChunk::Type::Out, "*1\r\n$4\r\nPING\r\n");
+    recorder.record(TrafficChunk::Type::In, "+PONG\r\n");
+    recorder.record(TrafficChunk::Type::In, bigChunk);
+    recorder.record(TrafficChunk::Type::Disconnect);
+  }
+
+  QVector<TrafficChunk> chunks;
+  buffer.seek(0);
+  bool loaded = RedisClient::TrafficRecorder::load(&buffer, &chunks);
+
+  // then
+  QVERIFY(loaded);
+  QCOMPARE(chunks.size(), 5);
+  QCOMPARE(chunks[0].data, QByteArray("127.0.0.1:6379"));
+  QVERIFY(chunks[1].type == TrafficChunk::Type::Out);
+  QCOMPARE(chunks[2].data, QByteArray("+PONG\r\n"));
+  QCOMPARE(chunks[3].data, bigChunk);
+  QVERIFY(chunks[4].type == TrafficChunk::Type::Disconnect);
+  QVERIFY(chunks[4].timestamp >= chunks[0].timestamp);
+
+  // truncated recording is rejected
+  QBuffer truncated;
+  truncated.setData(buffer.data().left(buffer.data().size() - 50000));
+  truncated.open(QIODevice::ReadOnly);
+  QString error;
+
+  QVERIFY(!RedisClient::TrafficRecorder::load(&truncated, &chunks, &error));
+  QVERIFY(!error.isEmpty());
+}
@@ -9,4 +9,9 @@ class TestTransporters : public BaseTestCase {
  private slots:
   void readPartialResponses();
   void handleClusterRedirects();
+  void runningCommandQueue();
+  void batchedResponseDelivery();
+  void inlineResponseDelivery();
+  void deliveryToDestroyedOwner();
+  void trafficRecording();
 };
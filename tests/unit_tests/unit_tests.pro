@@ -29,6 +29,7 @@ unix:!mac {
 }
 
 include($$PWD/redisclient-tests.pri)
+include($$PWD/../fakeserver/fakeserver.pri)
 include($$PROJECT_ROOT/3rdparty/3rdparty.pri)
 
 UI_DIR = $$DESTDIR/ui